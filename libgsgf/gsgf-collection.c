@@ -61,6 +61,15 @@ typedef struct {
         enum gsgf_parser_state state;
 } GSGFParserContext;
 
+struct _GSGFCollectionIter {
+        GSGFParserContext ctx;
+        gsize num_game_trees;
+        gboolean done;
+
+        /* A parse error after the last game tree returned.  */
+        GError *pending_error;
+};
+
 typedef struct _GSGFCollectionPrivate GSGFCollectionPrivate;
 struct _GSGFCollectionPrivate {
         GList* game_trees;
@@ -163,64 +172,56 @@ gsgf_collection_new(GError **error)
         return self;
 }
 
-/**
- * gsgf_collection_parse_stream:
- * @stream: a #GInputStream to parse.
- * @cancellable: optional #GCancellable object, %NULL to ignore.
- * @error: a #GError location to store the error occuring, or %NULL to ignore.
- *
- * Parses an input stream into a #GSGFCollection in memory
- *
- * See also gsgf_collection_parse_file ().
+static void
+gsgf_parser_context_init (GSGFParserContext *ctx, GInputStream *stream,
+                          GCancellable *cancellable)
+{
+        ctx->stream = stream;
+        ctx->cancellable = cancellable;
+        ctx->error = NULL;
+        ctx->estatus = GSGF_ERROR_NONE;
+        ctx->lineno = ctx->start_lineno = 1;
+        ctx->colno = ctx->start_colno = 0;
+        ctx->bufsize = 0;
+        ctx->bufpos = 0;
+        ctx->state = GSGF_PARSER_STATE_INIT;
+}
+
+/*
+ * Read game trees from the stream into @self.  If @single_tree is %TRUE,
+ * the function returns after the first complete top-level game tree, and
+ * can be called again with the same context for the next one.
  *
- * Returns: A #GSGFCollection or %NULL on error.
+ * Returns %FALSE for fatal errors.  Note that the lexer may have set an
+ * error even if %TRUE is returned.
  */
-GSGFCollection *
-gsgf_collection_parse_stream(GInputStream *stream,
-                             GCancellable *cancellable, GError **error)
+static gboolean
+gsgf_collection_parse (GSGFCollection *self, GSGFParserContext *ctx,
+                       gboolean single_tree)
 {
-        GSGFCollection *self;
         gint token = 0;
         GString *value;
-        GSGFParserContext ctx;
-
-        gsgf_return_val_if_fail (G_IS_INPUT_STREAM (stream), NULL, error);
-
-        self = gsgf_collection_new(error);
-        if (!self)
-                return NULL;
-
         GSGFGameTree *game_tree = NULL;
         GSGFNode *node = NULL;
         GSGFProperty *property = NULL;
 
-        ctx.stream = stream;
-        ctx.cancellable = cancellable;
-        ctx.error = error;
-        ctx.estatus = GSGF_ERROR_NONE;
-        ctx.lineno = ctx.start_lineno = 1;
-        ctx.colno = ctx.start_colno = 0;
-        ctx.bufsize = 0;
-        ctx.bufpos = 0;
-        ctx.state = GSGF_PARSER_STATE_INIT;
-
         do {
                 if (token == '[')
-                        token = gsgf_yylex_c_value_type(&ctx, &value);
+                        token = gsgf_yylex_c_value_type(ctx, &value);
                 else
-                        token = gsgf_yylex(&ctx, &value);
+                        token = gsgf_yylex(ctx, &value);
 
 
 #if (0)
                 if (value) {
                         g_print("%d:%d: Token: %d \"%s\"\n",
-                                ctx.start_lineno, ctx.start_colno + 1, token, value->str);
+                                ctx->start_lineno, ctx->start_colno + 1, token, value->str);
                 } else if (token < 256 && token >= 32)
                         g_print("%d:%d: Token: %c NONE\n",
-                                ctx.start_lineno, ctx.start_colno + 1, (char) token);
+                                ctx->start_lineno, ctx->start_colno + 1, (char) token);
                 else
                         g_print("%d:%d: Token: %d NONE\n",
-                                ctx.start_lineno, ctx.start_colno + 1, token);
+                                ctx->start_lineno, ctx->start_colno + 1, token);
 #endif
 
                 if (token == -1) {
@@ -233,173 +234,163 @@ gsgf_collection_parse_stream(GInputStream *stream,
                  * A NodeList cannot follow a (sub-)GameTree.
                  */
 
-                switch (ctx.state) {
+                switch (ctx->state) {
                         case GSGF_PARSER_STATE_INIT:
                                 if (token == '(') {
-                                        ctx.state = GSGF_PARSER_STATE_NODE;
+                                        ctx->state = GSGF_PARSER_STATE_NODE;
                                         game_tree =
                                                 gsgf_collection_add_game_tree (
                                                                 self, NULL);
                                         node = NULL;
                                         property = NULL;
                                 } else {
-                                        gsgf_yyerror(&ctx, _("'('"), token, error);
-                                        g_object_unref (self);
-                                        return NULL;
+                                        gsgf_yyerror(ctx, _("'('"), token, ctx->error);
+                                        return FALSE;
                                 }
                                 break;
                         case GSGF_PARSER_STATE_NODE:
                                 if (token == ';') {
-                                        ctx.state = GSGF_PARSER_STATE_PROPERTY;
+                                        ctx->state = GSGF_PARSER_STATE_PROPERTY;
                                         node = gsgf_game_tree_add_node(game_tree);
                                         property = NULL;
                                 } else {
-                                        gsgf_yyerror(&ctx, _("';'"), token, error);
+                                        gsgf_yyerror(ctx, _("';'"), token, ctx->error);
                                         if (value)
                                                 g_string_free(value, TRUE);
-                                        g_object_unref (self);
-                                        return NULL;
+                                        return FALSE;
                                 }
                                 break;
                         case GSGF_PARSER_STATE_PROPERTY:
                                 if (token == GSGF_TOKEN_PROP_IDENT) {
-                                        ctx.state = GSGF_PARSER_STATE_PROP_VALUE;
+                                        ctx->state = GSGF_PARSER_STATE_PROP_VALUE;
                                         property = gsgf_node_add_property(node,
                                                                           value->str,
-                                                                          error);
+                                                                          ctx->error);
                                         if (!property) {
-                                                g_prefix_error(error, "%d:%d:",
-                                                               ctx.lineno, ctx.colno);
+                                                g_prefix_error(ctx->error, "%d:%d:",
+                                                               ctx->lineno, ctx->colno);
                                                 g_string_free(value, TRUE);
-                                                g_object_unref (self);
-                                                return NULL;
+                                                return FALSE;
                                         }
                                 } else if (token == ';') {
-                                        ctx.state = GSGF_PARSER_STATE_PROPERTY;
+                                        ctx->state = GSGF_PARSER_STATE_PROPERTY;
                                         node = gsgf_game_tree_add_node(game_tree);
                                         property = NULL;
                                 } else if (token == '(') {
-                                        ctx.state = GSGF_PARSER_STATE_NODE;
+                                        ctx->state = GSGF_PARSER_STATE_NODE;
                                         game_tree = gsgf_game_tree_add_child(game_tree);
                                         node = NULL;
                                         property = NULL;
                                 } else if (token == ')') {
-                                        ctx.state = GSGF_PARSER_STATE_GAME_TREES;
+                                        ctx->state = GSGF_PARSER_STATE_GAME_TREES;
                                         game_tree = gsgf_game_tree_get_parent(game_tree);
                                 } else {
-                                        gsgf_yyerror(&ctx, _("property, ';', or '('"),
-                                                     token, error);
+                                        gsgf_yyerror(ctx, _("property, ';', or '('"),
+                                                     token, ctx->error);
                                         if (value)
                                                 g_string_free(value, TRUE);
-                                        g_object_unref (self);
-                                        return NULL;
+                                        return FALSE;
                                 }
                                 break;
                         case GSGF_PARSER_STATE_PROP_VALUE:
                                 if (token == '[') {
-                                        ctx.state = GSGF_PARSER_STATE_VALUE;
+                                        ctx->state = GSGF_PARSER_STATE_VALUE;
                                 } else {
-                                        gsgf_yyerror(&ctx, _("'['"), token, error);
+                                        gsgf_yyerror(ctx, _("'['"), token, ctx->error);
                                         if (value)
                                                 g_string_free(value, TRUE);
-                                        g_object_unref (self);
-                                        return NULL;
+                                        return FALSE;
                                 }
                                 break;
                         case GSGF_PARSER_STATE_VALUE:
                                 if (token == ']') {
-                                        ctx.state = GSGF_PARSER_STATE_PROPERTIES;
+                                        ctx->state = GSGF_PARSER_STATE_PROPERTIES;
                                 } else if (token == GSGF_TOKEN_VALUE) {
-                                        ctx.state = GSGF_PARSER_STATE_PROP_CLOSE;
+                                        ctx->state = GSGF_PARSER_STATE_PROP_CLOSE;
                                         _gsgf_property_add_value(property, value->str);
                                 } else {
-                                        gsgf_yyerror(&ctx, _("value or ']'"),
-                                                     token, error);
+                                        gsgf_yyerror(ctx, _("value or ']'"),
+                                                     token, ctx->error);
                                         if (value)
                                                 g_string_free(value, TRUE);
-                                        g_object_unref (self);
-                                        return NULL;
+                                        return FALSE;
                                 }
 
                                 break;
                         case GSGF_PARSER_STATE_PROPERTIES:
                                 if (token == '[') {
-                                        ctx.state = GSGF_PARSER_STATE_VALUE;
+                                        ctx->state = GSGF_PARSER_STATE_VALUE;
                                 } else if (token == ';') {
-                                        ctx.state = GSGF_PARSER_STATE_PROPERTY;
+                                        ctx->state = GSGF_PARSER_STATE_PROPERTY;
                                         node = gsgf_game_tree_add_node(game_tree);
                                         property = NULL;
                                 } else if (token == '(') {
-                                        ctx.state = GSGF_PARSER_STATE_NODE;
+                                        ctx->state = GSGF_PARSER_STATE_NODE;
                                         game_tree = gsgf_game_tree_add_child(game_tree);
                                         node = NULL;
                                         property = NULL;
                                 } else if (token == ')') {
-                                        ctx.state = GSGF_PARSER_STATE_GAME_TREES;
+                                        ctx->state = GSGF_PARSER_STATE_GAME_TREES;
                                         game_tree = gsgf_game_tree_get_parent(game_tree);
                                         node = NULL;
                                         property = NULL;
                                 } else {
-                                        gsgf_yyerror(&ctx, _("'[', ';', or '('"),
-                                                     token, error);
+                                        gsgf_yyerror(ctx, _("'[', ';', or '('"),
+                                                     token, ctx->error);
                                         if (value)
                                                 g_string_free(value, TRUE);
-                                        g_object_unref (self);
-                                        return NULL;
+                                        return FALSE;
                                 }
                                 break;
                         case GSGF_PARSER_STATE_PROP_CLOSE:
                                 if (token == ']') {
-                                        ctx.state = GSGF_PARSER_STATE_PROP_VALUE_READ;
+                                        ctx->state = GSGF_PARSER_STATE_PROP_VALUE_READ;
                                 } else {
-                                        gsgf_yyerror(&ctx, _("']'"), token, error);
+                                        gsgf_yyerror(ctx, _("']'"), token, ctx->error);
                                         if (value)
                                                 g_string_free(value, TRUE);
-                                        g_object_unref (self);
-                                        return NULL;
+                                        return FALSE;
                                 }
                                 break;
                         case GSGF_PARSER_STATE_PROP_VALUE_READ:
                                 if (token == '[') {
-                                        ctx.state = GSGF_PARSER_STATE_VALUE;
+                                        ctx->state = GSGF_PARSER_STATE_VALUE;
                                 } else if (token == ';') {
-                                        ctx.state = GSGF_PARSER_STATE_PROPERTY;
+                                        ctx->state = GSGF_PARSER_STATE_PROPERTY;
                                         node = gsgf_game_tree_add_node(game_tree);
                                         property = NULL;
                                 } else if (token == '(') {
-                                        ctx.state = GSGF_PARSER_STATE_NODE;
+                                        ctx->state = GSGF_PARSER_STATE_NODE;
                                         game_tree = gsgf_game_tree_add_child(game_tree);
                                         node = NULL;
                                         property = NULL;
                                 } else if (token == ')') {
-                                        ctx.state = GSGF_PARSER_STATE_GAME_TREES;
+                                        ctx->state = GSGF_PARSER_STATE_GAME_TREES;
                                         game_tree = gsgf_game_tree_get_parent(game_tree);
                                         node = NULL;
                                         property = NULL;
                                 } else if (token == GSGF_TOKEN_PROP_IDENT) {
-                                        ctx.state = GSGF_PARSER_STATE_PROP_VALUE;
+                                        ctx->state = GSGF_PARSER_STATE_PROP_VALUE;
                                         property = gsgf_node_add_property(node,
                                                                           value->str,
-                                                                          error);
+                                                                          ctx->error);
                                         if (!property) {
-                                                g_prefix_error(error, "%d:%d:",
-                                                               ctx.lineno, ctx.colno);
+                                                g_prefix_error(ctx->error, "%d:%d:",
+                                                               ctx->lineno, ctx->colno);
                                                 g_string_free(value, TRUE);
-                                                g_object_unref (self);
-                                                return NULL;
+                                                return FALSE;
                                         }
                                 } else {
-                                        gsgf_yyerror(&ctx, _("'[', ';', '(', ')', or property"),
-                                                     token, error);
+                                        gsgf_yyerror(ctx, _("'[', ';', '(', ')', or property"),
+                                                     token, ctx->error);
                                         if (value)
                                                 g_string_free(value, TRUE);
-                                        g_object_unref (self);
-                                        return NULL;
+                                        return FALSE;
                                 }
                                 break;
                         case GSGF_PARSER_STATE_GAME_TREES:
                                 if (token == '(') {
-                                        ctx.state = GSGF_PARSER_STATE_NODE;
+                                        ctx->state = GSGF_PARSER_STATE_NODE;
                                         if (game_tree) {
                                                 game_tree = gsgf_game_tree_add_child(game_tree);
                                         } else {
@@ -409,22 +400,20 @@ gsgf_collection_parse_stream(GInputStream *stream,
                                 } else if (token == ')') {
                                         /* State does not change! */
                                         if (!game_tree) {
-                                                gsgf_yyerror(&ctx,
+                                                gsgf_yyerror(ctx,
                                                              _("Trailing garbage"), 
-                                                             token, error);
+                                                             token, ctx->error);
                                         }
                                         game_tree = gsgf_game_tree_get_parent(game_tree);
                                 } else if (token == GSGF_TOKEN_EOF) {
                                         if (value)
                                                 g_string_free(value, TRUE);
-                                        g_object_unref (self);
-                                        return NULL;
+                                        return FALSE;
                                 } else {
-                                        gsgf_yyerror(&ctx, _("'('"), token, error);
+                                        gsgf_yyerror(ctx, _("'('"), token, ctx->error);
                                         if (value)
                                                 g_string_free(value, TRUE);
-                                        g_object_unref (self);
-                                        return NULL;
+                                        return FALSE;
                                 }
                                 break;
                 }
@@ -432,8 +421,48 @@ gsgf_collection_parse_stream(GInputStream *stream,
                 if (value)
                         g_string_free(value, TRUE);
 
+                /* Stop after a complete top-level game tree.  */
+                if (single_tree && !game_tree
+                    && ctx->state == GSGF_PARSER_STATE_GAME_TREES)
+                        break;
         } while (token != GSGF_TOKEN_EOF);
 
+        return TRUE;
+}
+
+/**
+ * gsgf_collection_parse_stream:
+ * @stream: a #GInputStream to parse.
+ * @cancellable: optional #GCancellable object, %NULL to ignore.
+ * @error: a #GError location to store the error occuring, or %NULL to ignore.
+ *
+ * Parses an input stream into a #GSGFCollection in memory
+ *
+ * See also gsgf_collection_parse_file ().
+ *
+ * Returns: A #GSGFCollection or %NULL on error.
+ */
+GSGFCollection *
+gsgf_collection_parse_stream(GInputStream *stream,
+                             GCancellable *cancellable, GError **error)
+{
+        GSGFCollection *self;
+        GSGFParserContext ctx;
+
+        gsgf_return_val_if_fail (G_IS_INPUT_STREAM (stream), NULL, error);
+
+        self = gsgf_collection_new(error);
+        if (!self)
+                return NULL;
+
+        gsgf_parser_context_init (&ctx, stream, cancellable);
+        ctx.error = error;
+
+        if (!gsgf_collection_parse (self, &ctx, FALSE)) {
+                g_object_unref (self);
+                return NULL;
+        }
+
         if (!self->priv->game_trees) {
                 g_set_error(ctx.error, GSGF_ERROR, GSGF_ERROR_EMPTY_COLLECTION,
                             _("Empty SGF collections are not allowed"));
@@ -479,6 +508,125 @@ gsgf_collection_parse_file(GFile *file, GCancellable *cancellable,
         return gsgf_collection_parse_stream(stream, cancellable, error);
 }
 
+/**
+ * gsgf_collection_iter_new:
+ * @stream: a #GInputStream to parse.
+ * @cancellable: optional #GCancellable object, %NULL to ignore.
+ *
+ * Creates an iterator that parses @stream one top-level game tree at a
+ * time.  Unlike gsgf_collection_parse_stream(), only the game tree
+ * currently being read is kept in memory.
+ *
+ * Returns: The new #GSGFCollectionIter, free it with
+ *          gsgf_collection_iter_free().
+ */
+GSGFCollectionIter *
+gsgf_collection_iter_new (GInputStream *stream, GCancellable *cancellable)
+{
+        GSGFCollectionIter *self;
+
+        g_return_val_if_fail (G_IS_INPUT_STREAM (stream), NULL);
+
+        self = g_new0 (GSGFCollectionIter, 1);
+        gsgf_parser_context_init (&self->ctx, g_object_ref (stream),
+                                  cancellable);
+
+        return self;
+}
+
+/**
+ * gsgf_collection_iter_next:
+ * @self: the #GSGFCollectionIter.
+ * @error: a #GError location to store the error occuring, or %NULL to ignore.
+ *
+ * Parses the next top-level game tree.  The game tree is returned inside
+ * a #GSGFCollection of its own, so that it can be cooked and inspected
+ * just like a complete collection.
+ *
+ * An input without any game tree is an error, just like for
+ * gsgf_collection_parse_stream().  If the input is broken after a game
+ * tree, that game tree is returned first, and the error is reported by the
+ * following call.
+ *
+ * Returns: A #GSGFCollection with exactly one #GSGFGameTree, or %NULL at
+ *          the end of the input or on error.
+ */
+GSGFCollection *
+gsgf_collection_iter_next (GSGFCollectionIter *self, GError **error)
+{
+        GSGFCollection *collection;
+        GError *parse_error = NULL;
+
+        gsgf_return_val_if_fail (self != NULL, NULL, error);
+
+        if (self->pending_error) {
+                g_propagate_error (error, self->pending_error);
+                self->pending_error = NULL;
+                return NULL;
+        }
+
+        if (self->done)
+                return NULL;
+
+        collection = gsgf_collection_new (NULL);
+        self->ctx.error = &parse_error;
+        if (!gsgf_collection_parse (collection, &self->ctx, TRUE)) {
+                self->ctx.error = NULL;
+                self->done = TRUE;
+                g_object_unref (collection);
+                g_propagate_error (error, parse_error);
+                return NULL;
+        }
+        self->ctx.error = NULL;
+
+        if (!collection->priv->game_trees) {
+                self->done = TRUE;
+                g_object_unref (collection);
+                if (parse_error)
+                        g_propagate_error (error, parse_error);
+                else if (!self->num_game_trees)
+                        g_set_error (error, GSGF_ERROR,
+                                     GSGF_ERROR_EMPTY_COLLECTION,
+                                     _("Empty SGF collections are not"
+                                       " allowed"));
+                return NULL;
+        }
+
+        if (parse_error) {
+                self->done = TRUE;
+                self->pending_error = parse_error;
+        }
+
+        if (!gsgf_collection_convert (GSGF_COMPONENT (collection),
+                                      "ISO-8859-1", error)) {
+                self->done = TRUE;
+                g_object_unref (collection);
+                return NULL;
+        }
+
+        ++self->num_game_trees;
+
+        return collection;
+}
+
+/**
+ * gsgf_collection_iter_free:
+ * @self: the #GSGFCollectionIter.
+ *
+ * Frees the iterator and releases the stream.
+ */
+void
+gsgf_collection_iter_free (GSGFCollectionIter *self)
+{
+        if (!self)
+                return;
+
+        if (self->pending_error)
+                g_error_free (self->pending_error);
+        g_object_unref (self->ctx.stream);
+        g_free (self);
+}
+
 static gint gsgf_yylex(GSGFParserContext *ctx, GString **value)
 {
         gchar c;
@@ -85,6 +85,19 @@ struct _GSGFGameTree *gsgf_collection_add_game_tree (GSGFCollection *self,
 
 GList *gsgf_collection_get_game_trees(const GSGFCollection *self);
 
+/**
+ * GSGFCollectionIter:
+ *
+ * Opaque structure for reading a collection one game tree at a time.
+ **/
+typedef struct _GSGFCollectionIter GSGFCollectionIter;
+
+GSGFCollectionIter *gsgf_collection_iter_new (GInputStream *stream,
+                                              GCancellable *cancellable);
+GSGFCollection *gsgf_collection_iter_next (GSGFCollectionIter *self,
+                                           GError **error);
+void gsgf_collection_iter_free (GSGFCollectionIter *self);
+
 G_END_DECLS
 
 #endif
@@ -0,0 +1,119 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet 
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify 
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include <glib/gi18n.h>
+
+#include <libgsgf/gsgf.h>
+
+#include "test.h"
+
+/* The expected error is consumed by expect_error().  */
+static int test_iterate (const gchar *sgf, gsize expect_trees,
+                         GError *expect);
+
+int
+main(int argc, char *argv[])
+{
+        GError *expect;
+        int status = 0;
+
+        g_type_init();
+
+        if (test_iterate ("(;FF[4])(;GM[6](;CA[UTF-8]))\n(;)", 3, NULL))
+                status = -1;
+
+        expect = g_error_new (GSGF_ERROR, GSGF_ERROR_EMPTY_COLLECTION,
+                              "Empty SGF collections are not allowed");
+        if (test_iterate ("", 0, expect))
+                status = -1;
+
+        expect = g_error_new (GSGF_ERROR, GSGF_ERROR_SYNTAX,
+                              "1:8: Illegal character 'x'");
+        if (test_iterate ("(;FF[4])x", 1, expect))
+                status = -1;
+
+        return status;
+}
+
+static int
+test_iterate (const gchar *sgf, gsize expect_trees, GError *expect)
+{
+        GInputStream *stream;
+        GSGFCollectionIter *iter;
+        GSGFCollection *collection;
+        GError *error = NULL;
+        gsize num_trees = 0;
+        guint length;
+        int status = 0;
+
+        path = (char *) sgf;
+
+        stream = g_memory_input_stream_new_from_data (sgf, strlen (sgf),
+                                                      NULL);
+        iter = gsgf_collection_iter_new (stream, NULL);
+        g_object_unref (stream);
+
+        while ((collection = gsgf_collection_iter_next (iter, &error))) {
+                length = g_list_length (
+                                gsgf_collection_get_game_trees (collection));
+                if (length != 1) {
+                        fprintf (stderr, "%s: Expected one game tree per"
+                                 " collection, got %u.\n", sgf, length);
+                        status = -1;
+                }
+                ++num_trees;
+                g_object_unref (collection);
+        }
+
+        if (num_trees != expect_trees) {
+                fprintf (stderr, "%s: Expected %llu game trees, got %llu.\n",
+                         sgf, (unsigned long long) expect_trees,
+                         (unsigned long long) num_trees);
+                status = -1;
+        }
+
+        if (expect_error (error, expect))
+                status = -1;
+        if (error) {
+                g_error_free (error);
+                error = NULL;
+        }
+
+        if (gsgf_collection_iter_next (iter, &error)) {
+                fprintf (stderr, "%s: Iterator not exhausted.\n", sgf);
+                status = -1;
+        }
+        if (error) {
+                fprintf (stderr, "%s: Error reported twice: %s.\n",
+                         sgf, error->message);
+                g_error_free (error);
+                status = -1;
+        }
+
+        gsgf_collection_iter_free (iter);
+
+        return status;
+}
@@ -60,6 +60,7 @@
 #include "gibbon-game.h"
 #include "gibbon-analysis-view.h"
 #include "gibbon-met.h"
+#include "gibbon-match-statistics.h"
 #include "gibbon-java-fibs-importer.h"
 
 enum gibbon_app_list_signal {
@@ -297,6 +298,7 @@ gibbon_app_new(const gchar *builder_path, const gchar *pixmaps_directory,
         app = self = g_object_new (GIBBON_TYPE_APP, NULL);
 
         self->priv->met = gibbon_met_new ();
+        gibbon_match_statistics_set_met (self->priv->met);
 
         self->priv->builder = gibbon_app_get_builder(self, builder_path);
         if (!self->priv->builder) {
@@ -906,6 +908,8 @@ gibbon_app_on_open (GibbonApp *self, GtkWidget *emitter)
         gtk_file_filter_set_name (filter, _("Gibbon files (*.gmd)"));
         gtk_file_filter_add_pattern (filter, "*.gmd");
         gtk_file_filter_add_pattern (filter, "*.GMD");
+        gtk_file_filter_add_pattern (filter, "*.gmd.gz");
+        gtk_file_filter_add_pattern (filter, "*.GMD.GZ");
         gtk_file_chooser_add_filter (GTK_FILE_CHOOSER (dialog), filter);
 
         filter = gtk_file_filter_new ();
@@ -2010,10 +2014,11 @@ gibbon_app_on_action_selected (GibbonApp *self, gint action_no)
         if (!game)
                 return;
 
-        if (action_no < 0)
-                current = gibbon_game_get_initial_position (game);
-        else
-                current = gibbon_game_get_nth_position (game, action_no);
+        /* Only the selected position is ever reconstructed.  */
+        current = gibbon_match_seek (self->priv->match,
+                                     gibbon_match_tell (self->priv->match,
+                                                        game_no, action_no),
+                                     NULL, NULL);
         if (!current)
                 return;
 
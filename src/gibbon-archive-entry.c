@@ -0,0 +1,106 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify 
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:gibbon-archive-entry
+ * @short_description: Boxed type for catalogued matches
+ *
+ * Since: 0.2.0
+ *
+ * One record of the catalogue of archived matches.  It contains the
+ * location of the match file, the opponents, the length, the final score,
+ * the start time, and the error rates of both players if known.
+ */
+
+#include <glib.h>
+
+#include "gibbon-archive-entry.h"
+
+G_DEFINE_BOXED_TYPE (GibbonArchiveEntry, gibbon_archive_entry,            \
+                     gibbon_archive_entry_copy, gibbon_archive_entry_free)
+
+/**
+ * gibbon_archive_entry_new:
+ * @path: Absolute path to the match file.
+ * @white: Name of the owner of the archive.
+ * @opponent: Name of the opponent.
+ * @match_length: Length of the match or 0.
+ * @score1: Final score of @white.
+ * @score2: Final score of @opponent.
+ * @start_time: Start of the match in microseconds since the epoch.
+ *
+ * Creates a new #GibbonArchiveEntry.  The result is derived from the
+ * length and the score, the error rates are initialized as unknown.
+ *
+ * Returns: The newly created #GibbonArchiveEntry.
+ */
+GibbonArchiveEntry *
+gibbon_archive_entry_new (const gchar *path, const gchar *white,
+                          const gchar *opponent, guint match_length,
+                          guint score1, guint score2, gint64 start_time)
+{
+        GibbonArchiveEntry *self;
+
+        self = g_malloc (sizeof *self);
+        self->path = g_strdup (path);
+        self->white = g_strdup (white);
+        self->opponent = g_strdup (opponent);
+        self->match_length = match_length;
+        self->scores[0] = score1;
+        self->scores[1] = score2;
+        self->start_time = start_time;
+
+        if (match_length && score1 >= match_length)
+                self->result = GIBBON_ARCHIVE_RESULT_WON;
+        else if (match_length && score2 >= match_length)
+                self->result = GIBBON_ARCHIVE_RESULT_LOST;
+        else
+                self->result = GIBBON_ARCHIVE_RESULT_UNFINISHED;
+
+        self->error_rates[0] = -1.0;
+        self->error_rates[1] = -1.0;
+
+        return self;
+}
+
+GibbonArchiveEntry *
+gibbon_archive_entry_copy (const GibbonArchiveEntry *self)
+{
+        GibbonArchiveEntry *copy;
+
+        g_return_val_if_fail (self != NULL, NULL);
+
+        copy = g_memdup (self, sizeof *self);
+        copy->path = g_strdup (self->path);
+        copy->white = g_strdup (self->white);
+        copy->opponent = g_strdup (self->opponent);
+
+        return copy;
+}
+
+void
+gibbon_archive_entry_free (GibbonArchiveEntry *self)
+{
+        if (self) {
+                g_free (self->path);
+                g_free (self->white);
+                g_free (self->opponent);
+                g_free (self);
+        }
+}
@@ -0,0 +1,83 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify 
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GIBBON_ARCHIVE_ENTRY_H
+# define _GIBBON_ARCHIVE_ENTRY_H
+
+#include <glib.h>
+#include <glib-object.h>
+
+#define GIBBON_TYPE_ARCHIVE_ENTRY (gibbon_archive_entry_get_type ())
+
+/**
+ * GibbonArchiveResult:
+ * @GIBBON_ARCHIVE_RESULT_ANY: Wildcard for queries.
+ * @GIBBON_ARCHIVE_RESULT_WON: The owner of the archive won the match.
+ * @GIBBON_ARCHIVE_RESULT_LOST: The opponent won the match.
+ * @GIBBON_ARCHIVE_RESULT_UNFINISHED: The match was not finished or had
+ *                                    no fixed length.
+ *
+ * Outcome of an archived match, seen from the owner of the archive.
+ */
+typedef enum {
+        GIBBON_ARCHIVE_RESULT_ANY = 0,
+        GIBBON_ARCHIVE_RESULT_WON = 1,
+        GIBBON_ARCHIVE_RESULT_LOST = 2,
+        GIBBON_ARCHIVE_RESULT_UNFINISHED = 3
+} GibbonArchiveResult;
+
+/**
+ * GibbonArchiveEntry:
+ * @path: Absolute path to the match file.
+ * @white: Name of the owner of the archive.
+ * @opponent: Name of the opponent.
+ * @match_length: Length of the match or 0 for unlimited matches.
+ * @scores: The final score, white first.
+ * @start_time: Start of the match in microseconds since the epoch.
+ * @result: The outcome of the match.
+ * @error_rates: Error rates of white and the opponent or a negative
+ *               value if the match has not been analyzed.
+ *
+ * A boxed type for one record in the catalogue of archived matches.
+ **/
+typedef struct _GibbonArchiveEntry GibbonArchiveEntry;
+struct _GibbonArchiveEntry
+{
+        gchar *path;
+        gchar *white;
+        gchar *opponent;
+        guint match_length;
+        guint scores[2];
+        gint64 start_time;
+        GibbonArchiveResult result;
+        gdouble error_rates[2];
+};
+
+GType gibbon_archive_entry_get_type (void) G_GNUC_CONST;
+
+GibbonArchiveEntry *gibbon_archive_entry_new (const gchar *path,
+                                              const gchar *white,
+                                              const gchar *opponent,
+                                              guint match_length,
+                                              guint score1, guint score2,
+                                              gint64 start_time);
+GibbonArchiveEntry *gibbon_archive_entry_copy (const GibbonArchiveEntry *self);
+void gibbon_archive_entry_free (GibbonArchiveEntry *self);
+
+#endif
@@ -55,6 +55,14 @@
  * simply the number of recorded events.  The other is a a rating for the
  * player's reliability, which is the average of all recorded bonusses and
  * malusses.
+ *
+ * Finished matches are filed gzip compressed into a directory tree
+ * YYYY/MM/DD below the session directory.  All match readers decompress
+ * such files transparently.  A catalogue of these files is kept in the
+ * database.  It is updated whenever a match is archived and synchronized
+ * with the file system on demand.  Only day directories that have been
+ * modified since the last synchronization are read again, and only files
+ * that are not yet catalogued are parsed.
  **/
 
 #ifdef HAVE_CONFIG_H
@@ -92,6 +100,12 @@ static GHashTable *gibbon_archive_countries = NULL;
                         "[-.]" GIBBON_ARCHIVE_RE_OCTET
 GRegex *gibbon_archive_re_ip = NULL;
 
+/*
+ * Meta information about the matches in the saved directory, so that they
+ * do not have to be parsed on every login.
+ */
+#define GIBBON_ARCHIVE_SAVED_INDEX "index.ini"
+
 typedef struct _GibbonArchiveLookupInfo {
         gchar *hostname;
         GibbonGeoIPCallback callback;
@@ -108,6 +122,11 @@ struct _GibbonArchivePrivate {
         GibbonDatabase *db;
 
         GHashTable *droppers;
+
+        GKeyFile *saved_index;
+
+        /* TRUE until the catalogue has been scanned for this session.  */
+        gboolean catalogue_dirty;
 };
 
 #define GIBBON_ARCHIVE_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
@@ -123,9 +142,46 @@ static void gibbon_archive_remove_from_droppers (GibbonArchive *self,
 
 static void gibbon_archive_on_resolve (GObject *resolver, GAsyncResult *result,
                                        gpointer data);
+static GKeyFile *gibbon_archive_get_saved_index (const GibbonArchive *self,
+                                                 const gchar *saved_directory);
+static gboolean gibbon_archive_write_saved_index (const GibbonArchive *self,
+                                                  const gchar *saved_directory,
+                                                  GError **error);
+static void gibbon_archive_index_saved (GKeyFile *index,
+                                        const gchar *filename,
+                                        const struct stat *st,
+                                        const GibbonMatch *match);
+static gboolean gibbon_archive_lookup_saved (GKeyFile *index,
+                                             const gchar *filename,
+                                             const struct stat *st,
+                                             gchar **white, gchar **black,
+                                             gsize *match_length,
+                                             guint *white_score,
+                                             guint *black_score);
+static gchar *gibbon_archive_saved_basename (const GibbonArchive *self,
+                                             const gchar *path,
+                                             gchar **saved_directory);
 static void gibbon_archive_on_resolve_ip (GObject *resolver,
                                           GAsyncResult *result,
                                           gpointer data);
+static gboolean gibbon_archive_is_number (const gchar *name, gsize digits);
+static gchar *gibbon_archive_get_servers_directory (GError **error);
+static gboolean gibbon_archive_catalogue_day (const GibbonArchive *self,
+                                              const gchar *directory,
+                                              GError **error);
+static GOutputStream *gibbon_archive_compressor (GOutputStream *out);
+static gboolean gibbon_archive_compress_file (const gchar *src_path,
+                                              const gchar *dest_path,
+                                              GError **error);
+static gboolean gibbon_archive_is_day_directory (const gchar *directory);
+static gboolean gibbon_archive_compress_directory (const gchar *directory,
+                                                   guint *count,
+                                                   GError **error);
+static void gibbon_archive_catalogue_file (const GibbonArchive *self,
+                                           const gchar *session_directory,
+                                           const gchar *path,
+                                           const GibbonMatchReaderInfo *info,
+                                           const GibbonMatch *match);
 
 static void 
 gibbon_archive_init (GibbonArchive *self)
@@ -138,6 +194,8 @@ gibbon_archive_init (GibbonArchive *self)
         self->priv->session_directory = NULL;
         self->priv->db = NULL;
         self->priv->droppers = NULL;
+        self->priv->saved_index = NULL;
+        self->priv->catalogue_dirty = TRUE;
 }
 
 static void
@@ -155,6 +213,9 @@ gibbon_archive_finalize (GObject *object)
         if (self->priv->db)
                 g_object_unref (self->priv->db);
 
+        if (self->priv->saved_index)
+                g_key_file_free (self->priv->saved_index);
+
         G_OBJECT_CLASS (gibbon_archive_parent_class)->finalize(object);
 }
 
@@ -180,43 +241,59 @@ gibbon_archive_class_init (GibbonArchiveClass *klass)
         object_class->finalize = gibbon_archive_finalize;
 }
 
-GibbonArchive *
-gibbon_archive_new (GError **error)
+static gchar *
+gibbon_archive_get_servers_directory (GError **error)
 {
-        GibbonArchive *self;
         const gchar *documents_servers_directory;
-        gchar *db_path;
+        gchar *servers_directory;
         mode_t mode;
 
-        self = g_object_new (GIBBON_TYPE_ARCHIVE, NULL);
-
         documents_servers_directory = g_get_user_data_dir ();
 
         if (!documents_servers_directory) {
                 g_set_error_literal (error, GIBBON_ERROR, -1,
                                      _("Cannot determine user data"
                                        " directory!"));
-                g_object_unref (self);
                 return NULL;
         }
 
-        self->priv->servers_directory = g_build_filename (documents_servers_directory,
-                                                  PACKAGE, "servers", NULL);
+        servers_directory = g_build_filename (documents_servers_directory,
+                                              PACKAGE, "servers", NULL);
 
 #ifdef G_OS_WIN32
 	mode = S_IRWXU;
 #else
         mode = S_IRWXU | (S_IRWXG & ~S_IWGRP) | (S_IRWXO & ~S_IWOTH);
 #endif
-        if (0 != g_mkdir_with_parents (self->priv->servers_directory, mode)) {
+        if (0 != g_mkdir_with_parents (servers_directory, mode)) {
                 g_set_error (error, GIBBON_ERROR, -1,
                              _("Failed to create"
                                " server directory `%s': %s!"),
-                              self->priv->servers_directory,
+                              servers_directory,
                               strerror (errno));
+                g_free (servers_directory);
+                return NULL;
+        }
+
+        return servers_directory;
+}
+
+GibbonArchive *
+gibbon_archive_new (GError **error)
+{
+        GibbonArchive *self;
+        const gchar *documents_servers_directory;
+        gchar *db_path;
+
+        self = g_object_new (GIBBON_TYPE_ARCHIVE, NULL);
+
+        self->priv->servers_directory =
+                gibbon_archive_get_servers_directory (error);
+        if (!self->priv->servers_directory) {
                 g_object_unref (self);
                 return NULL;
         }
+        documents_servers_directory = g_get_user_data_dir ();
 
         db_path = g_build_filename (documents_servers_directory,
                                     PACKAGE, "db.sqlite", NULL);
@@ -259,10 +336,17 @@ gibbon_archive_login (GibbonArchive *self, const gchar *hostname,
         g_free (self->priv->server_directory);
         self->priv->server_directory = session_directory;
 
+        /* The index of saved matches is per server.  */
+        if (self->priv->saved_index) {
+                g_key_file_free (self->priv->saved_index);
+                self->priv->saved_index = NULL;
+        }
+
         buf = g_build_filename (session_directory, login, NULL);
 
         g_free (self->priv->session_directory);
         self->priv->session_directory = buf;
+        self->priv->catalogue_dirty = TRUE;
 
 #ifdef G_OS_WIN32
 	mode = S_IRWXU;
@@ -946,26 +1030,47 @@ gibbon_archive_archive_match_file (const GibbonArchive *self,
         const gchar *opponent;
         gchar *filename;
         gchar *path;
-        GFile *src, *dest;
         gboolean result;
         GibbonMatchReader *reader;
+        GibbonMatchReaderInfo info;
+        GibbonMatch *parsed = NULL;
 
         gibbon_return_val_if_fail (GIBBON_IS_ARCHIVE (self), FALSE, error);
 
-        if (!match) {
+        /*
+         * The catalogue needs the score and the error rates, and they are
+         * only known from the complete match.  Stale saved matches are
+         * rare, so parsing one here is affordable.  If that fails, the
+         * start time and the opponent are still good enough for archiving
+         * the file.
+         */
+        memset (&info, 0, sizeof info);
+        if (match) {
+                gibbon_return_val_if_fail (GIBBON_IS_MATCH (match), FALSE,
+                                           error);
+                gibbon_match_reader_info_from_match (&info, match, TRUE);
+        } else {
                 reader = GIBBON_MATCH_READER (gibbon_gmd_reader_new (NULL,
                                                                      NULL));
-                match = gibbon_match_reader_parse (reader, match_file);
-                if (!match) {
+                parsed = gibbon_match_reader_parse (reader, match_file);
+                if (parsed) {
+                        match = parsed;
+                        gibbon_match_reader_info_from_match (&info, match,
+                                                             TRUE);
+                        result = TRUE;
+                } else {
+                        result = gibbon_match_reader_peek (reader, match_file,
+                                                           &info, FALSE);
+                }
+                g_object_unref (reader);
+                if (!result) {
                         /* Ignore errors.  */
                         (void) g_remove (match_file);
                         return TRUE;
                 }
         }
 
-        gibbon_return_val_if_fail (GIBBON_IS_MATCH (match), FALSE, error);
-
-        start = gibbon_match_get_start_time (match);
+        start = info.start_time;
         if (start == G_MININT64)
                 start = g_get_real_time ();
         dt = g_date_time_new_from_unix_local (start / 1000000);
@@ -975,6 +1080,9 @@ gibbon_archive_archive_match_file (const GibbonArchive *self,
                              -1,
                              _("Match start time `%lld' out of range!"),
                              (long long) start);
+                gibbon_match_reader_info_clear (&info);
+                if (parsed)
+                        g_object_unref (parsed);
                 return FALSE;
         }
         g_date_time_get_ymd (dt, &y, &m, &d);
@@ -1003,29 +1111,45 @@ gibbon_archive_archive_match_file (const GibbonArchive *self,
                              _("Failed to create directory `%s': %s!"),
                                directory,
                                strerror (errno));
+                g_free (directory);
+                gibbon_match_reader_info_clear (&info);
+                if (parsed)
+                        g_object_unref (parsed);
                 return FALSE;
         }
 
-        opponent = gibbon_match_get_black (match);
+        opponent = info.black;
         if (start < 0)
-                filename = g_strdup_printf ("-%016llx-%s.gmd",
+                filename = g_strdup_printf ("-%016llx-%s.gmd.gz",
                                             (unsigned long long) -start,
                                             opponent);
         else
-                filename = g_strdup_printf ("%016llx-%s.gmd",
+                filename = g_strdup_printf ("%016llx-%s.gmd.gz",
                                             (unsigned long long) start,
                                             opponent);
         path = g_build_filename (directory, filename, NULL);
         g_free (directory);
         g_free (filename);
 
-        src = g_file_new_for_path (match_file);
-        dest = g_file_new_for_path (path);
-        result = g_file_move (src, dest, G_FILE_COPY_NONE,
-                              NULL, NULL, NULL, error);
-        g_object_unref (src);
-        g_object_unref (dest);
+        result = gibbon_archive_compress_file (match_file, path, error);
+
+        if (result) {
+                gibbon_archive_forget_saved (self, match_file);
+
+                /*
+                 * Without the match, the score is not known.  The file
+                 * is catalogued with the next synchronization instead.
+                 */
+                if (match)
+                        gibbon_archive_catalogue_file (
+                                        self, self->priv->session_directory,
+                                        path, &info, match);
+        }
+
         g_free (path);
+        gibbon_match_reader_info_clear (&info);
+        if (parsed)
+                g_object_unref (parsed);
 
         return result;
 }
@@ -1044,11 +1168,13 @@ gibbon_archive_save_match (const GibbonArchive *self,
         GDateTime *dt;
         gint y, m, d;
         gchar *directory;
+        gchar *session_directory;
         gint mode;
         gchar *filename;
         gchar *path;
         gboolean result;
         GibbonMatchWriter *writer;
+        GibbonMatchReaderInfo info;
         GFile *file = NULL;
         GFileOutputStream *fout;
         GOutputStream *out;
@@ -1105,11 +1231,11 @@ gibbon_archive_save_match (const GibbonArchive *self,
         }
 
         if (start < 0)
-                filename = g_strdup_printf ("-%016llx-%s.gmd",
+                filename = g_strdup_printf ("-%016llx-%s.gmd.gz",
                                             (unsigned long long) -start,
                                             black);
         else
-                filename = g_strdup_printf ("%016llx-%s.gmd",
+                filename = g_strdup_printf ("%016llx-%s.gmd.gz",
                                             (unsigned long long) start,
                                             black);
         path = g_build_filename (directory, filename, NULL);
@@ -1117,32 +1243,51 @@ gibbon_archive_save_match (const GibbonArchive *self,
         g_free (filename);
 
         file = g_file_new_for_path (path);
-        g_free (path);
 
         fout = g_file_replace (file, NULL, FALSE, G_FILE_COPY_OVERWRITE,
                                NULL, error);
         g_object_unref (file);
-        if (!fout)
+        if (!fout) {
+                g_free (path);
                 return FALSE;
+        }
 
-        out = G_OUTPUT_STREAM (fout);
+        out = gibbon_archive_compressor (G_OUTPUT_STREAM (fout));
+        g_object_unref (fout);
 
         writer = GIBBON_MATCH_WRITER (gibbon_gmd_writer_new ());
         result = gibbon_match_writer_write_stream (writer, out, match, error);
 
+        /* Closing the stream writes the gzip trailer.  */
+        if (result)
+                result = g_output_stream_close (out, NULL, error);
+
         g_object_unref (writer);
         g_object_unref (out);
 
-        if (!result)
+        if (!result) {
+                g_free (path);
                 return FALSE;
+        }
+
+        memset (&info, 0, sizeof info);
+        gibbon_match_reader_info_from_match (&info, match, TRUE);
+        session_directory = g_build_filename (self->priv->server_directory,
+                                              white, NULL);
+        gibbon_archive_catalogue_file (self, session_directory, path, &info,
+                                       match);
+        g_free (session_directory);
+        gibbon_match_reader_info_clear (&info);
+        g_free (path);
 
         match_length = gibbon_match_get_length (match);
         score1 = gibbon_match_get_white_score (match);
         score2 = gibbon_match_get_black_score (match);
 
         if (!gibbon_database_save_match (self->priv->db, hostname, port,
-                                         white, black, start,
-                                         match_length, score1, score2,
+                                         white, black,
+                                         match_length, score1, score2, start,
+                                         gibbon_match_get_statistics (match),
                                          error))
                 return FALSE;
 
@@ -1294,12 +1439,18 @@ gibbon_archive_get_saved (const GibbonArchive *self,
         gchar *path;
         GibbonMatchReader *reader;
         GibbonMatch *match;
-        const gchar *white;
-        const gchar *black;
+        gchar *white;
+        gchar *black;
         const gchar *opponent;
         gsize match_length;
         guint white_score, black_score;
+        guint score_self, score_opp;
         GibbonSavedInfo *saved_info;
+        GKeyFile *saved_index;
+        struct stat st;
+        gboolean dirty = FALSE;
+        gchar **groups;
+        gsize i;
 
         /*
          * The function never fails.  Even in case of errors we still return
@@ -1324,6 +1475,8 @@ gibbon_archive_get_saved (const GibbonArchive *self,
                 return table;
         }
 
+        saved_index = gibbon_archive_get_saved_index (self, saved_directory);
+
         login_length = strlen (login);
         while ((filename = g_dir_read_name (dir)) != NULL) {
                 first_percent = index (filename, '%');
@@ -1337,45 +1490,726 @@ gibbon_archive_get_saved (const GibbonArchive *self,
                                         ".gmd")))
                         continue;
 
-                reader = GIBBON_MATCH_READER (gibbon_gmd_reader_new (NULL,
-                                                                     NULL));
                 path = g_build_filename (saved_directory, filename, NULL);
-                match = gibbon_match_reader_parse (reader, path);
-                g_object_unref (reader);
-                if (!match || !gibbon_match_get_current_game (match)) {
-                        g_remove (path);
+                if (0 != g_stat (path, &st)) {
                         g_free (path);
                         continue;
                 }
-                g_free (path);
 
-                white = gibbon_match_get_white (match);
-                black = gibbon_match_get_black (match);
-                match_length = gibbon_match_get_length (match);
+                /*
+                 * Only files that have changed since they were last indexed
+                 * have to be parsed.
+                 */
+                if (!gibbon_archive_lookup_saved (saved_index, filename,
+                                                  &st, &white, &black,
+                                                  &match_length,
+                                                  &white_score,
+                                                  &black_score)) {
+                        reader = GIBBON_MATCH_READER (
+                                        gibbon_gmd_reader_new (NULL, NULL));
+                        match = gibbon_match_reader_parse (reader, path);
+                        g_object_unref (reader);
+                        if (!match || !gibbon_match_get_current_game (match)) {
+                                if (match)
+                                        g_object_unref (match);
+                                g_remove (path);
+                                g_free (path);
+                                g_key_file_remove_group (saved_index,
+                                                         filename, NULL);
+                                dirty = TRUE;
+                                continue;
+                        }
+                        gibbon_archive_index_saved (saved_index, filename,
+                                                    &st, match);
+                        g_object_unref (match);
+                        dirty = TRUE;
+
+                        (void) gibbon_archive_lookup_saved (saved_index,
+                                                            filename, &st,
+                                                            &white, &black,
+                                                            &match_length,
+                                                            &white_score,
+                                                            &black_score);
+                }
+                g_free (path);
 
                 if (!g_strcmp0 (white, login)) {
                         opponent = black;
-                        white_score = gibbon_match_get_white_score (match);
-                        black_score = gibbon_match_get_black_score (match);
+                        score_self = white_score;
+                        score_opp = black_score;
                 } else if (!g_strcmp0 (black, login)) {
                         opponent = white;
-                        white_score = gibbon_match_get_black_score (match);
-                        black_score = gibbon_match_get_white_score (match);
+                        score_self = black_score;
+                        score_opp = white_score;
                 } else {
                         /*
                          * FIXME! Remove matches that are older than N weeks!
                          */
-                        g_object_unref (match);
+                        g_free (white);
+                        g_free (black);
                         continue;
                 }
 
                 saved_info = gibbon_saved_info_new (opponent, match_length,
-                                                    white_score, black_score);
+                                                    score_self, score_opp);
                 g_hash_table_insert (table, g_strdup (filename), saved_info);
-                g_object_unref (match);
+                g_free (white);
+                g_free (black);
         }
+        g_dir_close (dir);
+
+        /* Drop index entries for files that have vanished in the meantime.  */
+        groups = g_key_file_get_groups (saved_index, NULL);
+        for (i = 0; groups[i]; ++i) {
+                path = g_build_filename (saved_directory, groups[i], NULL);
+                if (!g_file_test (path, G_FILE_TEST_EXISTS)) {
+                        g_key_file_remove_group (saved_index, groups[i], NULL);
+                        dirty = TRUE;
+                }
+                g_free (path);
+        }
+        g_strfreev (groups);
+
+        if (dirty)
+                (void) gibbon_archive_write_saved_index (self, saved_directory,
+                                                         NULL);
 
         g_free (saved_directory);
 
         return table;
 }
+
+/**
+ * gibbon_archive_update_saved:
+ * @self: The #GibbonArchive.
+ * @path: Path to a saved match file.
+ * @match: The #GibbonMatch that was written to @path.
+ * @error: a #GError location or %NULL.
+ *
+ * Record the meta information of a saved match in the index of saved
+ * matches, so that gibbon_archive_get_saved() does not have to parse it
+ * again.  An entry that does not match the size and modification time of
+ * the file is ignored, so it is sufficient to call this from time to time.
+ *
+ * Returns: %TRUE for success, %FALSE for failure.
+ */
+gboolean
+gibbon_archive_update_saved (const GibbonArchive *self,
+                             const gchar *path,
+                             const GibbonMatch *match,
+                             GError **error)
+{
+        gchar *saved_directory;
+        gchar *filename;
+        GKeyFile *index;
+        struct stat st;
+        gboolean result;
+
+        gibbon_return_val_if_fail (GIBBON_IS_ARCHIVE (self), FALSE, error);
+        gibbon_return_val_if_fail (path != NULL, FALSE, error);
+        gibbon_return_val_if_fail (GIBBON_IS_MATCH (match), FALSE, error);
+
+        filename = gibbon_archive_saved_basename (self, path, &saved_directory);
+        if (!filename)
+                return TRUE;
+
+        if (0 != g_stat (path, &st)) {
+                g_set_error (error, GIBBON_ERROR, -1,
+                             _("Cannot stat `%s': %s!"),
+                             path, strerror (errno));
+                g_free (filename);
+                g_free (saved_directory);
+                return FALSE;
+        }
+
+        index = gibbon_archive_get_saved_index (self, saved_directory);
+        gibbon_archive_index_saved (index, filename, &st, match);
+        result = gibbon_archive_write_saved_index (self, saved_directory,
+                                                   error);
+
+        g_free (filename);
+        g_free (saved_directory);
+
+        return result;
+}
+
+/**
+ * gibbon_archive_forget_saved:
+ * @self: The #GibbonArchive.
+ * @path: Path to a saved match file.
+ *
+ * Remove a saved match from the index of saved matches.  Paths outside of
+ * the directory for saved matches are silently ignored.
+ */
+void
+gibbon_archive_forget_saved (const GibbonArchive *self, const gchar *path)
+{
+        gchar *saved_directory;
+        gchar *filename;
+        GKeyFile *index;
+
+        g_return_if_fail (GIBBON_IS_ARCHIVE (self));
+        g_return_if_fail (path != NULL);
+
+        filename = gibbon_archive_saved_basename (self, path, &saved_directory);
+        if (!filename)
+                return;
+
+        index = gibbon_archive_get_saved_index (self, saved_directory);
+        if (g_key_file_remove_group (index, filename, NULL))
+                (void) gibbon_archive_write_saved_index (self, saved_directory,
+                                                         NULL);
+
+        g_free (filename);
+        g_free (saved_directory);
+}
+
+static gchar *
+gibbon_archive_saved_basename (const GibbonArchive *self, const gchar *path,
+                               gchar **saved_directory)
+{
+        gchar *dirname;
+
+        *saved_directory = gibbon_archive_get_saved_directory (self, NULL);
+        if (!*saved_directory)
+                return NULL;
+
+        dirname = g_path_get_dirname (path);
+        if (g_strcmp0 (dirname, *saved_directory)) {
+                g_free (dirname);
+                g_free (*saved_directory);
+                *saved_directory = NULL;
+                return NULL;
+        }
+        g_free (dirname);
+
+        return g_path_get_basename (path);
+}
+
+static GKeyFile *
+gibbon_archive_get_saved_index (const GibbonArchive *self,
+                                const gchar *saved_directory)
+{
+        gchar *path;
+
+        if (self->priv->saved_index)
+                return self->priv->saved_index;
+
+        self->priv->saved_index = g_key_file_new ();
+
+        path = g_build_filename (saved_directory, GIBBON_ARCHIVE_SAVED_INDEX,
+                                 NULL);
+
+        /*
+         * A missing or corrupt index is not an error.  It will be
+         * rebuilt from the saved matches.
+         */
+        if (!g_key_file_load_from_file (self->priv->saved_index, path,
+                                        G_KEY_FILE_NONE, NULL)) {
+                g_key_file_free (self->priv->saved_index);
+                self->priv->saved_index = g_key_file_new ();
+        }
+        g_free (path);
+
+        return self->priv->saved_index;
+}
+
+static gboolean
+gibbon_archive_write_saved_index (const GibbonArchive *self,
+                                  const gchar *saved_directory,
+                                  GError **error)
+{
+        gchar *path;
+        gchar *data;
+        gsize length;
+        gboolean result;
+
+        data = g_key_file_to_data (self->priv->saved_index, &length, NULL);
+        path = g_build_filename (saved_directory, GIBBON_ARCHIVE_SAVED_INDEX,
+                                 NULL);
+        result = g_file_set_contents (path, data, length, error);
+        g_free (path);
+        g_free (data);
+
+        return result;
+}
+
+static void
+gibbon_archive_index_saved (GKeyFile *index, const gchar *filename,
+                            const struct stat *st, const GibbonMatch *match)
+{
+        g_key_file_set_string (index, filename, "white",
+                               gibbon_match_get_white (match));
+        g_key_file_set_string (index, filename, "black",
+                               gibbon_match_get_black (match));
+        g_key_file_set_uint64 (index, filename, "length",
+                               gibbon_match_get_length (match));
+        g_key_file_set_integer (index, filename, "white-score",
+                                gibbon_match_get_white_score (match));
+        g_key_file_set_integer (index, filename, "black-score",
+                                gibbon_match_get_black_score (match));
+        g_key_file_set_int64 (index, filename, "mtime", st->st_mtime);
+        g_key_file_set_uint64 (index, filename, "size", st->st_size);
+}
+
+static gboolean
+gibbon_archive_lookup_saved (GKeyFile *index, const gchar *filename,
+                             const struct stat *st,
+                             gchar **white, gchar **black,
+                             gsize *match_length,
+                             guint *white_score, guint *black_score)
+{
+        /*
+         * Missing keys read as zero and will therefore not match the
+         * file's current status.
+         */
+        if (g_key_file_get_int64 (index, filename, "mtime", NULL)
+            != st->st_mtime)
+                return FALSE;
+        if (g_key_file_get_uint64 (index, filename, "size", NULL)
+            != st->st_size)
+                return FALSE;
+
+        *white = g_key_file_get_string (index, filename, "white", NULL);
+        *black = g_key_file_get_string (index, filename, "black", NULL);
+        if (!*white || !*black) {
+                g_free (*white);
+                g_free (*black);
+                return FALSE;
+        }
+
+        *match_length = g_key_file_get_uint64 (index, filename, "length",
+                                               NULL);
+        *white_score = g_key_file_get_integer (index, filename, "white-score",
+                                               NULL);
+        *black_score = g_key_file_get_integer (index, filename, "black-score",
+                                               NULL);
+
+        return TRUE;
+}
+
+/**
+ * gibbon_archive_update_catalogue:
+ * @self: The #GibbonArchive.
+ * @error: Location for errors.
+ *
+ * Synchronize the catalogue of archived matches for the current session
+ * with the file system.  Day directories that have not been modified
+ * since the last call are skipped.
+ *
+ * Returns: %TRUE for success, %FALSE for failure.
+ */
+gboolean
+gibbon_archive_update_catalogue (const GibbonArchive *self, GError **error)
+{
+        GDir *years, *months, *days;
+        const gchar *year, *month, *day;
+        gchar *year_path, *month_path, *day_path;
+        gboolean retval = TRUE;
+
+        gibbon_return_val_if_fail (GIBBON_IS_ARCHIVE (self), FALSE, error);
+        gibbon_return_val_if_fail (self->priv->session_directory != NULL,
+                                   FALSE, error);
+
+        years = g_dir_open (self->priv->session_directory, 0, NULL);
+        if (!years)
+                return TRUE;
+
+        while (retval && (year = g_dir_read_name (years))) {
+                if (!gibbon_archive_is_number (year, 4))
+                        continue;
+                year_path = g_build_filename (self->priv->session_directory,
+                                              year, NULL);
+                months = g_dir_open (year_path, 0, NULL);
+                if (!months) {
+                        g_free (year_path);
+                        continue;
+                }
+                while (retval && (month = g_dir_read_name (months))) {
+                        if (!gibbon_archive_is_number (month, 2))
+                                continue;
+                        month_path = g_build_filename (year_path, month, NULL);
+                        days = g_dir_open (month_path, 0, NULL);
+                        if (!days) {
+                                g_free (month_path);
+                                continue;
+                        }
+                        while (retval && (day = g_dir_read_name (days))) {
+                                if (!gibbon_archive_is_number (day, 2))
+                                        continue;
+                                day_path = g_build_filename (month_path, day,
+                                                             NULL);
+                                retval = gibbon_archive_catalogue_day (
+                                                self, day_path, error);
+                                g_free (day_path);
+                        }
+                        g_dir_close (days);
+                        g_free (month_path);
+                }
+                g_dir_close (months);
+                g_free (year_path);
+        }
+
+        g_dir_close (years);
+
+        /*
+         * Matches archived by this instance are added to the catalogue
+         * right away.  A new scan is therefore only needed for a new
+         * session.
+         */
+        if (retval)
+                self->priv->catalogue_dirty = FALSE;
+
+        return retval;
+}
+
+/**
+ * gibbon_archive_query:
+ * @self: The #GibbonArchive.
+ * @opponent: Name of the opponent or %NULL for all opponents.
+ * @from: Earliest start time in microseconds since the epoch or %G_MININT64.
+ * @to: Latest start time (exclusive) or %G_MAXINT64.
+ * @result: Only return matches with this result.
+ * @error: Location for errors.
+ *
+ * Search the archived matches of the current session.  The catalogue is
+ * synchronized with the file system once per session, before the first
+ * query.  Use gibbon_archive_update_catalogue() to force a new scan.
+ *
+ * Returns: A #GSList of #GibbonArchiveEntry records sorted by start time,
+ * or %NULL if nothing was found or in case of failure.  Free it with
+ * g_slist_free_full() and gibbon_archive_entry_free().
+ */
+GSList *
+gibbon_archive_query (const GibbonArchive *self, const gchar *opponent,
+                      gint64 from, gint64 to, GibbonArchiveResult result,
+                      GError **error)
+{
+        gibbon_return_val_if_fail (GIBBON_IS_ARCHIVE (self), NULL, error);
+        gibbon_return_val_if_fail (self->priv->session_directory != NULL,
+                                   NULL, error);
+
+        if (self->priv->catalogue_dirty
+            && !gibbon_archive_update_catalogue (self, error))
+                return NULL;
+
+        return gibbon_database_query_catalogue (self->priv->db,
+                                                self->priv->session_directory,
+                                                opponent, from, to, result,
+                                                error);
+}
+
+static gboolean
+gibbon_archive_is_number (const gchar *name, gsize digits)
+{
+        gsize i;
+
+        for (i = 0; i < digits; ++i)
+                if (!g_ascii_isdigit (name[i]))
+                        return FALSE;
+
+        return name[i] == 0;
+}
+
+static gboolean
+gibbon_archive_catalogue_day (const GibbonArchive *self,
+                              const gchar *directory, GError **error)
+{
+        struct stat st;
+        gint64 mtime, last_mtime;
+        GHashTable *known;
+        GHashTableIter iter;
+        gpointer key;
+        GDir *dir;
+        const gchar *name;
+        gchar *path;
+        gchar *endptr;
+        GibbonMatchReader *reader;
+        GibbonMatchReaderInfo info;
+        GibbonArchiveEntry *entry;
+        GSList *added = NULL;
+        GSList *removed = NULL;
+        gboolean retval;
+
+        if (0 != g_stat (directory, &st))
+                return TRUE;
+        mtime = (gint64) st.st_mtime;
+
+        if (gibbon_database_get_archive_directory (self->priv->db, directory,
+                                                   &last_mtime)
+            && last_mtime == mtime)
+                return TRUE;
+
+        known = gibbon_database_get_archived_paths (self->priv->db, directory,
+                                                    error);
+        if (!known)
+                return FALSE;
+
+        dir = g_dir_open (directory, 0, NULL);
+        while (dir && (name = g_dir_read_name (dir))) {
+                if (!g_str_has_suffix (name, ".gmd")
+                    && !g_str_has_suffix (name, ".gmd.gz"))
+                        continue;
+                path = g_build_filename (directory, name, NULL);
+
+                /* Archived files never change.  */
+                if (g_hash_table_remove (known, path)) {
+                        g_free (path);
+                        continue;
+                }
+
+                /* Readers keep per-file state.  Never share them.  */
+                reader = GIBBON_MATCH_READER (gibbon_gmd_reader_new (NULL,
+                                                                     NULL));
+                if (!gibbon_match_reader_peek (reader, path, &info, TRUE)) {
+                        g_object_unref (reader);
+                        g_free (path);
+                        continue;
+                }
+                g_object_unref (reader);
+                if (!info.white || !info.black) {
+                        gibbon_match_reader_info_clear (&info);
+                        g_free (path);
+                        continue;
+                }
+
+                /* The file name contains the start time in hex.  */
+                if (info.start_time == G_MININT64) {
+                        info.start_time = g_ascii_strtoll (name, &endptr, 16);
+                        if (*endptr != '-')
+                                info.start_time = G_MININT64;
+                }
+
+                entry = gibbon_archive_entry_new (path, info.white, info.black,
+                                                  info.length,
+                                                  info.scores[0],
+                                                  info.scores[1],
+                                                  info.start_time);
+                added = g_slist_prepend (added, entry);
+                gibbon_match_reader_info_clear (&info);
+                g_free (path);
+        }
+        if (dir)
+                g_dir_close (dir);
+
+        g_hash_table_iter_init (&iter, known);
+        while (g_hash_table_iter_next (&iter, &key, NULL))
+                removed = g_slist_prepend (removed, key);
+
+        retval = gibbon_database_catalogue_directory (
+                        self->priv->db, self->priv->session_directory,
+                        directory, mtime, added, removed, error);
+
+        g_slist_free (removed);
+        g_hash_table_destroy (known);
+        g_slist_free_full (added, (GDestroyNotify) gibbon_archive_entry_free);
+
+        return retval;
+}
+
+static void
+gibbon_archive_catalogue_file (const GibbonArchive *self,
+                               const gchar *session_directory,
+                               const gchar *path,
+                               const GibbonMatchReaderInfo *info,
+                               const GibbonMatch *match)
+{
+        GibbonArchiveEntry *entry;
+        const GibbonMatchStatistics *statistics;
+        GError *error = NULL;
+
+        if (!info->white || !info->black)
+                return;
+
+        entry = gibbon_archive_entry_new (path, info->white, info->black,
+                                          info->length,
+                                          info->scores[0], info->scores[1],
+                                          info->start_time);
+
+        /* Negative if the match has not been analysed.  */
+        statistics = gibbon_match_get_statistics (match);
+        entry->error_rates[0] = gibbon_match_statistics_get_error_rate (
+                        statistics, GIBBON_POSITION_SIDE_WHITE);
+        entry->error_rates[1] = gibbon_match_statistics_get_error_rate (
+                        statistics, GIBBON_POSITION_SIDE_BLACK);
+
+        /*
+         * Not fatal, the error has already been reported.  The next
+         * synchronization will fix it.
+         */
+        if (!gibbon_database_catalogue_match (self->priv->db,
+                                              session_directory,
+                                              entry, &error))
+                g_error_free (error);
+
+        gibbon_archive_entry_free (entry);
+}
+
+/**
+ * gibbon_archive_compress:
+ * @count: Location for the number of compressed files or %NULL.
+ * @error: Location for errors.
+ *
+ * Compress all match files in the archives of all servers and accounts
+ * that were written uncompressed by older versions.  The catalogue picks
+ * up the renamed files with the next synchronization.
+ *
+ * This only works on the file system.  The database is not opened, so
+ * that this can be used from the command line without a #GibbonApp.
+ *
+ * Returns: %TRUE for success, %FALSE for failure.
+ */
+gboolean
+gibbon_archive_compress (guint *count, GError **error)
+{
+        gchar *servers_directory;
+        gboolean retval;
+        guint dummy;
+
+        if (!count)
+                count = &dummy;
+        *count = 0;
+
+        servers_directory = gibbon_archive_get_servers_directory (error);
+        if (!servers_directory)
+                return FALSE;
+
+        retval = gibbon_archive_compress_directory (servers_directory, count,
+                                                    error);
+        g_free (servers_directory);
+
+        return retval;
+}
+
+static GOutputStream *
+gibbon_archive_compressor (GOutputStream *out)
+{
+        GConverter *compressor;
+        GOutputStream *retval;
+
+        compressor = G_CONVERTER (g_zlib_compressor_new (
+                                        G_ZLIB_COMPRESSOR_FORMAT_GZIP, -1));
+        retval = g_converter_output_stream_new (out, compressor);
+        g_object_unref (compressor);
+
+        return retval;
+}
+
+static gboolean
+gibbon_archive_compress_file (const gchar *src_path, const gchar *dest_path,
+                              GError **error)
+{
+        GFile *src, *dest;
+        GFileInputStream *fin;
+        GFileOutputStream *fout;
+        GOutputStream *out;
+        gssize copied;
+
+        src = g_file_new_for_path (src_path);
+        fin = g_file_read (src, NULL, error);
+        g_object_unref (src);
+        if (!fin)
+                return FALSE;
+
+        dest = g_file_new_for_path (dest_path);
+        fout = g_file_replace (dest, NULL, FALSE, G_FILE_CREATE_NONE,
+                               NULL, error);
+        g_object_unref (dest);
+        if (!fout) {
+                g_object_unref (fin);
+                return FALSE;
+        }
+
+        out = gibbon_archive_compressor (G_OUTPUT_STREAM (fout));
+        g_object_unref (fout);
+
+        copied = g_output_stream_splice (out, G_INPUT_STREAM (fin),
+                                         G_OUTPUT_STREAM_SPLICE_CLOSE_SOURCE
+                                         | G_OUTPUT_STREAM_SPLICE_CLOSE_TARGET,
+                                         NULL, error);
+        g_object_unref (out);
+        g_object_unref (fin);
+
+        if (copied < 0) {
+                (void) g_remove (dest_path);
+                return FALSE;
+        }
+
+        if (0 != g_remove (src_path)) {
+                g_set_error (error, GIBBON_ERROR, -1,
+                             _("Error removing `%s': %s!"),
+                             src_path, strerror (errno));
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+static gboolean
+gibbon_archive_is_day_directory (const gchar *directory)
+{
+        gchar *day, *month, *year;
+        gchar *month_path, *year_path;
+        gboolean retval;
+
+        day = g_path_get_basename (directory);
+        month_path = g_path_get_dirname (directory);
+        month = g_path_get_basename (month_path);
+        year_path = g_path_get_dirname (month_path);
+        year = g_path_get_basename (year_path);
+
+        retval = gibbon_archive_is_number (year, 4)
+                && gibbon_archive_is_number (month, 2)
+                && gibbon_archive_is_number (day, 2);
+
+        g_free (year);
+        g_free (year_path);
+        g_free (month);
+        g_free (month_path);
+        g_free (day);
+
+        return retval;
+}
+
+static gboolean
+gibbon_archive_compress_directory (const gchar *directory, guint *count,
+                                   GError **error)
+{
+        GDir *dir;
+        const gchar *name;
+        gchar *path;
+        gchar *compressed;
+        gboolean day_directory;
+        gboolean retval = TRUE;
+
+        dir = g_dir_open (directory, 0, NULL);
+        if (!dir)
+                return TRUE;
+
+        /* Match files outside of day directories are still in use.  */
+        day_directory = gibbon_archive_is_day_directory (directory);
+
+        while (retval && (name = g_dir_read_name (dir))) {
+                path = g_build_filename (directory, name, NULL);
+                if (g_file_test (path, G_FILE_TEST_IS_SYMLINK)) {
+                        /* Skip.  */
+                } else if (g_file_test (path, G_FILE_TEST_IS_DIR)) {
+                        retval = gibbon_archive_compress_directory (path,
+                                                                    count,
+                                                                    error);
+                } else if (day_directory && g_str_has_suffix (name, ".gmd")) {
+                        compressed = g_strconcat (path, ".gz", NULL);
+                        retval = gibbon_archive_compress_file (path,
+                                                               compressed,
+                                                               error);
+                        g_free (compressed);
+                        if (retval)
+                                ++*count;
+                }
+                g_free (path);
+        }
+
+        g_dir_close (dir);
+
+        return retval;
+}
@@ -23,6 +23,7 @@
 #include <glib.h>
 #include <glib-object.h>
 
+#include "gibbon-archive-entry.h"
 #include "gibbon-country.h"
 #include "gibbon-match.h"
 
@@ -151,5 +152,19 @@ GHashTable *gibbon_archive_get_saved (const GibbonArchive *self,
                                       const gchar *hostname,
                                       guint port,
                                       const gchar *login);
+gboolean gibbon_archive_update_saved (const GibbonArchive *self,
+                                      const gchar *path,
+                                      const GibbonMatch *match,
+                                      GError **error);
+void gibbon_archive_forget_saved (const GibbonArchive *self,
+                                  const gchar *path);
+gboolean gibbon_archive_update_catalogue (const GibbonArchive *self,
+                                          GError **error);
+GSList *gibbon_archive_query (const GibbonArchive *self,
+                              const gchar *opponent,
+                              gint64 from, gint64 to,
+                              GibbonArchiveResult result,
+                              GError **error);
+gboolean gibbon_archive_compress (guint *count, GError **error);
 
 #endif
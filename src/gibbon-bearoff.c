@@ -0,0 +1,145 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <glib.h>
+
+#include "gibbon-bearoff.h"
+
+/*
+ * Look up the distribution for @counts.  Returns the number of rolls of
+ * the first non-zero probability and stores the number of probabilities
+ * in @num_probabilities.
+ */
+static const guint8 *
+gibbon_bearoff_lookup (const guint counts[GIBBON_BEAROFF_POINTS],
+                       guint *first, guint *num_probabilities)
+{
+        const guint8 *data;
+        guint checkers = 0;
+        gsize i;
+
+        for (i = 0; i < GIBBON_BEAROFF_POINTS; ++i)
+                checkers += counts[i];
+        if (checkers > GIBBON_BEAROFF_CHECKERS)
+                return NULL;
+
+        data = gibbon_bearoff_data
+                + gibbon_bearoff_offsets[gibbon_bearoff_index (counts)];
+        *first = data[0];
+        *num_probabilities = data[1];
+
+        return data + 2;
+}
+
+/*
+ * gibbon_bearoff_get_distribution:
+ * @counts: The checker counts on the ace point through the six point.
+ * @probabilities: Probabilities that exactly i rolls are needed.
+ *
+ * Returns: %FALSE if @counts has more than 15 checkers.
+ */
+gboolean
+gibbon_bearoff_get_distribution (const guint counts[GIBBON_BEAROFF_POINTS],
+                                 gdouble probabilities[
+                                         GIBBON_BEAROFF_MAX_ROLLS])
+{
+        const guint8 *data;
+        guint first, num;
+        gsize i;
+
+        data = gibbon_bearoff_lookup (counts, &first, &num);
+        if (!data)
+                return FALSE;
+
+        for (i = 0; i < GIBBON_BEAROFF_MAX_ROLLS; ++i)
+                probabilities[i] = 0.0;
+        for (i = 0; i < num; ++i)
+                probabilities[first + i] = (data[2 * i]
+                                            | (data[2 * i + 1] << 8))
+                                           / (gdouble) GIBBON_BEAROFF_ONE;
+
+        return TRUE;
+}
+
+/*
+ * gibbon_bearoff_expected_rolls:
+ * @counts: The checker counts on the ace point through the six point.
+ *
+ * Returns: The expected number of rolls needed to bear off all checkers,
+ *          or -1.0 if @counts has more than 15 checkers.
+ */
+gdouble
+gibbon_bearoff_expected_rolls (const guint counts[GIBBON_BEAROFF_POINTS])
+{
+        gdouble p[GIBBON_BEAROFF_MAX_ROLLS];
+        gdouble rolls = 0.0, total = 0.0;
+        gsize i;
+
+        if (!gibbon_bearoff_get_distribution (counts, p))
+                return -1.0;
+
+        /* Compensate for rounding errors.  */
+        for (i = 0; i < GIBBON_BEAROFF_MAX_ROLLS; ++i) {
+                rolls += i * p[i];
+                total += p[i];
+        }
+
+        return rolls / total;
+}
+
+/*
+ * gibbon_bearoff_win_probability:
+ * @on_roll: The checker counts of the side on roll.
+ * @opponent: The checker counts of the opponent.
+ *
+ * The side on roll wins, if it needs i rolls, and the opponent needs at
+ * least i rolls as well.  Cube decisions are ignored.
+ *
+ * Returns: The probability that the side on roll wins, or -1.0 if one of
+ *          the positions has more than 15 checkers.
+ */
+gdouble
+gibbon_bearoff_win_probability (const guint on_roll[GIBBON_BEAROFF_POINTS],
+                                const guint opponent[GIBBON_BEAROFF_POINTS])
+{
+        gdouble p[GIBBON_BEAROFF_MAX_ROLLS];
+        gdouble q[GIBBON_BEAROFF_MAX_ROLLS];
+        gdouble win = 0.0, lose = 0.0, remaining = 0.0;
+        gint i;
+
+        if (!gibbon_bearoff_get_distribution (on_roll, p)
+            || !gibbon_bearoff_get_distribution (opponent, q))
+                return -1.0;
+
+        for (i = GIBBON_BEAROFF_MAX_ROLLS - 1; i >= 0; --i) {
+                remaining += q[i];
+                win += p[i] * remaining;
+                lose += p[i] * (1.0 - remaining);
+        }
+
+        /* Compensate for rounding errors.  */
+        if (win + lose <= 0.0)
+                return 0.0;
+
+        return win / (win + lose);
+}
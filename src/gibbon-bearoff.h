@@ -0,0 +1,100 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GIBBON_BEAROFF_H
+# define _GIBBON_BEAROFF_H
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * One-sided bear-off database for up to 15 checkers on the six points of
+ * the home board.  For every position it holds the probability
+ * distribution of the number of rolls needed to bear off all checkers,
+ * assuming that each roll is played so that the expected number of rolls
+ * is minimal.
+ *
+ * Positions are given as the checker counts on the ace point through the
+ * six point.
+ */
+#define GIBBON_BEAROFF_POINTS 6
+#define GIBBON_BEAROFF_CHECKERS 15
+#define GIBBON_BEAROFF_POSITIONS 54264
+#define GIBBON_BEAROFF_MAX_ROLLS 32
+
+/*
+ * Probabilities are stored as 16 bit fixed point numbers.
+ */
+#define GIBBON_BEAROFF_ONE 65535
+
+/*
+ * The table is generated by gibbon-make-bearoff into gibbon-bearoff-data.c.
+ * For position n, the bytes starting at gibbon_bearoff_data[
+ * gibbon_bearoff_offsets[n]] are the number of rolls of the first
+ * non-zero probability, the number of probabilities, and then the
+ * probabilities themselves in little-endian byte order.
+ */
+extern const guint32 gibbon_bearoff_offsets[GIBBON_BEAROFF_POSITIONS];
+extern const guint8 gibbon_bearoff_data[];
+
+/*
+ * Enumerate the positions by the combinatorial number system.  The
+ * checkers and the points are laid out in a row, with one separator after
+ * each point, and the position of the k-th separator contributes the
+ * binomial coefficient (position over k).
+ */
+static inline guint
+gibbon_bearoff_index (const guint counts[GIBBON_BEAROFF_POINTS])
+{
+        guint index = 0;
+        guint separator = 0;
+        guint binomial;
+        guint i, k;
+
+        for (k = 1; k <= GIBBON_BEAROFF_POINTS; ++k) {
+                separator += counts[k - 1];
+                binomial = separator >= k ? 1 : 0;
+                for (i = 1; i <= k && binomial; ++i)
+                        binomial = binomial * (separator - k + i) / i;
+                index += binomial;
+                ++separator;
+        }
+
+        return index;
+}
+
+gboolean gibbon_bearoff_get_distribution (const guint
+                                          counts[GIBBON_BEAROFF_POINTS],
+                                          gdouble probabilities[
+                                                  GIBBON_BEAROFF_MAX_ROLLS]);
+gdouble gibbon_bearoff_expected_rolls (const guint
+                                       counts[GIBBON_BEAROFF_POINTS]);
+gdouble gibbon_bearoff_win_probability (const guint
+                                        on_roll[GIBBON_BEAROFF_POINTS],
+                                        const guint
+                                        opponent[GIBBON_BEAROFF_POINTS]);
+
+G_END_DECLS
+
+#endif
@@ -1297,6 +1297,8 @@ gibbon_cairoboard_set_info (GibbonCairoboard *self)
         GibbonPosition *pos = self->priv->pos;
         guint64 away[2];
         guint pip_count[2];
+        gdouble rolls[2];
+        gdouble win;
 
         text = pos->players[0] ? pos->players[0] : "";
         svg_util_steal_text_params (self->priv->board, "player1", text,
@@ -1374,13 +1376,47 @@ gibbon_cairoboard_set_info (GibbonCairoboard *self)
                                                     GIBBON_POSITION_SIDE_WHITE);
         pip_count[1] = gibbon_position_get_pip_count (pos,
                                                     GIBBON_POSITION_SIDE_BLACK);
-        text = g_strdup_printf (_("Pips: %u (%+d)"),
-                                  pip_count[0], pip_count[0] - pip_count[1]);
+
+        /* In the bear-off, the expected number of rolls and the winning
+         * chances are more telling than the pip count.
+         */
+        if (pos->turn && pip_count[0] && pip_count[1]) {
+                win = gibbon_position_get_bearoff_win (pos, pos->turn);
+                rolls[0] = gibbon_position_get_bearoff_rolls (pos,
+                                                   GIBBON_POSITION_SIDE_WHITE);
+                rolls[1] = gibbon_position_get_bearoff_rolls (pos,
+                                                   GIBBON_POSITION_SIDE_BLACK);
+        } else {
+                win = -1.0;
+        }
+
+        if (win >= 0.0) {
+                if (pos->turn == GIBBON_POSITION_SIDE_BLACK)
+                        win = 1.0 - win;
+                text = g_strdup_printf (_("Pips: %u (%+d),"
+                                          " %.1f rolls, %.1f %%"),
+                                        pip_count[0],
+                                        pip_count[0] - pip_count[1],
+                                        rolls[0], 100.0 * win);
+        } else {
+                text = g_strdup_printf (_("Pips: %u (%+d)"),
+                                        pip_count[0],
+                                        pip_count[0] - pip_count[1]);
+        }
         svg_util_steal_text_params (self->priv->board, "pip1", text,
                                     1.0, 0, NULL);
         g_free (text);
-        text = g_strdup_printf (_("Pips: %u (%+d)"),
-                                  pip_count[1], pip_count[1] - pip_count[0]);
+        if (win >= 0.0) {
+                text = g_strdup_printf (_("Pips: %u (%+d),"
+                                          " %.1f rolls, %.1f %%"),
+                                        pip_count[1],
+                                        pip_count[1] - pip_count[0],
+                                        rolls[1], 100.0 * (1.0 - win));
+        } else {
+                text = g_strdup_printf (_("Pips: %u (%+d)"),
+                                        pip_count[1],
+                                        pip_count[1] - pip_count[0]);
+        }
         svg_util_steal_text_params (self->priv->board, "pip2", text,
                                     1.0, 0, NULL);
         g_free (text);
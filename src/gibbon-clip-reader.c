@@ -396,8 +396,8 @@ gibbon_clip_reader_set_board (GibbonCLIPReader *self, gchar **tokens)
          * http://www.fibs.com/fibs_interface.html#board_state
          */
 
-        pos->players[0] = g_strdup (tokens[0]);
-        pos->players[1] = g_strdup (tokens[1]);
+        gibbon_position_set_player (pos, tokens[0], GIBBON_POSITION_SIDE_WHITE);
+        gibbon_position_set_player (pos, tokens[1], GIBBON_POSITION_SIDE_BLACK);
 
         if (numbers[0] < 1)
                 goto bail_out_board;
@@ -535,9 +535,11 @@ gibbon_clip_reader_set_board (GibbonCLIPReader *self, gchar **tokens)
             && (pos->scores[0] == pos->match_length - 1
                 || pos->scores[1] == pos->match_length - 1)) {
                 if (post_crawford) {
-                        pos->game_info = g_strdup (_("Post-Crawford game"));
+                        gibbon_position_set_game_info (pos,
+                                        _("Post-Crawford game"));
                 } else {
-                        pos->game_info = g_strdup (_("Crawford game"));
+                        gibbon_position_set_game_info (pos,
+                                        _("Crawford game"));
                         pos->may_double[0] = pos->may_double[1] = FALSE;
                 }
         }
@@ -23,11 +23,24 @@
 
 #include <locale.h>
 #include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
 
 #include <glib/gi18n.h>
+#include <glib/gstdio.h>
 #include <gio/gio.h>
 #include <gdk/gdk.h>
 
+#ifdef G_OS_WIN32
+# include <windows.h>
+# include <gio/gwin32outputstream.h>
+#else
+# include <unistd.h>
+# include <gio/gunixoutputstream.h>
+#endif
+
+#include <libgsgf/gsgf.h>
+
 #include "gibbon-gmd-reader.h"
 #include "gibbon-gmd-writer.h"
 #include "gibbon-sgf-reader.h"
@@ -36,6 +49,7 @@
 #include "gibbon-java-fibs-writer.h"
 #include "gibbon-jelly-fish-reader.h"
 #include "gibbon-jelly-fish-writer.h"
+#include "gibbon-position.h"
 
 typedef enum {
         GIBBON_CONVERT_FORMAT_UNKNOWN = 0,
@@ -44,12 +58,42 @@ typedef enum {
         GIBBON_CONVERT_FORMAT_JAVA_FIBS = 3,
         GIBBON_CONVERT_FORMAT_JELLY_FISH = 4
 } GibbonConvertFormat;
+#define GIBBON_CONVERT_NUM_FORMATS 5
+
+/* One input file in batch mode.  */
+typedef struct _GibbonConvertJob GibbonConvertJob;
+struct _GibbonConvertJob {
+        gchar *input;
+        gchar *output;
+        GibbonConvertFormat format;
+};
+
+/* Readers and writer owned by one thread of the pool.  */
+typedef struct _GibbonConvertWorker GibbonConvertWorker;
+struct _GibbonConvertWorker {
+        GibbonMatchReader *readers[GIBBON_CONVERT_NUM_FORMATS];
+        GibbonMatchWriter *writer;
+};
 
 static gchar *program_name;
 static gchar *input_filename = NULL;
 static gchar *output_filename = NULL;
 static gchar *from_format = NULL;
 static gchar *to_format = NULL;
+static gboolean batch = FALSE;
+static gchar *output_directory = NULL;
+static gint num_jobs = 0;
+static gchar **batch_inputs = NULL;
+
+/* Default filename extensions, indexed by GibbonConvertFormat.  */
+static const gchar *extensions[GIBBON_CONVERT_NUM_FORMATS] = {
+        NULL, ".sgf", ".gmd", ".match", ".mat"
+};
+
+G_LOCK_DEFINE_STATIC (statistics);
+static guint files_converted = 0;
+static guint files_failed = 0;
+static guint64 bytes_converted = 0;
 
 GibbonConvertFormat input_format = GIBBON_CONVERT_FORMAT_UNKNOWN;
 GibbonConvertFormat output_format = GIBBON_CONVERT_FORMAT_UNKNOWN;
@@ -76,6 +120,20 @@ static const GOptionEntry options[] =
                   N_("output format (omit for automatic detection)"),
                   N_("FORMAT")
                 },
+                { "batch", 'b', 0, G_OPTION_ARG_NONE, &batch,
+                  N_("convert all files and directories given as arguments"),
+                  NULL
+                },
+                { "output-directory", 'O', 0, G_OPTION_ARG_FILENAME,
+                  &output_directory,
+                  N_("output directory in batch mode"),
+                  N_("DIRECTORY")
+                },
+                { "jobs", 'j', 0, G_OPTION_ARG_INT, &num_jobs,
+                  N_("number of parallel conversions in batch mode"
+                     " (default: number of processors)"),
+                  N_("JOBS")
+                },
                 { "debug", 'D', 0, G_OPTION_ARG_STRING, &debug,
                   N_("enable various debugging flags"),
                   NULL
@@ -98,6 +156,31 @@ static void usage_error ();
 static gboolean parse_command_line (int argc, char *argv[]);
 static GibbonConvertFormat guess_format_from_id (const gchar *id);
 static GibbonConvertFormat guess_format_from_filename (const gchar *name);
+static GibbonConvertFormat format_from_filename (const gchar *name);
+static GOutputStream *open_stdout (void);
+static GibbonMatchReader *new_reader (GibbonConvertFormat format);
+static GibbonMatchWriter *new_writer (GibbonConvertFormat format);
+static int convert_batch (void);
+static void collect_jobs (GPtrArray *queue, const gchar *input);
+static void collect_directory (GPtrArray *queue, const gchar *directory,
+                               const gchar *relative);
+static void collect_pattern (GPtrArray *queue, const gchar *pattern);
+static void add_job (GPtrArray *queue, const gchar *input,
+                     const gchar *relative, GibbonConvertFormat format);
+static void free_job (GibbonConvertJob *job);
+static void convert_job (gpointer data, gpointer user_data);
+static gboolean write_match (GibbonMatchWriter *writer,
+                             const GibbonMatch *match,
+                             const gchar *filename);
+static GibbonConvertWorker *get_worker (void);
+static void free_worker (gpointer data);
+static guint number_of_processors (void);
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+static GPrivate worker_key = G_PRIVATE_INIT (free_worker);
+#else
+static GStaticPrivate worker_key = G_STATIC_PRIVATE_INIT;
+#endif
 
 int
 main (int argc, char *argv[])
@@ -132,6 +215,9 @@ main (int argc, char *argv[])
         if (debug)
                 g_setenv ("GIBBON_DEBUG", debug, TRUE);
 
+        if (batch)
+                return convert_batch ();
+
         if (from_format) {
                 input_format = guess_format_from_id (from_format);
                 if (!input_format)
@@ -174,28 +260,9 @@ main (int argc, char *argv[])
                 gdk_threads_init ();
         }
 
-        switch (input_format) {
-        case GIBBON_CONVERT_FORMAT_UNKNOWN:
+        reader = new_reader (input_format);
+        if (!reader)
                 return 1;
-        case GIBBON_CONVERT_FORMAT_SGF:
-                reader = GIBBON_MATCH_READER (gibbon_sgf_reader_new (NULL,
-                                                                     NULL));
-                break;
-        case GIBBON_CONVERT_FORMAT_GMD:
-                reader = GIBBON_MATCH_READER (gibbon_gmd_reader_new (NULL,
-                                                                     NULL));
-                break;
-        case GIBBON_CONVERT_FORMAT_JAVA_FIBS:
-                reader =
-                   GIBBON_MATCH_READER (gibbon_java_fibs_reader_new (NULL,
-                                                                     NULL));
-                break;
-        case GIBBON_CONVERT_FORMAT_JELLY_FISH:
-                reader =
-                   GIBBON_MATCH_READER (gibbon_jelly_fish_reader_new (NULL,
-                                                                      NULL));
-                break;
-        }
 
         match = gibbon_match_reader_parse (reader, input_filename);
         if (!match)
@@ -208,23 +275,9 @@ main (int argc, char *argv[])
                 return 1;
         }
 
-        switch (output_format) {
-        case GIBBON_CONVERT_FORMAT_UNKNOWN:
-                g_object_unref (match);
+        writer = new_writer (output_format);
+        if (!writer)
                 return 1;
-        case GIBBON_CONVERT_FORMAT_SGF:
-                writer = GIBBON_MATCH_WRITER (gibbon_sgf_writer_new ());
-                break;
-        case GIBBON_CONVERT_FORMAT_GMD:
-                writer = GIBBON_MATCH_WRITER (gibbon_gmd_writer_new ());
-                break;
-        case GIBBON_CONVERT_FORMAT_JAVA_FIBS:
-                writer = GIBBON_MATCH_WRITER (gibbon_java_fibs_writer_new ());
-                break;
-        case GIBBON_CONVERT_FORMAT_JELLY_FISH:
-                writer = GIBBON_MATCH_WRITER (gibbon_jelly_fish_writer_new ());
-                break;
-        }
 
         if (output_filename) {
                 file = g_file_new_for_commandline_arg (output_filename);
@@ -242,10 +295,7 @@ main (int argc, char *argv[])
                 }
                 out = G_OUTPUT_STREAM (fout);
         } else {
-                /* FIXME! How do we get a GOutputStream for stdout? */
-                out = G_OUTPUT_STREAM (g_memory_output_stream_new (NULL, 0,
-                                                                   g_realloc,
-                                                                   g_free));
+                out = open_stdout ();
         }
 
         if (!gibbon_match_writer_write_stream (writer, out, match, &error)) {
@@ -262,11 +312,7 @@ main (int argc, char *argv[])
                 return 1;
         }
 
-        if (!output_filename) {
-                g_print ("%s",
-                        (gchar *) g_memory_output_stream_get_data  (
-                                            G_MEMORY_OUTPUT_STREAM (out)));
-        } else if (!g_output_stream_close (out, NULL, &error)) {
+        if (!g_output_stream_close (out, NULL, &error)) {
                 if (error) {
                         /*
                          * TRANSLATORS: The first argument is the program
@@ -275,7 +321,9 @@ main (int argc, char *argv[])
                          * error message.
                          */
                         g_printerr (_("%s: Error closing `%s': %s!\n"),
-                                    program_name, output_filename,
+                                    program_name,
+                                    output_filename ? output_filename
+                                    : _("standard output"),
                                     error->message);
                         g_error_free (error);
                 }
@@ -318,6 +366,7 @@ parse_command_line (int argc, char *argv[])
         GError *error = NULL;
         gchar *description;
         gchar *alt_usage;
+        gint i;
 
         context = g_option_context_new (_("- Gibbon match converter"));
         g_option_context_set_summary (context, _("Convert popular backgammon"
@@ -325,8 +374,10 @@ parse_command_line (int argc, char *argv[])
         alt_usage = g_strdup_printf (
                         _("Alternative usages:\n"
                           " %s [OPTION ...] INPUTFILE\n"
-                          " %s [OPTION ...] INPUTFILE OUTPUTFILE\n"),
-                          program_name, program_name);
+                          " %s [OPTION ...] INPUTFILE OUTPUTFILE\n"
+                          " %s [OPTION ...] --batch --output-directory"
+                          "=DIRECTORY INPUT ...\n"),
+                          program_name, program_name, program_name);
         description = g_strdup_printf ("%s\n%s\n%s\n%s\n",
                         alt_usage,
                         _("Recognized values for FORMAT are 'SGF' for"
@@ -339,7 +390,11 @@ parse_command_line (int argc, char *argv[])
                         _("For automatic detection, '.sgf' is expected for"
                           " SGF, '.mat' for Jellyfish, '.gmd' for the"
                           " Gibbon match format, and\n"
-                          "'.match' for the internal format of JavaFIBS.\n"),
+                          "'.match' for the internal format of JavaFIBS."
+                          "  Input files ending in '.gz' are\n"
+                          "decompressed.  In batch mode, every INPUT can be"
+                          " a file, a directory that is searched\n"
+                          "recursively, or a wildcard pattern.\n"),
                         _("Report bugs at"
                           " <https://savannah.nongnu.org/projects/gibbon>!"));
         g_free (alt_usage);
@@ -358,6 +413,34 @@ parse_command_line (int argc, char *argv[])
                 return FALSE;
         }
 
+        if (batch) {
+                if (input_filename || output_filename) {
+                        usage_error (_("The options `--input-file' and"
+                                       " `--output-file' cannot be used in"
+                                       " batch mode."));
+                        return FALSE;
+                }
+                if (!output_directory) {
+                        usage_error (_("The option `--output-directory' is"
+                                       " mandatory in batch mode."));
+                        return FALSE;
+                }
+                if (!to_format) {
+                        usage_error (_("The option `--to-format' is"
+                                       " mandatory in batch mode."));
+                        return FALSE;
+                }
+                if (argc < 2) {
+                        usage_error (_("No input files given!"));
+                        return FALSE;
+                }
+                batch_inputs = g_new0 (gchar *, argc);
+                for (i = 1; i < argc; ++i)
+                        batch_inputs[i - 1] = g_strdup (argv[i]);
+
+                return TRUE;
+        }
+
         if (argc == 2) {
                 if (input_filename) {
                         usage_error (_("Either use the option `--input-file'"
@@ -386,6 +469,11 @@ parse_command_line (int argc, char *argv[])
                 return FALSE;
         }
 
+        if (input_filename && 0 == strcmp ("-", input_filename))
+                input_filename = NULL;
+        if (output_filename && 0 == strcmp ("-", output_filename))
+                output_filename = NULL;
+
         return TRUE;
 }
 
@@ -459,29 +547,503 @@ guess_format_from_id (const gchar *id)
 static GibbonConvertFormat
 guess_format_from_filename (const gchar *filename)
 {
-        const gchar *last_dot;
+        GibbonConvertFormat format;
         gchar *msg;
 
-        last_dot = rindex (filename, '.');
-
-        if (!last_dot) {
-                msg = g_strdup_printf (_("Cannot guess format of `%s'!"),
-                                       filename);
-                usage_error (msg);
-                g_free (msg);
-                return GIBBON_CONVERT_FORMAT_UNKNOWN;
-        } else if (0 == g_ascii_strcasecmp (".sgf", last_dot)) {
-                return GIBBON_CONVERT_FORMAT_SGF;
-        } else if (0 == g_ascii_strcasecmp (".gmd", last_dot)) {
-                return GIBBON_CONVERT_FORMAT_GMD;
-        } else if (0 == g_ascii_strcasecmp (".match", last_dot)) {
-                return GIBBON_CONVERT_FORMAT_JAVA_FIBS;
-        } else if (0 == g_ascii_strcasecmp (".mat", last_dot)) {
-                return GIBBON_CONVERT_FORMAT_JELLY_FISH;
-        }
+        format = format_from_filename (filename);
+        if (format)
+                return format;
 
         msg = g_strdup_printf (_("Cannot guess format of `%s'!"), filename);
         usage_error (msg);
         g_free (msg);
         return GIBBON_CONVERT_FORMAT_UNKNOWN;
 }
+
+static GibbonConvertFormat
+format_from_filename (const gchar *filename)
+{
+        gchar *name;
+        const gchar *last_dot;
+        GibbonConvertFormat format = GIBBON_CONVERT_FORMAT_UNKNOWN;
+
+        /* Compressed input is decompressed by the readers.  */
+        if (g_str_has_suffix (filename, ".gz"))
+                name = g_strndup (filename, strlen (filename) - 3);
+        else
+                name = g_strdup (filename);
+
+        last_dot = rindex (name, '.');
+
+        if (!last_dot)
+                format = GIBBON_CONVERT_FORMAT_UNKNOWN;
+        else if (0 == g_ascii_strcasecmp (".sgf", last_dot))
+                format = GIBBON_CONVERT_FORMAT_SGF;
+        else if (0 == g_ascii_strcasecmp (".gmd", last_dot))
+                format = GIBBON_CONVERT_FORMAT_GMD;
+        else if (0 == g_ascii_strcasecmp (".match", last_dot))
+                format = GIBBON_CONVERT_FORMAT_JAVA_FIBS;
+        else if (0 == g_ascii_strcasecmp (".mat", last_dot))
+                format = GIBBON_CONVERT_FORMAT_JELLY_FISH;
+
+        g_free (name);
+
+        return format;
+}
+
+static GOutputStream *
+open_stdout (void)
+{
+        GOutputStream *raw;
+        GOutputStream *out;
+
+#ifdef G_OS_WIN32
+        raw = g_win32_output_stream_new (GetStdHandle (STD_OUTPUT_HANDLE),
+                                         FALSE);
+#else
+        raw = g_unix_output_stream_new (1, FALSE);
+#endif
+
+        /* The writers emit many small chunks.  */
+        out = g_buffered_output_stream_new (raw);
+        g_object_unref (raw);
+
+        return out;
+}
+
+static GibbonMatchReader *
+new_reader (GibbonConvertFormat format)
+{
+        switch (format) {
+        case GIBBON_CONVERT_FORMAT_UNKNOWN:
+                break;
+        case GIBBON_CONVERT_FORMAT_SGF:
+                return GIBBON_MATCH_READER (gibbon_sgf_reader_new (NULL,
+                                                                   NULL));
+        case GIBBON_CONVERT_FORMAT_GMD:
+                return GIBBON_MATCH_READER (gibbon_gmd_reader_new (NULL,
+                                                                   NULL));
+        case GIBBON_CONVERT_FORMAT_JAVA_FIBS:
+                return GIBBON_MATCH_READER (gibbon_java_fibs_reader_new (NULL,
+                                                                         NULL));
+        case GIBBON_CONVERT_FORMAT_JELLY_FISH:
+                return GIBBON_MATCH_READER (gibbon_jelly_fish_reader_new (
+                                                NULL, NULL));
+        }
+
+        return NULL;
+}
+
+static GibbonMatchWriter *
+new_writer (GibbonConvertFormat format)
+{
+        switch (format) {
+        case GIBBON_CONVERT_FORMAT_UNKNOWN:
+                break;
+        case GIBBON_CONVERT_FORMAT_SGF:
+                return GIBBON_MATCH_WRITER (gibbon_sgf_writer_new ());
+        case GIBBON_CONVERT_FORMAT_GMD:
+                return GIBBON_MATCH_WRITER (gibbon_gmd_writer_new ());
+        case GIBBON_CONVERT_FORMAT_JAVA_FIBS:
+                return GIBBON_MATCH_WRITER (gibbon_java_fibs_writer_new ());
+        case GIBBON_CONVERT_FORMAT_JELLY_FISH:
+                return GIBBON_MATCH_WRITER (gibbon_jelly_fish_writer_new ());
+        }
+
+        return NULL;
+}
+
+static int
+convert_batch (void)
+{
+        GPtrArray *queue;
+        GThreadPool *pool;
+        GError *error = NULL;
+        GTimer *timer;
+        gdouble seconds;
+        guint64 hits, misses;
+        guint i;
+
+        if (from_format) {
+                input_format = guess_format_from_id (from_format);
+                if (!input_format)
+                        return 1;
+        }
+
+        output_format = guess_format_from_id (to_format);
+        if (!output_format)
+                return 1;
+
+        queue = g_ptr_array_new_with_free_func ((GDestroyNotify) free_job);
+        for (i = 0; batch_inputs[i]; ++i)
+                collect_jobs (queue, batch_inputs[i]);
+
+        if (!queue->len) {
+                g_printerr (_("%s: No input files found!\n"), program_name);
+                g_ptr_array_free (queue, TRUE);
+                return 1;
+        }
+
+        if (!g_thread_supported ()) {
+#if (GLIB_MAJOR_VERSION < 2 \
+     || (GLIB_MAJOR_VERSION == 2 && GLIB_MINOR_VERSION < 32))
+                g_thread_init (NULL);
+#endif
+                gdk_threads_init ();
+        }
+        gsgf_threads_init ();
+
+        if (num_jobs <= 0)
+                num_jobs = number_of_processors ();
+
+        timer = g_timer_new ();
+
+        /*
+         * Exclusive threads terminate when the pool is freed so that
+         * their readers and writers get destroyed.
+         */
+        pool = g_thread_pool_new (convert_job, NULL, num_jobs, TRUE, &error);
+        if (!pool) {
+                g_printerr (_("%s: %s.\n"), program_name, error->message);
+                g_error_free (error);
+                g_ptr_array_free (queue, TRUE);
+                g_timer_destroy (timer);
+                return 1;
+        }
+
+        for (i = 0; i < queue->len; ++i)
+                g_thread_pool_push (pool, g_ptr_array_index (queue, i), NULL);
+
+        g_thread_pool_free (pool, FALSE, TRUE);
+
+        seconds = g_timer_elapsed (timer, NULL);
+        g_timer_destroy (timer);
+        if (seconds <= 0)
+                seconds = 0.000001;
+
+        g_print (_("%u files converted, %u failed in %.2f s"
+                   " (%.1f files/s, %.2f MB/s).\n"),
+                 files_converted, files_failed, seconds,
+                 files_converted / seconds,
+                 bytes_converted / seconds / (1024 * 1024));
+
+        gibbon_position_get_legality_cache_stats (&hits, &misses, NULL);
+        if (hits + misses)
+                g_print (_("Move legality cache: %.1f %% hits.\n"),
+                         100.0 * hits / (hits + misses));
+
+        g_ptr_array_free (queue, TRUE);
+
+        return files_failed ? 1 : 0;
+}
+
+static void
+collect_jobs (GPtrArray *queue, const gchar *input)
+{
+        GibbonConvertFormat format;
+        gchar *basename;
+
+        if (g_file_test (input, G_FILE_TEST_IS_DIR)) {
+                collect_directory (queue, input, NULL);
+                return;
+        }
+
+        if (strpbrk (input, "*?")) {
+                collect_pattern (queue, input);
+                return;
+        }
+
+        if (!g_file_test (input, G_FILE_TEST_IS_REGULAR)) {
+                g_printerr (_("%s: %s: %s!\n"), program_name, input,
+                            g_strerror (ENOENT));
+                ++files_failed;
+                return;
+        }
+
+        if (input_format)
+                format = input_format;
+        else
+                format = guess_format_from_filename (input);
+        if (!format) {
+                ++files_failed;
+                return;
+        }
+
+        basename = g_path_get_basename (input);
+        add_job (queue, input, basename, format);
+        g_free (basename);
+}
+
+static void
+collect_directory (GPtrArray *queue, const gchar *directory,
+                   const gchar *relative)
+{
+        GDir *dir;
+        GError *error = NULL;
+        const gchar *name;
+        gchar *path;
+        gchar *child;
+        GibbonConvertFormat format;
+
+        dir = g_dir_open (directory, 0, &error);
+        if (!dir) {
+                g_printerr (_("%s: %s.\n"), program_name, error->message);
+                g_error_free (error);
+                ++files_failed;
+                return;
+        }
+
+        while ((name = g_dir_read_name (dir))) {
+                path = g_build_filename (directory, name, NULL);
+                if (relative)
+                        child = g_build_filename (relative, name, NULL);
+                else
+                        child = g_strdup (name);
+
+                if (g_file_test (path, G_FILE_TEST_IS_DIR)) {
+                        collect_directory (queue, path, child);
+                } else if (g_file_test (path, G_FILE_TEST_IS_REGULAR)) {
+                        /*
+                         * Only files with a known extension are converted.
+                         * Files that are already in the output format are
+                         * skipped.  They may be the result of an earlier
+                         * run.
+                         */
+                        format = format_from_filename (name);
+                        if (format && format != output_format
+                            && (!input_format || format == input_format))
+                                add_job (queue, path, child, format);
+                }
+
+                g_free (child);
+                g_free (path);
+        }
+
+        g_dir_close (dir);
+}
+
+static void
+collect_pattern (GPtrArray *queue, const gchar *pattern)
+{
+        gchar *directory;
+        gchar *basename;
+        GPatternSpec *spec;
+        GDir *dir;
+        GError *error = NULL;
+        const gchar *name;
+        gchar *path;
+        GibbonConvertFormat format;
+
+        directory = g_path_get_dirname (pattern);
+        dir = g_dir_open (directory, 0, &error);
+        if (!dir) {
+                g_printerr (_("%s: %s.\n"), program_name, error->message);
+                g_error_free (error);
+                g_free (directory);
+                ++files_failed;
+                return;
+        }
+
+        basename = g_path_get_basename (pattern);
+        spec = g_pattern_spec_new (basename);
+        g_free (basename);
+
+        while ((name = g_dir_read_name (dir))) {
+                if (!g_pattern_match_string (spec, name))
+                        continue;
+
+                path = g_build_filename (directory, name, NULL);
+                if (g_file_test (path, G_FILE_TEST_IS_REGULAR)) {
+                        if (input_format)
+                                format = input_format;
+                        else
+                                format = format_from_filename (name);
+                        if (format)
+                                add_job (queue, path, name, format);
+                }
+                g_free (path);
+        }
+
+        g_pattern_spec_free (spec);
+        g_dir_close (dir);
+        g_free (directory);
+}
+
+static void
+add_job (GPtrArray *queue, const gchar *input, const gchar *relative,
+         GibbonConvertFormat format)
+{
+        GibbonConvertJob *job;
+        gchar *stem;
+        gchar *last_dot;
+        gchar *name;
+
+        if (g_str_has_suffix (relative, ".gz"))
+                stem = g_strndup (relative, strlen (relative) - 3);
+        else
+                stem = g_strdup (relative);
+
+        last_dot = rindex (stem, '.');
+        if (last_dot && !strchr (last_dot, G_DIR_SEPARATOR))
+                *last_dot = 0;
+
+        name = g_strconcat (stem, extensions[output_format], NULL);
+        g_free (stem);
+
+        job = g_new0 (GibbonConvertJob, 1);
+        job->input = g_strdup (input);
+        job->output = g_build_filename (output_directory, name, NULL);
+        job->format = format;
+        g_free (name);
+
+        g_ptr_array_add (queue, job);
+}
+
+static void
+free_job (GibbonConvertJob *job)
+{
+        g_free (job->input);
+        g_free (job->output);
+        g_free (job);
+}
+
+static void
+convert_job (gpointer data, gpointer user_data)
+{
+        GibbonConvertJob *job = (GibbonConvertJob *) data;
+        GibbonConvertWorker *worker;
+        GibbonMatchReader *reader;
+        GibbonMatch *match;
+        gboolean success;
+        GStatBuf st;
+
+        worker = get_worker ();
+
+        reader = worker->readers[job->format];
+        if (!reader) {
+                reader = new_reader (job->format);
+                worker->readers[job->format] = reader;
+        }
+
+        /* The reader reports errors itself.  */
+        match = gibbon_match_reader_parse (reader, job->input);
+        if (!match) {
+                success = FALSE;
+        } else if (!gibbon_match_get_current_game (match)) {
+                g_printerr (_("%s: Empty or incomplete match file!\n"),
+                            job->input);
+                success = FALSE;
+        } else {
+                success = write_match (worker->writer, match, job->output);
+        }
+
+        if (match)
+                g_object_unref (match);
+
+        G_LOCK (statistics);
+        if (success) {
+                ++files_converted;
+                if (0 == g_stat (job->input, &st))
+                        bytes_converted += st.st_size;
+        } else {
+                ++files_failed;
+        }
+        G_UNLOCK (statistics);
+}
+
+static gboolean
+write_match (GibbonMatchWriter *writer, const GibbonMatch *match,
+             const gchar *filename)
+{
+        gchar *directory;
+        GFile *file;
+        GFileOutputStream *fout;
+        GOutputStream *out;
+        GError *error = NULL;
+
+        directory = g_path_get_dirname (filename);
+        if (0 != g_mkdir_with_parents (directory, 0755)) {
+                g_printerr (_("%s: Failed to create directory `%s': %s!\n"),
+                            program_name, directory, g_strerror (errno));
+                g_free (directory);
+                return FALSE;
+        }
+        g_free (directory);
+
+        file = g_file_new_for_path (filename);
+        fout = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_NONE,
+                               NULL, &error);
+        g_object_unref (file);
+        if (!fout) {
+                g_printerr (_("%s: Error writing to `%s': %s!\n"),
+                            program_name, filename, error->message);
+                g_error_free (error);
+                return FALSE;
+        }
+
+        out = G_OUTPUT_STREAM (fout);
+        if (!gibbon_match_writer_write_stream (writer, out, match, &error)
+            || !g_output_stream_close (out, NULL, &error)) {
+                g_printerr (_("%s: Error writing to `%s': %s!\n"),
+                            program_name, filename, error->message);
+                g_error_free (error);
+                g_object_unref (out);
+                (void) g_remove (filename);
+                return FALSE;
+        }
+
+        g_object_unref (out);
+
+        return TRUE;
+}
+
+static GibbonConvertWorker *
+get_worker (void)
+{
+        GibbonConvertWorker *worker;
+
+#if GLIB_CHECK_VERSION (2, 32, 0)
+        worker = g_private_get (&worker_key);
+#else
+        worker = g_static_private_get (&worker_key);
+#endif
+        if (!worker) {
+                worker = g_new0 (GibbonConvertWorker, 1);
+                worker->writer = new_writer (output_format);
+#if GLIB_CHECK_VERSION (2, 32, 0)
+                g_private_set (&worker_key, worker);
+#else
+                g_static_private_set (&worker_key, worker, free_worker);
+#endif
+        }
+
+        return worker;
+}
+
+static void
+free_worker (gpointer data)
+{
+        GibbonConvertWorker *worker = (GibbonConvertWorker *) data;
+        gsize i;
+
+        for (i = 0; i < GIBBON_CONVERT_NUM_FORMATS; ++i)
+                if (worker->readers[i])
+                        g_object_unref (worker->readers[i]);
+        if (worker->writer)
+                g_object_unref (worker->writer);
+        g_free (worker);
+}
+
+static guint
+number_of_processors (void)
+{
+#if GLIB_CHECK_VERSION (2, 36, 0)
+        return g_get_num_processors ();
+#elif defined (_SC_NPROCESSORS_ONLN)
+        long count = sysconf (_SC_NPROCESSORS_ONLN);
+
+        return count > 0 ? (guint) count : 1;
+#else
+        return 1;
+#endif
+}
@@ -30,6 +30,7 @@
 #include <glib.h>
 #include <glib/gi18n.h>
 #include <stdarg.h>
+#include <string.h>
 #include <sqlite3.h>
 
 #include "gibbon-app.h"
@@ -45,7 +46,7 @@
 /* Differences in the minor schema version require conditional creation of
  * new tables or indexes.
  */
-#define GIBBON_DATABASE_SCHEMA_MINOR 6
+#define GIBBON_DATABASE_SCHEMA_MINOR 7
 
 /* Differences in the schema revision are for cosmetic changes that will
  * not have any impact on existing databases (case, column order, ...).
@@ -173,10 +174,58 @@ struct _GibbonDatabasePrivate {
 
 #define GIBBON_DATABASE_CREATE_MATCH                                    \
         "INSERT INTO matches (user_id1, user_id2, match_length, "       \
-        "                     score1, score2, date_time)"               \
-        " VALUES (?, ?, ?, ?, ?, ?)"
+        "                     score1, score2, date_time,"               \
+        "                     error_EMG1, error_EMG2,"                  \
+        "                     error_MWC1, error_MWC2,"                  \
+        "                     error_FIBS1, error_FIBS2,"                \
+        "                     checker_error_EMG1, checker_error_EMG2,"  \
+        "                     checker_error_MWC1, checker_error_MWC2,"  \
+        "                     cube_error_EMG1, cube_error_EMG2,"        \
+        "                     cube_error_MWC1, cube_error_MWC2,"        \
+        "                     luck_EMG1, luck_EMG2,"                    \
+        "                     luck_MWC1, luck_MWC2)"                    \
+        " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?,"     \
+        "         ?, ?, ?, ?, ?, ?, ?, ?)"
         sqlite3_stmt *create_match;
 
+#define GIBBON_DATABASE_UPDATE_MATCH_STATISTICS                         \
+        "UPDATE matches SET"                                            \
+        "   error_EMG1 = ?, error_EMG2 = ?,"                            \
+        "   error_MWC1 = ?, error_MWC2 = ?,"                            \
+        "   error_FIBS1 = ?, error_FIBS2 = ?,"                          \
+        "   checker_error_EMG1 = ?, checker_error_EMG2 = ?,"            \
+        "   checker_error_MWC1 = ?, checker_error_MWC2 = ?,"            \
+        "   cube_error_EMG1 = ?, cube_error_EMG2 = ?,"                  \
+        "   cube_error_MWC1 = ?, cube_error_MWC2 = ?,"                  \
+        "   luck_EMG1 = ?, luck_EMG2 = ?,"                              \
+        "   luck_MWC1 = ?, luck_MWC2 = ?"                               \
+        " WHERE id = ?"
+        sqlite3_stmt *update_match_statistics;
+
+#define GIBBON_DATABASE_SELECT_ARCHIVE_DIRECTORY                        \
+        "SELECT mtime FROM archive_directories WHERE path = ?"
+        sqlite3_stmt *select_archive_directory;
+
+#define GIBBON_DATABASE_UPDATE_ARCHIVE_DIRECTORY                        \
+        "INSERT OR REPLACE INTO archive_directories (path, mtime)"      \
+        " VALUES (?, ?)"
+        sqlite3_stmt *update_archive_directory;
+
+#define GIBBON_DATABASE_SELECT_ARCHIVED_PATHS                           \
+        "SELECT path FROM archived_matches WHERE directory = ?"
+        sqlite3_stmt *select_archived_paths;
+
+#define GIBBON_DATABASE_CATALOGUE_MATCH                                 \
+        "INSERT OR REPLACE INTO archived_matches"                       \
+        " (path, session, directory, white, opponent, match_length,"    \
+        "  score1, score2, result, date_time, error_rate1, error_rate2)" \
+        " VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)"
+        sqlite3_stmt *catalogue_match;
+
+#define GIBBON_DATABASE_UNCATALOGUE_MATCH                               \
+        "DELETE FROM archived_matches WHERE path = ?"
+        sqlite3_stmt *uncatalogue_match;
+
         gboolean in_transaction;
 
         gchar *path;
@@ -252,6 +301,12 @@ gibbon_database_init (GibbonDatabase *self)
         self->priv->create_relation = NULL;
         self->priv->select_match_id = NULL;
         self->priv->create_match = NULL;
+        self->priv->update_match_statistics = NULL;
+        self->priv->select_archive_directory = NULL;
+        self->priv->update_archive_directory = NULL;
+        self->priv->select_archived_paths = NULL;
+        self->priv->catalogue_match = NULL;
+        self->priv->uncatalogue_match = NULL;
 
         self->priv->in_transaction = FALSE;
 
@@ -314,6 +369,19 @@ gibbon_database_finalize (GObject *object)
                         sqlite3_finalize (self->priv->select_match_id);
                 if (self->priv->create_match)
                         sqlite3_finalize (self->priv->create_match);
+                if (self->priv->update_match_statistics)
+                        sqlite3_finalize (
+                                self->priv->update_match_statistics);
+                if (self->priv->select_archive_directory)
+                        sqlite3_finalize (self->priv->select_archive_directory);
+                if (self->priv->update_archive_directory)
+                        sqlite3_finalize (self->priv->update_archive_directory);
+                if (self->priv->select_archived_paths)
+                        sqlite3_finalize (self->priv->select_archived_paths);
+                if (self->priv->catalogue_match)
+                        sqlite3_finalize (self->priv->catalogue_match);
+                if (self->priv->uncatalogue_match)
+                        sqlite3_finalize (self->priv->uncatalogue_match);
                 sqlite3_close (self->priv->dbh);
         }
 
@@ -501,6 +569,17 @@ gibbon_database_initialize (GibbonDatabase *self, GError **error)
                         msg = NULL;
                 }
 
+                /* Without a user interface, nobody can be asked.  */
+                if (msg && !app) {
+                        g_set_error_literal (error, GIBBON_ERROR, -1,
+                                             _("The database was created"
+                                               " by a different version of"
+                                               " Gibbon.  Start the"
+                                               " graphical user interface"
+                                               " in order to convert it!"));
+                        return FALSE;
+                }
+
                 if (msg) {
                         /*
                          * FIXME! This can only be done from the main
@@ -716,6 +795,68 @@ gibbon_database_initialize (GibbonDatabase *self, GError **error)
                                      ")"))
                 return FALSE;
 
+        /*
+         * The catalogue of archived matches can always be rebuilt from
+         * the match files.
+         */
+        if (drop_first
+            && !gibbon_database_sql_do (self, error,
+                                        "DROP TABLE IF EXISTS"
+                                        " archive_directories"))
+                return FALSE;
+        if (!gibbon_database_sql_do (self, error,
+                                     "CREATE TABLE IF NOT EXISTS"
+                                     " archive_directories ("
+                                     "  id INTEGER PRIMARY KEY,"
+                                     "  path TEXT NOT NULL,"
+                                     "  mtime INT64 NOT NULL,"
+                                     "  UNIQUE (path)"
+                                     ")"))
+                return FALSE;
+
+        if (drop_first
+            && !gibbon_database_sql_do (self, error,
+                                        "DROP TABLE IF EXISTS"
+                                        " archived_matches"))
+                return FALSE;
+        if (!gibbon_database_sql_do (self, error,
+                                     "CREATE TABLE IF NOT EXISTS"
+                                     " archived_matches ("
+                                     "  id INTEGER PRIMARY KEY,"
+                                     "  path TEXT NOT NULL,"
+                                     "  session TEXT NOT NULL,"
+                                     "  directory TEXT NOT NULL,"
+                                     "  white TEXT NOT NULL,"
+                                     "  opponent TEXT NOT NULL,"
+                                     "  match_length INTEGER NOT NULL,"
+                                     "  score1 INTEGER NOT NULL,"
+                                     "  score2 INTEGER NOT NULL,"
+                                     "  result INTEGER NOT NULL,"
+                                     "  date_time INT64 NOT NULL,"
+                                     "  error_rate1 REAL,"
+                                     "  error_rate2 REAL,"
+                                     "  UNIQUE (path)"
+                                     ")"))
+                return FALSE;
+
+        if (!gibbon_database_sql_do (self, error,
+                                     "CREATE INDEX IF NOT EXISTS"
+                                     " archived_matches_directory_index"
+                                     " ON archived_matches (directory)"))
+                return FALSE;
+        if (!gibbon_database_sql_do (self, error,
+                                     "CREATE INDEX IF NOT EXISTS"
+                                     " archived_matches_date_time_index"
+                                     " ON archived_matches"
+                                     " (session, date_time)"))
+                return FALSE;
+        if (!gibbon_database_sql_do (self, error,
+                                     "CREATE INDEX IF NOT EXISTS"
+                                     " archived_matches_opponent_index"
+                                     " ON archived_matches"
+                                     " (session, opponent, date_time)"))
+                return FALSE;
+
         if (!gibbon_database_sql_do (self, error, "DELETE FROM version"))
                 return FALSE;
 
@@ -944,6 +1085,7 @@ gibbon_database_sql_execute (GibbonDatabase *self,
                                 va_end (args);
                                 return FALSE;
                         }
+                        type = va_arg (args, gint);
                         continue;
                 }
 
@@ -1645,7 +1787,8 @@ gibbon_database_check_ip2country (GibbonDatabase *self, GError **error)
 
         now = g_get_real_time ();
 
-        if (now - last_update >= 30ULL * 24 * 60 * 60 * 1000000)
+        /* The update needs the user interface.  */
+        if (app && now - last_update >= 30ULL * 24 * 60 * 60 * 1000000)
                 self->priv->geo_ip_updater =
                                 gibbon_geo_ip_updater_new (self, last_update);
         if (self->priv->geo_ip_updater)
@@ -1989,10 +2132,14 @@ gibbon_database_save_match (GibbonDatabase *self,
                             guint match_length,
                             guint score1, guint score2,
                             guint64 date_time,
+                            const GibbonMatchStatistics *statistics,
                             GError **error)
 {
         guint match_id;
         guint user1, user2;
+        gdouble values[18];
+        const gdouble *v[18];
+        gsize i;
 
         gibbon_return_val_if_fail (GIBBON_IS_DATABASE (self), FALSE, error);
         gibbon_return_val_if_fail (hostname != NULL, FALSE, error);
@@ -2000,6 +2147,51 @@ gibbon_database_save_match (GibbonDatabase *self,
         gibbon_return_val_if_fail (white != NULL, FALSE, error);
         gibbon_return_val_if_fail (black != NULL, FALSE, error);
 
+        /*
+         * Statistics that are not known are stored as NULL.  This applies
+         * to all of them for matches without analysis, and to the match
+         * winning chances for money sessions.  Statistics that are already
+         * stored for the match are never overwritten with unknown ones.
+         */
+        if (statistics && gibbon_match_statistics_is_empty (statistics))
+                statistics = NULL;
+
+        memset (v, 0, sizeof v);
+        if (statistics) {
+                for (i = 0; i < 2; ++i) {
+                        values[i] = gibbon_match_statistics_get_error_emg (
+                                        statistics,
+                                        i ? GIBBON_POSITION_SIDE_BLACK
+                                          : GIBBON_POSITION_SIDE_WHITE);
+                        values[2 + i] = gibbon_match_statistics_get_error_mwc (
+                                        statistics,
+                                        i ? GIBBON_POSITION_SIDE_BLACK
+                                          : GIBBON_POSITION_SIDE_WHITE);
+                        values[4 + i] = gibbon_match_statistics_get_error_rate (
+                                        statistics,
+                                        i ? GIBBON_POSITION_SIDE_BLACK
+                                          : GIBBON_POSITION_SIDE_WHITE);
+                        values[6 + i] = statistics->checker_error_emg[i];
+                        values[8 + i] = statistics->checker_error_mwc[i];
+                        values[10 + i] = statistics->cube_error_emg[i];
+                        values[12 + i] = statistics->cube_error_mwc[i];
+                        values[14 + i] = statistics->luck_emg[i];
+                        values[16 + i] = statistics->luck_mwc[i];
+                }
+                for (i = 0; i < 18; ++i)
+                        v[i] = values + i;
+                if (!statistics->match_length) {
+                        v[2] = v[3] = NULL;
+                        v[8] = v[9] = NULL;
+                        v[12] = v[13] = NULL;
+                        v[16] = v[17] = NULL;
+                }
+                if (values[4] < 0)
+                        v[4] = NULL;
+                if (values[5] < 0)
+                        v[5] = NULL;
+        }
+
         if (!gibbon_database_get_statement (self, &self->priv->select_match_id,
                                             GIBBON_DATABASE_SELECT_MATCH_ID,
                                             error)) {
@@ -2022,7 +2214,47 @@ gibbon_database_save_match (GibbonDatabase *self,
                                             GIBBON_DATABASE_SELECT_MATCH_ID,
                                             G_TYPE_UINT, &match_id,
                                             -1)) {
-                return TRUE;
+                if (!statistics)
+                        return TRUE;
+
+                if (!gibbon_database_get_statement (
+                                self, &self->priv->update_match_statistics,
+                                GIBBON_DATABASE_UPDATE_MATCH_STATISTICS,
+                                error))
+                        return FALSE;
+
+                if (!gibbon_database_begin_transaction (self, error))
+                        return FALSE;
+
+                if (!gibbon_database_sql_execute (
+                                self, self->priv->update_match_statistics,
+                                error,
+                                GIBBON_DATABASE_UPDATE_MATCH_STATISTICS,
+                                G_TYPE_DOUBLE, v[0],
+                                G_TYPE_DOUBLE, v[1],
+                                G_TYPE_DOUBLE, v[2],
+                                G_TYPE_DOUBLE, v[3],
+                                G_TYPE_DOUBLE, v[4],
+                                G_TYPE_DOUBLE, v[5],
+                                G_TYPE_DOUBLE, v[6],
+                                G_TYPE_DOUBLE, v[7],
+                                G_TYPE_DOUBLE, v[8],
+                                G_TYPE_DOUBLE, v[9],
+                                G_TYPE_DOUBLE, v[10],
+                                G_TYPE_DOUBLE, v[11],
+                                G_TYPE_DOUBLE, v[12],
+                                G_TYPE_DOUBLE, v[13],
+                                G_TYPE_DOUBLE, v[14],
+                                G_TYPE_DOUBLE, v[15],
+                                G_TYPE_DOUBLE, v[16],
+                                G_TYPE_DOUBLE, v[17],
+                                G_TYPE_UINT, &match_id,
+                                -1)) {
+                        gibbon_database_rollback (self, NULL);
+                        return FALSE;
+                }
+
+                return gibbon_database_commit (self, error);
         }
 
         /*
@@ -2058,6 +2290,24 @@ gibbon_database_save_match (GibbonDatabase *self,
                                           G_TYPE_UINT, &score1,
                                           G_TYPE_UINT, &score2,
                                           G_TYPE_UINT64, &date_time,
+                                          G_TYPE_DOUBLE, v[0],
+                                          G_TYPE_DOUBLE, v[1],
+                                          G_TYPE_DOUBLE, v[2],
+                                          G_TYPE_DOUBLE, v[3],
+                                          G_TYPE_DOUBLE, v[4],
+                                          G_TYPE_DOUBLE, v[5],
+                                          G_TYPE_DOUBLE, v[6],
+                                          G_TYPE_DOUBLE, v[7],
+                                          G_TYPE_DOUBLE, v[8],
+                                          G_TYPE_DOUBLE, v[9],
+                                          G_TYPE_DOUBLE, v[10],
+                                          G_TYPE_DOUBLE, v[11],
+                                          G_TYPE_DOUBLE, v[12],
+                                          G_TYPE_DOUBLE, v[13],
+                                          G_TYPE_DOUBLE, v[14],
+                                          G_TYPE_DOUBLE, v[15],
+                                          G_TYPE_DOUBLE, v[16],
+                                          G_TYPE_DOUBLE, v[17],
                                           -1)) {
                 gibbon_database_rollback (self, NULL);
                 return FALSE;
@@ -2068,3 +2318,334 @@ gibbon_database_save_match (GibbonDatabase *self,
 
         return TRUE;
 }
+
+/**
+ * gibbon_database_get_archive_directory:
+ * @self: The #GibbonDatabase.
+ * @path: Absolute path to a directory of the archive.
+ * @mtime: Location for the modification time.
+ *
+ * Look up the modification time that @path had when it was catalogued
+ * for the last time.
+ *
+ * Returns: %TRUE if @path has been catalogued before, %FALSE otherwise.
+ */
+gboolean
+gibbon_database_get_archive_directory (GibbonDatabase *self,
+                                       const gchar *path, gint64 *mtime)
+{
+        g_return_val_if_fail (GIBBON_IS_DATABASE (self), FALSE);
+        g_return_val_if_fail (path != NULL, FALSE);
+        g_return_val_if_fail (mtime != NULL, FALSE);
+
+        if (!gibbon_database_get_statement (
+                        self, &self->priv->select_archive_directory,
+                        GIBBON_DATABASE_SELECT_ARCHIVE_DIRECTORY, NULL))
+                return FALSE;
+
+        if (!gibbon_database_sql_execute (
+                        self, self->priv->select_archive_directory, NULL,
+                        GIBBON_DATABASE_SELECT_ARCHIVE_DIRECTORY,
+                        G_TYPE_STRING, &path,
+                        -1))
+                return FALSE;
+
+        return gibbon_database_sql_select_row (
+                        self, self->priv->select_archive_directory, NULL,
+                        GIBBON_DATABASE_SELECT_ARCHIVE_DIRECTORY,
+                        G_TYPE_INT64, mtime,
+                        -1);
+}
+
+/**
+ * gibbon_database_get_archived_paths:
+ * @self: The #GibbonDatabase.
+ * @directory: Absolute path to a directory of the archive.
+ * @error: Location for errors.
+ *
+ * Retrieve the paths of all catalogued matches in @directory.
+ *
+ * Returns: A #GHashTable with the paths as keys or %NULL for failure.
+ * Free it with g_hash_table_destroy().
+ */
+GHashTable *
+gibbon_database_get_archived_paths (GibbonDatabase *self,
+                                    const gchar *directory,
+                                    GError **error)
+{
+        GHashTable *paths;
+        const gchar *path;
+
+        gibbon_return_val_if_fail (GIBBON_IS_DATABASE (self), NULL, error);
+        gibbon_return_val_if_fail (directory != NULL, NULL, error);
+
+        if (!gibbon_database_get_statement (
+                        self, &self->priv->select_archived_paths,
+                        GIBBON_DATABASE_SELECT_ARCHIVED_PATHS, error))
+                return NULL;
+
+        if (!gibbon_database_sql_execute (
+                        self, self->priv->select_archived_paths, error,
+                        GIBBON_DATABASE_SELECT_ARCHIVED_PATHS,
+                        G_TYPE_STRING, &directory,
+                        -1))
+                return NULL;
+
+        paths = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+        while (gibbon_database_sql_select_row (
+                        self, self->priv->select_archived_paths, NULL,
+                        GIBBON_DATABASE_SELECT_ARCHIVED_PATHS,
+                        G_TYPE_STRING, &path,
+                        -1)) {
+                g_hash_table_insert (paths, g_strdup (path), NULL);
+        }
+
+        return paths;
+}
+
+static gboolean
+gibbon_database_catalogue_entry (GibbonDatabase *self, const gchar *session,
+                                 const GibbonArchiveEntry *entry,
+                                 GError **error)
+{
+        gchar *directory;
+        gboolean result;
+        const gdouble *error_rate1 = NULL;
+        const gdouble *error_rate2 = NULL;
+
+        if (entry->error_rates[0] >= 0)
+                error_rate1 = &entry->error_rates[0];
+        if (entry->error_rates[1] >= 0)
+                error_rate2 = &entry->error_rates[1];
+
+        directory = g_path_get_dirname (entry->path);
+        result = gibbon_database_sql_execute (
+                        self, self->priv->catalogue_match, error,
+                        GIBBON_DATABASE_CATALOGUE_MATCH,
+                        G_TYPE_STRING, &entry->path,
+                        G_TYPE_STRING, &session,
+                        G_TYPE_STRING, &directory,
+                        G_TYPE_STRING, &entry->white,
+                        G_TYPE_STRING, &entry->opponent,
+                        G_TYPE_UINT, &entry->match_length,
+                        G_TYPE_UINT, &entry->scores[0],
+                        G_TYPE_UINT, &entry->scores[1],
+                        G_TYPE_INT, &entry->result,
+                        G_TYPE_INT64, &entry->start_time,
+                        G_TYPE_DOUBLE, error_rate1,
+                        G_TYPE_DOUBLE, error_rate2,
+                        -1);
+        g_free (directory);
+
+        return result;
+}
+
+/**
+ * gibbon_database_catalogue_match:
+ * @self: The #GibbonDatabase.
+ * @session: The session directory that @entry belongs to.
+ * @entry: The #GibbonArchiveEntry to store.
+ * @error: Location for errors.
+ *
+ * Add @entry to the catalogue of archived matches or replace an existing
+ * record for the same path.
+ *
+ * Returns: %TRUE for success, %FALSE for failure.
+ */
+gboolean
+gibbon_database_catalogue_match (GibbonDatabase *self, const gchar *session,
+                                 const GibbonArchiveEntry *entry,
+                                 GError **error)
+{
+        gibbon_return_val_if_fail (GIBBON_IS_DATABASE (self), FALSE, error);
+        gibbon_return_val_if_fail (session != NULL, FALSE, error);
+        gibbon_return_val_if_fail (entry != NULL, FALSE, error);
+        gibbon_return_val_if_fail (entry->path != NULL, FALSE, error);
+
+        if (!gibbon_database_get_statement (self, &self->priv->catalogue_match,
+                                            GIBBON_DATABASE_CATALOGUE_MATCH,
+                                            error))
+                return FALSE;
+
+        return gibbon_database_catalogue_entry (self, session, entry, error);
+}
+
+/**
+ * gibbon_database_catalogue_directory:
+ * @self: The #GibbonDatabase.
+ * @session: The session directory that @directory belongs to.
+ * @directory: Absolute path to a directory of the archive.
+ * @mtime: The current modification time of @directory.
+ * @added: A #GSList of #GibbonArchiveEntry records to add.
+ * @removed: A #GSList of paths to remove from the catalogue.
+ * @error: Location for errors.
+ *
+ * Synchronize the catalogue with the contents of @directory.  All changes
+ * are written in one transaction.
+ *
+ * Returns: %TRUE for success, %FALSE for failure.
+ */
+gboolean
+gibbon_database_catalogue_directory (GibbonDatabase *self,
+                                     const gchar *session,
+                                     const gchar *directory, gint64 mtime,
+                                     const GSList *added,
+                                     const GSList *removed,
+                                     GError **error)
+{
+        const GSList *iter;
+        const gchar *path;
+
+        gibbon_return_val_if_fail (GIBBON_IS_DATABASE (self), FALSE, error);
+        gibbon_return_val_if_fail (session != NULL, FALSE, error);
+        gibbon_return_val_if_fail (directory != NULL, FALSE, error);
+
+        if (!gibbon_database_get_statement (self, &self->priv->catalogue_match,
+                                            GIBBON_DATABASE_CATALOGUE_MATCH,
+                                            error))
+                return FALSE;
+        if (!gibbon_database_get_statement (
+                        self, &self->priv->uncatalogue_match,
+                        GIBBON_DATABASE_UNCATALOGUE_MATCH, error))
+                return FALSE;
+        if (!gibbon_database_get_statement (
+                        self, &self->priv->update_archive_directory,
+                        GIBBON_DATABASE_UPDATE_ARCHIVE_DIRECTORY, error))
+                return FALSE;
+
+        if (!gibbon_database_begin_transaction (self, error))
+                return FALSE;
+
+        for (iter = added; iter; iter = iter->next) {
+                if (!gibbon_database_catalogue_entry (self, session,
+                                                      iter->data, error)) {
+                        gibbon_database_rollback (self, NULL);
+                        return FALSE;
+                }
+        }
+
+        for (iter = removed; iter; iter = iter->next) {
+                path = iter->data;
+                if (!gibbon_database_sql_execute (
+                                self, self->priv->uncatalogue_match, error,
+                                GIBBON_DATABASE_UNCATALOGUE_MATCH,
+                                G_TYPE_STRING, &path,
+                                -1)) {
+                        gibbon_database_rollback (self, NULL);
+                        return FALSE;
+                }
+        }
+
+        if (!gibbon_database_sql_execute (
+                        self, self->priv->update_archive_directory, error,
+                        GIBBON_DATABASE_UPDATE_ARCHIVE_DIRECTORY,
+                        G_TYPE_STRING, &directory,
+                        G_TYPE_INT64, &mtime,
+                        -1)) {
+                gibbon_database_rollback (self, NULL);
+                return FALSE;
+        }
+
+        return gibbon_database_commit (self, error);
+}
+
+/**
+ * gibbon_database_query_catalogue:
+ * @self: The #GibbonDatabase.
+ * @session: The session directory to search.
+ * @opponent: Name of the opponent or %NULL for all opponents.
+ * @from: Earliest start time in microseconds since the epoch or %G_MININT64.
+ * @to: Latest start time (exclusive) or %G_MAXINT64.
+ * @result: Only return matches with this result.
+ * @error: Location for errors.
+ *
+ * Search the catalogue of archived matches.  The records are sorted by
+ * start time.
+ *
+ * Returns: A #GSList of #GibbonArchiveEntry records or %NULL if nothing
+ * was found or in case of failure.  Free it with g_slist_free_full() and
+ * gibbon_archive_entry_free().
+ */
+GSList *
+gibbon_database_query_catalogue (GibbonDatabase *self, const gchar *session,
+                                 const gchar *opponent,
+                                 gint64 from, gint64 to,
+                                 GibbonArchiveResult result,
+                                 GError **error)
+{
+        GString *sql;
+        sqlite3_stmt *stmt;
+        int status;
+        int i = 0;
+        GSList *entries = NULL;
+        GibbonArchiveEntry *entry;
+
+        gibbon_return_val_if_fail (GIBBON_IS_DATABASE (self), NULL, error);
+        gibbon_return_val_if_fail (session != NULL, NULL, error);
+
+        /*
+         * The statement is assembled on the fly, so that sqlite can pick
+         * the right index.
+         */
+        sql = g_string_new ("SELECT path, white, opponent, match_length,"
+                            " score1, score2, date_time, result,"
+                            " error_rate1, error_rate2"
+                            " FROM archived_matches"
+                            " WHERE session = ?"
+                            " AND date_time >= ? AND date_time < ?");
+        if (opponent)
+                g_string_append (sql, " AND opponent = ?");
+        if (result != GIBBON_ARCHIVE_RESULT_ANY)
+                g_string_append (sql, " AND result = ?");
+        g_string_append (sql, " ORDER BY date_time");
+
+        if (sqlite3_prepare_v2 (self->priv->dbh, sql->str, -1, &stmt, NULL)) {
+                gibbon_database_set_error (self, error, sql->str);
+                g_string_free (sql, TRUE);
+                return NULL;
+        }
+
+        if (sqlite3_bind_text (stmt, ++i, session, -1, SQLITE_STATIC)
+            || sqlite3_bind_int64 (stmt, ++i, from)
+            || sqlite3_bind_int64 (stmt, ++i, to)
+            || (opponent
+                && sqlite3_bind_text (stmt, ++i, opponent, -1, SQLITE_STATIC))
+            || (result != GIBBON_ARCHIVE_RESULT_ANY
+                && sqlite3_bind_int (stmt, ++i, result))) {
+                gibbon_database_set_error (self, error, sql->str);
+                sqlite3_finalize (stmt);
+                g_string_free (sql, TRUE);
+                return NULL;
+        }
+
+        while (SQLITE_ROW == (status = sqlite3_step (stmt))) {
+                entry = gibbon_archive_entry_new (
+                                (const gchar *) sqlite3_column_text (stmt, 0),
+                                (const gchar *) sqlite3_column_text (stmt, 1),
+                                (const gchar *) sqlite3_column_text (stmt, 2),
+                                sqlite3_column_int (stmt, 3),
+                                sqlite3_column_int (stmt, 4),
+                                sqlite3_column_int (stmt, 5),
+                                sqlite3_column_int64 (stmt, 6));
+                entry->result = sqlite3_column_int (stmt, 7);
+                if (SQLITE_NULL != sqlite3_column_type (stmt, 8))
+                        entry->error_rates[0] =
+                                sqlite3_column_double (stmt, 8);
+                if (SQLITE_NULL != sqlite3_column_type (stmt, 9))
+                        entry->error_rates[1] =
+                                sqlite3_column_double (stmt, 9);
+                entries = g_slist_prepend (entries, entry);
+        }
+
+        if (SQLITE_DONE != status) {
+                gibbon_database_set_error (self, error, sql->str);
+                g_slist_free_full (entries,
+                                   (GDestroyNotify) gibbon_archive_entry_free);
+                entries = NULL;
+        }
+
+        sqlite3_finalize (stmt);
+        g_string_free (sql, TRUE);
+
+        return g_slist_reverse (entries);
+}
@@ -27,6 +27,9 @@
 #include <glib.h>
 #include <glib-object.h>
 
+#include "gibbon-archive-entry.h"
+#include "gibbon-match-statistics.h"
+
 #define GIBBON_TYPE_DATABASE \
         (gibbon_database_get_type ())
 #define GIBBON_DATABASE(obj) \
@@ -140,6 +143,30 @@ gboolean gibbon_database_save_match (GibbonDatabase *self,
                                      guint match_length,
                                      guint score1, guint score2,
                                      guint64 date_time,
+                                     const GibbonMatchStatistics *statistics,
                                      GError **error);
+gboolean gibbon_database_get_archive_directory (GibbonDatabase *self,
+                                                const gchar *path,
+                                                gint64 *mtime);
+GHashTable *gibbon_database_get_archived_paths (GibbonDatabase *self,
+                                                const gchar *directory,
+                                                GError **error);
+gboolean gibbon_database_catalogue_match (GibbonDatabase *self,
+                                          const gchar *session,
+                                          const GibbonArchiveEntry *entry,
+                                          GError **error);
+gboolean gibbon_database_catalogue_directory (GibbonDatabase *self,
+                                              const gchar *session,
+                                              const gchar *directory,
+                                              gint64 mtime,
+                                              const GSList *added,
+                                              const GSList *removed,
+                                              GError **error);
+GSList *gibbon_database_query_catalogue (GibbonDatabase *self,
+                                         const gchar *session,
+                                         const gchar *opponent,
+                                         gint64 from, gint64 to,
+                                         GibbonArchiveResult result,
+                                         GError **error);
 
 #endif
@@ -27,6 +27,7 @@
  **/
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <glib.h>
 #include <glib/gi18n.h>
@@ -36,13 +37,43 @@
 #include "gibbon-game-actions.h"
 #include "gibbon-util.h"
 
+/*
+ * Every GIBBON_GAME_KEYFRAME_INTERVAL-th snapshot stores the complete
+ * position.  Reconstructing a position therefore applies at most
+ * GIBBON_GAME_KEYFRAME_INTERVAL - 1 deltas.
+ */
+#define GIBBON_GAME_KEYFRAME_INTERVAL 8
+
+/*
+ * Number of reconstructed positions that are kept.  Pointers returned by
+ * gibbon_game_get_nth_position() stay valid until they are evicted.
+ */
+#define GIBBON_GAME_CACHE_SIZE 8
+
+typedef struct _GibbonGameCacheEntry GibbonGameCacheEntry;
+struct _GibbonGameCacheEntry {
+        gsize index;
+        GibbonPosition *position;
+};
+
 typedef struct _GibbonGamePrivate GibbonGamePrivate;
 struct _GibbonGamePrivate {
+        /* The match owns the game and is therefore not referenced.  */
+        GibbonMatch *match;
+
         GibbonPosition *initial_position;
         gboolean edited;
 
         gsize num_snapshots;
+        gsize max_snapshots;
         GibbonGameSnapshot *snapshots;
+        GByteArray *deltas;
+
+        /* The resulting position of the last snapshot.  */
+        GibbonPosition *current;
+
+        GibbonGameCacheEntry cache[GIBBON_GAME_CACHE_SIZE];
+        guint cache_next;
 
         gint64 score;
         gboolean resigned;
@@ -97,6 +128,13 @@ static const GibbonGameSnapshot *gibbon_game_get_snapshot (const GibbonGame
                                                            *self);
 static const GibbonGameSnapshot *gibbon_game_get_nth_snapshot (const GibbonGame
                                                                *self, gint n);
+static const GibbonPosition *gibbon_game_get_resulting_position (const
+                                                                 GibbonGame
+                                                                 *self,
+                                                                 gsize i);
+static void gibbon_game_cache_position (const GibbonGame *self, gsize i,
+                                        GibbonPosition *position);
+static void gibbon_game_clear_cache (GibbonGame *self);
 
 static void 
 gibbon_game_init (GibbonGame *self)
@@ -104,11 +142,18 @@ gibbon_game_init (GibbonGame *self)
         self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                 GIBBON_TYPE_GAME, GibbonGamePrivate);
 
+        self->priv->match = NULL;
         self->priv->initial_position = NULL;
         self->priv->edited = FALSE;
 
         self->priv->snapshots = NULL;
         self->priv->num_snapshots = 0;
+        self->priv->max_snapshots = 0;
+        self->priv->deltas = g_byte_array_new ();
+
+        self->priv->current = NULL;
+        memset (self->priv->cache, 0, sizeof self->priv->cache);
+        self->priv->cache_next = 0;
 
         self->priv->score = 0;
         self->priv->resigned = FALSE;
@@ -127,14 +172,20 @@ gibbon_game_finalize (GObject *object)
         if (self->priv->initial_position)
                 gibbon_position_free (self->priv->initial_position);
 
+        gibbon_game_clear_cache (self);
+        if (self->priv->current && !gibbon_game_get_snapshot (self)->keyframe)
+                gibbon_position_free (self->priv->current);
+
         for (i = 0; i < self->priv->num_snapshots; ++i) {
                 snapshot = &self->priv->snapshots[i];
                 g_object_unref (snapshot->action);
                 if (snapshot->analysis)
                         g_object_unref (snapshot->analysis);
-                gibbon_position_free (snapshot->resulting_position);
+                if (snapshot->keyframe)
+                        gibbon_position_free (snapshot->keyframe);
         }
         g_free (self->priv->snapshots);
+        g_byte_array_free (self->priv->deltas, TRUE);
 
         G_OBJECT_CLASS (gibbon_game_parent_class)->finalize(object);
 }
@@ -155,6 +206,7 @@ gibbon_game_new (GibbonMatch *match, const GibbonPosition *pos,
 {
         GibbonGame *self = g_object_new (GIBBON_TYPE_GAME, NULL);
 
+        self->priv->match = match;
         self->priv->initial_position = gibbon_position_copy (pos);
         self->priv->is_crawford = is_crawford;
 
@@ -252,6 +304,7 @@ gibbon_game_add_action_with_analysis (GibbonGame *self, GibbonPositionSide side,
                                       GError **error)
 {
         GibbonGameSnapshot *snapshot;
+        const GibbonPosition *before;
 
         gibbon_return_val_if_fail (GIBBON_IS_GAME (self), FALSE, error);
         gibbon_return_val_if_fail (GIBBON_IS_GAME_ACTION (action), FALSE,
@@ -263,6 +316,12 @@ gibbon_game_add_action_with_analysis (GibbonGame *self, GibbonPositionSide side,
                 gibbon_return_val_if_fail (GIBBON_IS_ANALYSIS (analysis),
                                                  FALSE, error);
 
+        /*
+         * The previous position stays valid while the action is added
+         * because it is either a keyframe or gets cached.
+         */
+        before = gibbon_game_get_position (self);
+
         if (!gibbon_game_add_action (self, side, action, timestamp, error))
                 return FALSE;
 
@@ -272,6 +331,10 @@ gibbon_game_add_action_with_analysis (GibbonGame *self, GibbonPositionSide side,
         snapshot = self->priv->snapshots + self->priv->num_snapshots - 1;
         snapshot->analysis = analysis;
 
+        if (self->priv->match)
+                gibbon_match_update_statistics (self->priv->match, before,
+                                                side, action, analysis);
+
         return TRUE;
 }
 
@@ -280,7 +343,6 @@ gibbon_game_add_roll (GibbonGame *self, GibbonPositionSide side,
                       GibbonRoll *roll, gint64 timestamp, GError **error)
 {
         GibbonPosition *pos;
-        const GibbonGameSnapshot *snapshot;
 
         if (gibbon_game_over (self)) {
                 g_set_error_literal (error, GIBBON_ERROR,
@@ -289,13 +351,7 @@ gibbon_game_add_roll (GibbonGame *self, GibbonPositionSide side,
                 return FALSE;
         }
 
-        snapshot = gibbon_game_get_snapshot (self);
-
-        if (snapshot) {
-                pos = gibbon_position_copy (snapshot->resulting_position);
-        } else {
-                pos = gibbon_position_copy (self->priv->initial_position);
-        }
+        pos = gibbon_position_copy (gibbon_game_get_position (self));
 
         if (side && pos->turn && side != pos->turn) {
                 gibbon_position_free (pos);
@@ -345,6 +401,7 @@ gibbon_game_add_move (GibbonGame *self, GibbonPositionSide side,
 {
         GibbonPosition *pos;
         gchar *pretty_move;
+        const gchar *player;
 
         gibbon_return_val_if_fail (move->number <= 4, FALSE, error);
 
@@ -384,25 +441,19 @@ gibbon_game_add_move (GibbonGame *self, GibbonPositionSide side,
                 return FALSE;
         }
 
-        g_free (pos->status);
+        player = side == GIBBON_POSITION_SIDE_BLACK
+                ? pos->players[1] : pos->players[0];
         if (move->movements) {
                 pretty_move = gibbon_position_format_move (pos, move, side,
                                                            FALSE);
-                pos->status = g_strdup_printf (_("%d%d: %s has moved %s."),
-                                               move->die1, move->die2,
-                                               side
-                                               == GIBBON_POSITION_SIDE_BLACK
-                                               ? pos->players[1]
-                                               : pos->players[0],
-                                               pretty_move);
+                gibbon_position_take_status (pos, g_strdup_printf (
+                                _("%d%d: %s has moved %s."),
+                                move->die1, move->die2, player, pretty_move));
                 g_free (pretty_move);
         } else {
-                pos->status = g_strdup_printf (_("%d%d: %s cannot move!"),
-                                               move->die1, move->die2,
-                                               side
-                                               == GIBBON_POSITION_SIDE_BLACK
-                                               ? pos->players[1]
-                                               : pos->players[0]);
+                gibbon_position_take_status (pos, g_strdup_printf (
+                                _("%d%d: %s cannot move!"),
+                                move->die1, move->die2, player));
         }
 
         gibbon_game_add_snapshot (self, GIBBON_GAME_ACTION (move), side, pos,
@@ -460,15 +511,14 @@ gibbon_game_add_double (GibbonGame *self, GibbonPositionSide side,
                 return FALSE;
         }
 
-        g_free (pos->status);
         if (side == GIBBON_POSITION_SIDE_WHITE) {
                 pos->cube_turned = GIBBON_POSITION_SIDE_WHITE;
-                pos->status = g_strdup_printf (_("%s offers a double."),
-                                               pos->players[0]);
+                gibbon_position_take_status (pos, g_strdup_printf (
+                                _("%s offers a double."), pos->players[0]));
         } else {
                 pos->cube_turned = GIBBON_POSITION_SIDE_BLACK;
-                pos->status = g_strdup_printf (_("%s offers a double."),
-                                               pos->players[1]);
+                gibbon_position_take_status (pos, g_strdup_printf (
+                                _("%s offers a double."), pos->players[1]));
         }
 
         /* Beaver? */
@@ -503,20 +553,19 @@ gibbon_game_add_drop (GibbonGame *self, GibbonPositionSide side,
                 return FALSE;
         }
 
-        g_free (pos->status);
         if (side == GIBBON_POSITION_SIDE_WHITE) {
                 self->priv->score = -pos->cube;
                 pos->scores[1] += pos->cube;
                 pos->score = pos->cube;
-                pos->status = g_strdup_printf (_("%s refuses the cube."),
-                                               pos->players[0]);
+                gibbon_position_take_status (pos, g_strdup_printf (
+                                _("%s refuses the cube."), pos->players[0]));
 
         } else {
                 self->priv->score = pos->cube;
                 pos->scores[0] += pos->cube;
                 pos->score = -pos->cube;
-                pos->status = g_strdup_printf (_("%s refuses the cube."),
-                                               pos->players[1]);
+                gibbon_position_take_status (pos, g_strdup_printf (
+                                _("%s refuses the cube."), pos->players[1]));
         }
 
         pos->cube_turned = GIBBON_POSITION_SIDE_NONE;
@@ -636,8 +685,8 @@ gibbon_game_add_reject (GibbonGame *self, GibbonPositionSide side,
                 player = pos->players[0];
         }
 
-        g_free (pos->status);
-        pos->status = g_strdup_printf (_("%s rejects."), player);
+        gibbon_position_take_status (pos, g_strdup_printf (_("%s rejects."),
+                                                           player));
 
         gibbon_game_add_snapshot (self, GIBBON_GAME_ACTION (reject), side, pos,
                                   timestamp);
@@ -678,15 +727,14 @@ gibbon_game_add_accept (GibbonGame *self, GibbonPositionSide side,
 
         pos = gibbon_position_copy (gibbon_game_get_position (self));
 
-        g_free (pos->status);
-        pos->status = g_strdup_printf (
+        gibbon_position_take_status (pos, g_strdup_printf (
                         g_dngettext (GETTEXT_PACKAGE,
                                      "%s resigns and gives up one point.",
                                      "%s resigns and gives up %llu points.",
                                      resign->value),
                       other == GIBBON_POSITION_SIDE_BLACK ?
                                       pos->players[0] : pos->players[1],
-                      (unsigned long long) pos->cube);
+                      (unsigned long long) pos->cube));
 
         if (side == GIBBON_POSITION_SIDE_BLACK) {
                 pos->scores[1] += resign->value;
@@ -718,41 +766,65 @@ gibbon_game_over (const GibbonGame *self)
 const GibbonPosition *
 gibbon_game_get_position (const GibbonGame *self)
 {
-        const GibbonGameSnapshot *snapshot;
-
         g_return_val_if_fail (GIBBON_IS_GAME (self), NULL);
 
-        snapshot = gibbon_game_get_snapshot (self);
-        if (snapshot)
-                return snapshot->resulting_position;
+        if (self->priv->current)
+                return self->priv->current;
         else
                 return self->priv->initial_position;
 }
 
+/*
+ * Takes ownership of @position.
+ */
 static void
 gibbon_game_add_snapshot (GibbonGame *self, GibbonGameAction *action,
                           GibbonPositionSide side, GibbonPosition *position,
                           gint64 timestamp)
 {
         GibbonGameSnapshot *snapshot;
+        gsize i = self->priv->num_snapshots;
 
-        self->priv->snapshots = g_realloc (self->priv->snapshots,
-                                           ++self->priv->num_snapshots
-                                           * sizeof *self->priv->snapshots);
+        if (i == self->priv->max_snapshots) {
+                self->priv->max_snapshots = i ? 2 * i : 16;
+                self->priv->snapshots = g_renew (GibbonGameSnapshot,
+                                                 self->priv->snapshots,
+                                                 self->priv->max_snapshots);
+        }
 
-        snapshot = self->priv->snapshots + self->priv->num_snapshots - 1;
+        snapshot = self->priv->snapshots + i;
 
         snapshot->action = action;
         snapshot->side = side;
-        snapshot->resulting_position = position;
         snapshot->analysis = NULL;
         snapshot->timestamp = timestamp;
+
+        snapshot->delta_offset = self->priv->deltas->len;
+        if (i % GIBBON_GAME_KEYFRAME_INTERVAL) {
+                snapshot->keyframe = NULL;
+                gibbon_position_delta_encode (self->priv->current, position,
+                                              self->priv->deltas);
+        } else {
+                snapshot->keyframe = position;
+        }
+        snapshot->delta_length = self->priv->deltas->len
+                - snapshot->delta_offset;
+
+        /*
+         * Callers may still hold a pointer to the previous position.
+         * Keyframes stay valid anyway.
+         */
+        if (i && !self->priv->snapshots[i - 1].keyframe)
+                gibbon_game_cache_position (self, i - 1, self->priv->current);
+
+        self->priv->current = position;
+        self->priv->num_snapshots = i + 1;
 }
 
 static const GibbonGameSnapshot *
 gibbon_game_get_snapshot (const GibbonGame *self)
 {
-        if (!self->priv->snapshots)
+        if (!self->priv->num_snapshots)
                 return NULL;
 
         return self->priv->snapshots + self->priv->num_snapshots - 1;
@@ -799,6 +871,18 @@ gibbon_game_get_edited (const GibbonGame *self)
         return self->priv->edited;
 }
 
+/**
+ * gibbon_game_get_nth_position:
+ * @self: The #GibbonGame.
+ * @n: The index of the action, negative values count from the end.
+ *
+ * Positions are reconstructed on demand.  The returned position remains
+ * valid until it is evicted from the cache by eight other reconstructed
+ * positions, or until the game is modified.  Copy it if you need it for a
+ * longer time.
+ *
+ * Returns: The position resulting from the @n-th action or %NULL.
+ */
 const GibbonPosition *
 gibbon_game_get_nth_position (const GibbonGame *self, gint n)
 {
@@ -809,11 +893,97 @@ gibbon_game_get_nth_position (const GibbonGame *self, gint n)
         snapshot = gibbon_game_get_nth_snapshot (self, n);
 
         if (snapshot)
-                return snapshot->resulting_position;
+                return gibbon_game_get_resulting_position (
+                                self, snapshot - self->priv->snapshots);
         else
                 return NULL;
 }
 
+static const GibbonPosition *
+gibbon_game_get_resulting_position (const GibbonGame *self, gsize i)
+{
+        const GibbonGameSnapshot *snapshot;
+        const GibbonGameCacheEntry *entry;
+        const GibbonPosition *base;
+        GibbonPosition *position;
+        gsize start, j;
+
+        if (i + 1 == self->priv->num_snapshots)
+                return self->priv->current;
+
+        snapshot = self->priv->snapshots + i;
+        if (snapshot->keyframe)
+                return snapshot->keyframe;
+
+        /* Start from the closest preceding position that we have.  */
+        start = i - i % GIBBON_GAME_KEYFRAME_INTERVAL;
+        base = self->priv->snapshots[start].keyframe;
+        for (j = 0; j < GIBBON_GAME_CACHE_SIZE; ++j) {
+                entry = self->priv->cache + j;
+                if (!entry->position || entry->index > i
+                    || entry->index <= start)
+                        continue;
+                if (entry->index == i)
+                        return entry->position;
+                start = entry->index;
+                base = entry->position;
+        }
+
+        position = gibbon_position_copy (base);
+        for (j = start + 1; j <= i; ++j) {
+                snapshot = self->priv->snapshots + j;
+                if (!gibbon_position_delta_apply (position,
+                                                  self->priv->deltas->data
+                                                  + snapshot->delta_offset,
+                                                  snapshot->delta_length)) {
+                        gibbon_position_free (position);
+                        g_return_val_if_reached (NULL);
+                }
+        }
+
+        /* The deltas may contain outdated names or match lengths.  */
+        gibbon_position_set_player (position, base->players[0],
+                                    GIBBON_POSITION_SIDE_WHITE);
+        gibbon_position_set_player (position, base->players[1],
+                                    GIBBON_POSITION_SIDE_BLACK);
+        position->match_length = base->match_length;
+
+        gibbon_game_cache_position (self, i, position);
+
+        return position;
+}
+
+/*
+ * Takes ownership of @position.
+ */
+static void
+gibbon_game_cache_position (const GibbonGame *self, gsize i,
+                            GibbonPosition *position)
+{
+        GibbonGameCacheEntry *entry;
+
+        entry = self->priv->cache + self->priv->cache_next;
+        if (entry->position)
+                gibbon_position_free (entry->position);
+        entry->index = i;
+        entry->position = position;
+
+        self->priv->cache_next = (self->priv->cache_next + 1)
+                % GIBBON_GAME_CACHE_SIZE;
+}
+
+static void
+gibbon_game_clear_cache (GibbonGame *self)
+{
+        gsize i;
+
+        for (i = 0; i < GIBBON_GAME_CACHE_SIZE; ++i) {
+                if (self->priv->cache[i].position)
+                        gibbon_position_free (self->priv->cache[i].position);
+                self->priv->cache[i].position = NULL;
+        }
+}
+
 GibbonAnalysis *
 gibbon_game_get_nth_analysis (const GibbonGame *self, gint n)
 {
@@ -868,71 +1038,85 @@ gibbon_game_get_nth_snapshot (const GibbonGame *self, gint n)
         return self->priv->snapshots + i;
 }
 
-void
-gibbon_game_set_white (GibbonGame *self, const gchar *white)
+/*
+ * All positions of a game share the player names and the match length.
+ * Only the positions that are stored in full are updated.  Deltas that
+ * were recorded earlier may still carry the old values, and
+ * gibbon_game_get_resulting_position() therefore copies them from the
+ * position that it starts from.
+ */
+static void
+gibbon_game_foreach_position (GibbonGame *self,
+                              void (*func) (GibbonPosition *position,
+                                            gconstpointer data),
+                              gconstpointer data)
 {
-        GibbonPosition *position;
         GibbonGameSnapshot *snapshot;
         gsize i;
 
-        g_return_if_fail (GIBBON_IS_GAME (self));
-
-        position = self->priv->initial_position;
-        g_free (position->players[0]);
-        position->players[0] = g_strdup (white);
+        func (self->priv->initial_position, data);
 
         for (i = 0; i < self->priv->num_snapshots; ++i) {
                 snapshot = self->priv->snapshots + i;
-                position = snapshot->resulting_position;
-                g_free (position->players[0]);
-                position->players[0] = g_strdup (white);
+                if (snapshot->keyframe)
+                        func (snapshot->keyframe, data);
         }
 
-        return;
+        if (self->priv->current && !gibbon_game_get_snapshot (self)->keyframe)
+                func (self->priv->current, data);
+
+        for (i = 0; i < GIBBON_GAME_CACHE_SIZE; ++i)
+                if (self->priv->cache[i].position)
+                        func (self->priv->cache[i].position, data);
 }
 
-void
-gibbon_game_set_black (GibbonGame *self, const gchar *black)
+static void
+gibbon_game_set_position_white (GibbonPosition *position, gconstpointer white)
 {
-        GibbonPosition *position;
-        GibbonGameSnapshot *snapshot;
-        gsize i;
+        gibbon_position_set_player (position, white,
+                                    GIBBON_POSITION_SIDE_WHITE);
+}
 
-        g_return_if_fail (GIBBON_IS_GAME (self));
+static void
+gibbon_game_set_position_black (GibbonPosition *position, gconstpointer black)
+{
+        gibbon_position_set_player (position, black,
+                                    GIBBON_POSITION_SIDE_BLACK);
+}
 
-        position = self->priv->initial_position;
-        g_free (position->players[1]);
-        position->players[1] = g_strdup (black);
+static void
+gibbon_game_set_position_match_length (GibbonPosition *position,
+                                       gconstpointer length)
+{
+        position->match_length = *(const gsize *) length;
+}
 
-        for (i = 0; i < self->priv->num_snapshots; ++i) {
-                snapshot = self->priv->snapshots + i;
-                position = snapshot->resulting_position;
-                g_free (position->players[1]);
-                position->players[1] = g_strdup (black);
-        }
+void
+gibbon_game_set_white (GibbonGame *self, const gchar *white)
+{
+        g_return_if_fail (GIBBON_IS_GAME (self));
 
-        return;
+        gibbon_game_foreach_position (self, gibbon_game_set_position_white,
+                                      white);
 }
 
 void
-gibbon_game_set_match_length (GibbonGame *self, gsize length)
+gibbon_game_set_black (GibbonGame *self, const gchar *black)
 {
-        GibbonPosition *position;
-        GibbonGameSnapshot *snapshot;
-        gsize i;
-
         g_return_if_fail (GIBBON_IS_GAME (self));
 
-        position = self->priv->initial_position;
-        position->match_length = length;
+        gibbon_game_foreach_position (self, gibbon_game_set_position_black,
+                                      black);
+}
 
-        for (i = 0; i < self->priv->num_snapshots; ++i) {
-                snapshot = self->priv->snapshots + i;
-                position = snapshot->resulting_position;
-                position->match_length = length;
-        }
+void
+gibbon_game_set_match_length (GibbonGame *self, gsize length)
+{
+        g_return_if_fail (GIBBON_IS_GAME (self));
 
-        return;
+        gibbon_game_foreach_position (self,
+                                      gibbon_game_set_position_match_length,
+                                      &length);
 }
 
 const GibbonGameAction *
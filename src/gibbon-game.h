@@ -49,11 +49,18 @@
         (G_TYPE_INSTANCE_GET_CLASS ((obj), \
                 GIBBON_TYPE_GAME, GibbonGameClass))
 
+/*
+ * The resulting position of a snapshot is stored in full for every
+ * GIBBON_GAME_KEYFRAME_INTERVAL-th snapshot.  All other snapshots store
+ * the delta to the previous position, see gibbon_position_delta_encode().
+ */
 typedef struct _GibbonGameSnapshot GibbonGameSnapshot;
 struct _GibbonGameSnapshot {
         GibbonGameAction *action;
         GibbonPositionSide side;
-        GibbonPosition *resulting_position;
+        GibbonPosition *keyframe;
+        guint32 delta_offset;
+        guint32 delta_length;
         GibbonAnalysis *analysis;
         gint64 timestamp;
 };
@@ -117,7 +124,14 @@ gboolean gibbon_game_get_edited (const GibbonGame *self);
 void gibbon_game_set_initial_position (GibbonGame *self,
                                        const GibbonPosition *position);
 
-/* Yes! N can be negative, think Perl! */
+/*
+ * Yes! N can be negative, think Perl!
+ *
+ * Most positions are reconstructed from deltas into a ring cache of eight
+ * entries.  The returned pointer is only valid until eight other positions
+ * have been reconstructed, or until the game is modified.  Copy the
+ * position with gibbon_position_copy() if you need it for longer.
+ */
 const GibbonPosition *gibbon_game_get_nth_position (const GibbonGame *self,
                                                     gint n);
 const GibbonGameAction *gibbon_game_get_nth_action (const GibbonGame *self,
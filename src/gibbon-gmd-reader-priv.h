@@ -94,9 +94,9 @@ gboolean _gibbon_gmd_reader_setup_turn (GibbonGMDReader *self, gint64 turn);
 gboolean _gibbon_gmd_reader_setup_may_double (GibbonGMDReader *self,
                                               gint64 flag1, gint64 flag2);
 void gibbon_gmd_reader_yyerror (void *scanner, const gchar *msg);
+gsize _gibbon_gmd_reader_yyinput (gpointer self, gchar *buf, gsize max_size);
 
 
-void gibbon_gmd_lexer_set_in (FILE *input, void *yyscanner);
 int gibbon_gmd_lexer_lex_init_extra (void *self, void **yyscanner);
 int gibbon_gmd_lexer_lex_destroy (void *yyscanner);
 void *gibbon_gmd_lexer_get_extra (void *yyscanner);
@@ -48,9 +48,15 @@ struct _GibbonGMDReaderPrivate {
         gpointer user_data;
         const gchar *filename;
         void *yyscanner;
+        GInputStream *stream;
         GibbonMatch *match;
 
         GSList *names;
+
+        /* Set while peeking.  */
+        gboolean peeking;
+        gboolean peek_done;
+        gint64 start_time;
 };
 
 #define GIBBON_GMD_READER_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
@@ -60,6 +66,14 @@ G_DEFINE_TYPE (GibbonGMDReader, gibbon_gmd_reader, GIBBON_TYPE_MATCH_READER)
 
 static GibbonMatch *gibbon_gmd_reader_parse (GibbonMatchReader *match_reader,
                                              const gchar *filename);
+static GibbonMatch *gibbon_gmd_reader_parse_stream (GibbonMatchReader
+                                                    *match_reader,
+                                                    GInputStream *stream,
+                                                    const gchar *filename);
+static gboolean gibbon_gmd_reader_peek (GibbonMatchReader *match_reader,
+                                        const gchar *filename,
+                                        GibbonMatchReaderInfo *info,
+                                        gboolean scores);
 static gboolean gibbon_gmd_reader_add_action (GibbonGMDReader *self,
                                               GibbonPositionSide side,
                                               gint64 timestamp,
@@ -78,8 +92,14 @@ gibbon_gmd_reader_init (GibbonGMDReader *self)
 
         /* Per parser-instance data.  */
         self->priv->filename = NULL;
+        self->priv->yyscanner = NULL;
+        self->priv->stream = NULL;
         self->priv->match = NULL;
         self->priv->names = NULL;
+
+        self->priv->peeking = FALSE;
+        self->priv->peek_done = FALSE;
+        self->priv->start_time = G_MININT64;
 }
 
 static void
@@ -100,6 +120,9 @@ gibbon_gmd_reader_class_init (GibbonGMDReaderClass *klass)
                         GIBBON_MATCH_READER_CLASS (klass);
 
         gibbon_match_reader_class->parse = gibbon_gmd_reader_parse;
+        gibbon_match_reader_class->parse_stream =
+                gibbon_gmd_reader_parse_stream;
+        gibbon_match_reader_class->peek = gibbon_gmd_reader_peek;
         
         g_type_class_add_private (klass, sizeof (GibbonGMDReaderPrivate));
 
@@ -132,11 +155,40 @@ static GibbonMatch *
 gibbon_gmd_reader_parse (GibbonMatchReader *_self, const gchar *filename)
 {
         GibbonGMDReader *self;
-        FILE *in;
+        GInputStream *stream;
+        GibbonMatch *match;
+        GError *error = NULL;
+
+        g_return_val_if_fail (GIBBON_IS_GMD_READER (_self), NULL);
+        self = GIBBON_GMD_READER (_self);
+
+        /* Compressed files are transparently decompressed.  */
+        stream = gibbon_match_reader_open (filename, &error);
+        if (!stream) {
+                self->priv->filename = filename;
+                gibbon_gmd_reader_error (self, error->message);
+                self->priv->filename = NULL;
+                g_error_free (error);
+                return NULL;
+        }
+
+        match = gibbon_gmd_reader_parse_stream (_self, stream, filename);
+        g_object_unref (stream);
+
+        return match;
+}
+
+static GibbonMatch *
+gibbon_gmd_reader_parse_stream (GibbonMatchReader *_self, GInputStream *stream,
+                                const gchar *filename)
+{
+        GibbonGMDReader *self;
         int parse_status;
         void *yyscanner;
+        GibbonMatch *match;
 
         g_return_val_if_fail (GIBBON_IS_GMD_READER (_self), NULL);
+        g_return_val_if_fail (G_IS_INPUT_STREAM (stream), NULL);
         self = GIBBON_GMD_READER (_self);
 
         if (gibbon_gmd_lexer_lex_init_extra (self, &yyscanner)) {
@@ -148,38 +200,91 @@ gibbon_gmd_reader_parse (GibbonMatchReader *_self, const gchar *filename)
 
         self->priv->filename = filename;
         self->priv->yyscanner = yyscanner;
-        if (self->priv->match)
-                g_object_unref (self->priv->match);
+        self->priv->stream = stream;
         self->priv->match = gibbon_match_new (NULL, NULL, 0, FALSE);
         _gibbon_gmd_reader_free_names (self);
 
-        if (filename)
-                in = fopen (filename, "rb");
-        else
-                in = stdin;
-
-        if (in) {
-                gibbon_gmd_lexer_set_in (in, yyscanner);
-
-                parse_status = gibbon_gmd_parser_parse (yyscanner);
-                if (filename)
-                        fclose (in);
-                if (parse_status) {
-                        g_object_unref (self->priv->match);
-                        self->priv->match = NULL;
-                }
-        } else {
+        parse_status = gibbon_gmd_parser_parse (yyscanner);
+        if (parse_status && !self->priv->peek_done) {
                 g_object_unref (self->priv->match);
                 self->priv->match = NULL;
-                gibbon_gmd_reader_error (self, strerror (errno));
         }
 
         self->priv->filename = NULL;
         self->priv->yyscanner = NULL;
+        self->priv->stream = NULL;
 
         gibbon_gmd_lexer_lex_destroy (yyscanner);
 
-        return self->priv->match;
+        /* The caller owns the match.  */
+        match = self->priv->match;
+        self->priv->match = NULL;
+
+        return match;
+}
+
+/*
+ * The scanner reads its input through this function instead of stdio.
+ * Read errors are reported like syntax errors, and end the input.
+ */
+gsize
+_gibbon_gmd_reader_yyinput (gpointer _self, gchar *buf, gsize max_size)
+{
+        GibbonGMDReader *self = (GibbonGMDReader *) _self;
+        gssize read_bytes;
+        GError *error = NULL;
+
+        read_bytes = g_input_stream_read (self->priv->stream, buf, max_size,
+                                          NULL, &error);
+        if (read_bytes < 0) {
+                gibbon_gmd_reader_error (self, error->message);
+                g_error_free (error);
+                return 0;
+        }
+
+        return read_bytes;
+}
+
+static gboolean
+gibbon_gmd_reader_peek (GibbonMatchReader *_self, const gchar *filename,
+                        GibbonMatchReaderInfo *info, gboolean scores)
+{
+        GibbonGMDReader *self;
+        GibbonMatch *match;
+        GibbonMatchReaderClass *parent_class =
+                GIBBON_MATCH_READER_CLASS (gibbon_gmd_reader_parent_class);
+
+        g_return_val_if_fail (GIBBON_IS_GMD_READER (_self), FALSE);
+        self = GIBBON_GMD_READER (_self);
+
+        /*
+         * GMD does not record the outcome of a game.  The score can only
+         * be calculated by replaying all actions.
+         */
+        if (scores)
+                return parent_class->peek (_self, filename, info, scores);
+
+        /*
+         * Everything else is found in the header.  The first action is only
+         * needed for the start time, and parsing stops there.
+         */
+        self->priv->peeking = TRUE;
+        self->priv->peek_done = FALSE;
+        self->priv->start_time = G_MININT64;
+
+        match = gibbon_gmd_reader_parse (_self, filename);
+
+        self->priv->peeking = FALSE;
+        self->priv->peek_done = FALSE;
+
+        if (!match)
+                return FALSE;
+
+        gibbon_match_reader_info_from_match (info, match, FALSE);
+        info->start_time = self->priv->start_time;
+        g_object_unref (match);
+
+        return TRUE;
 }
 
 static void
@@ -195,7 +300,11 @@ gibbon_gmd_reader_error (const GibbonGMDReader *self, const gchar *msg)
         else
                 filename = _("[standard input]");
 
-        lineno = gibbon_gmd_lexer_get_lineno (self->priv->yyscanner);
+        /* The input may fail to open before a scanner exists.  */
+        if (self->priv->yyscanner)
+                lineno = gibbon_gmd_lexer_get_lineno (self->priv->yyscanner);
+        else
+                lineno = 0;
 
         if (lineno)
                 full_msg = g_strdup_printf ("%s:%d: %s", filename, lineno, msg);
@@ -519,6 +628,14 @@ gibbon_gmd_reader_add_action (GibbonGMDReader *self, GibbonPositionSide side,
         GibbonGame *game;
         GError *error = NULL;
 
+        if (self->priv->peeking) {
+                /* Abort the parser.  The header is complete.  */
+                self->priv->start_time = timestamp;
+                self->priv->peek_done = TRUE;
+                g_object_unref (action);
+                return FALSE;
+        }
+
         game = gibbon_match_get_current_game (self->priv->match);
         if (!game) {
                 gibbon_gmd_reader_error (self, _("No game in progress!"));
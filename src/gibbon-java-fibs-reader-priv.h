@@ -70,7 +70,8 @@ void gibbon_java_fibs_reader_free_names (GibbonJavaFIBSReader *self);
 
 int gibbon_java_fibs_lexer_get_lineno (void *);
 void gibbon_java_fibs_reader_yyerror (void *scanner, const gchar *msg);
-void gibbon_java_fibs_lexer_set_in (FILE *input, void *yyscanner);
+gsize _gibbon_java_fibs_reader_yyinput (gpointer self, gchar *buf,
+                                        gsize max_size);
 int gibbon_java_fibs_lexer_lex_init_extra (void *self, void **yyscanner);
 int gibbon_java_fibs_lexer_lex_destroy (void *yyscanner);
 void *gibbon_java_fibs_lexer_get_extra (void *yyscanner);
@@ -47,11 +47,18 @@ struct _GibbonJavaFIBSReaderPrivate {
         gpointer user_data;
         const gchar *filename;
         void *yyscanner;
+        GInputStream *stream;
         GibbonMatch *match;
 
         GSList *names;
 
         gchar *white;
+
+        /* Set while peeking.  */
+        gboolean peeking;
+        gboolean peek_scores;
+        gboolean peek_done;
+        guint scores[2];
 };
 
 #define GIBBON_JAVA_FIBS_READER_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
@@ -61,6 +68,14 @@ G_DEFINE_TYPE (GibbonJavaFIBSReader, gibbon_java_fibs_reader, GIBBON_TYPE_MATCH_
 
 static GibbonMatch *gibbon_java_fibs_reader_parse (GibbonMatchReader *match_reader,
                                                    const gchar *filename);
+static GibbonMatch *gibbon_java_fibs_reader_parse_stream (GibbonMatchReader
+                                                          *match_reader,
+                                                          GInputStream *stream,
+                                                          const gchar *filename);
+static gboolean gibbon_java_fibs_reader_peek (GibbonMatchReader *match_reader,
+                                              const gchar *filename,
+                                              GibbonMatchReaderInfo *info,
+                                              gboolean scores);
 static gboolean gibbon_java_fibs_reader_add_action (GibbonJavaFIBSReader *self,
                                                     const gchar *name,
                                                     GibbonGameAction *action);
@@ -78,9 +93,16 @@ gibbon_java_fibs_reader_init (GibbonJavaFIBSReader *self)
 
         /* Per parser-instance data.  */
         self->priv->filename = NULL;
+        self->priv->yyscanner = NULL;
+        self->priv->stream = NULL;
         self->priv->match = NULL;
         self->priv->names = NULL;
         self->priv->white = NULL;
+
+        self->priv->peeking = FALSE;
+        self->priv->peek_scores = FALSE;
+        self->priv->peek_done = FALSE;
+        self->priv->scores[0] = self->priv->scores[1] = 0;
 }
 
 static void
@@ -101,6 +123,9 @@ gibbon_java_fibs_reader_class_init (GibbonJavaFIBSReaderClass *klass)
                         GIBBON_MATCH_READER_CLASS (klass);
 
         gibbon_match_reader_class->parse = gibbon_java_fibs_reader_parse;
+        gibbon_match_reader_class->parse_stream =
+                gibbon_java_fibs_reader_parse_stream;
+        gibbon_match_reader_class->peek = gibbon_java_fibs_reader_peek;
         
         g_type_class_add_private (klass, sizeof (GibbonJavaFIBSReaderPrivate));
 
@@ -133,11 +158,41 @@ static GibbonMatch *
 gibbon_java_fibs_reader_parse (GibbonMatchReader *_self, const gchar *filename)
 {
         GibbonJavaFIBSReader *self;
-        FILE *in;
+        GInputStream *stream;
+        GibbonMatch *match;
+        GError *error = NULL;
+
+        g_return_val_if_fail (GIBBON_IS_JAVA_FIBS_READER (_self), NULL);
+        self = GIBBON_JAVA_FIBS_READER (_self);
+
+        /* Compressed files are transparently decompressed.  */
+        stream = gibbon_match_reader_open (filename, &error);
+        if (!stream) {
+                self->priv->filename = filename;
+                gibbon_java_fibs_reader_error (self, error->message);
+                self->priv->filename = NULL;
+                g_error_free (error);
+                return NULL;
+        }
+
+        match = gibbon_java_fibs_reader_parse_stream (_self, stream, filename);
+        g_object_unref (stream);
+
+        return match;
+}
+
+static GibbonMatch *
+gibbon_java_fibs_reader_parse_stream (GibbonMatchReader *_self,
+                                      GInputStream *stream,
+                                      const gchar *filename)
+{
+        GibbonJavaFIBSReader *self;
         int parse_status;
         void *yyscanner;
+        GibbonMatch *match;
 
         g_return_val_if_fail (GIBBON_IS_JAVA_FIBS_READER (_self), NULL);
+        g_return_val_if_fail (G_IS_INPUT_STREAM (stream), NULL);
         self = GIBBON_JAVA_FIBS_READER (_self);
 
         if (gibbon_java_fibs_lexer_lex_init_extra (self, &yyscanner)) {
@@ -149,40 +204,23 @@ gibbon_java_fibs_reader_parse (GibbonMatchReader *_self, const gchar *filename)
 
         self->priv->filename = filename;
         self->priv->yyscanner = yyscanner;
-        if (self->priv->match)
-                g_object_unref (self->priv->match);
+        self->priv->stream = stream;
         self->priv->match = gibbon_match_new (NULL, NULL, 0, FALSE);
         gibbon_java_fibs_reader_free_names (self);
         g_free (self->priv->white);
         self->priv->white = NULL;
 
-        if (filename)
-                in = fopen (filename, "rb");
-        else
-                in = stdin;
-        if (in) {
-                gibbon_java_fibs_lexer_set_in (in, yyscanner);
-
-                parse_status = gibbon_java_fibs_parser_parse (yyscanner);
-
-                if (filename)
-                        fclose (in);
-                if (parse_status) {
-                        g_object_unref (self->priv->match);
-                        self->priv->match = NULL;
-                        g_free (self->priv->white);
-                        self->priv->white = NULL;
-                }
-        } else {
+        parse_status = gibbon_java_fibs_parser_parse (yyscanner);
+        if (parse_status && !self->priv->peek_done) {
                 g_object_unref (self->priv->match);
                 self->priv->match = NULL;
                 g_free (self->priv->white);
                 self->priv->white = NULL;
-                gibbon_java_fibs_reader_error (self, strerror (errno));
         }
 
         self->priv->filename = NULL;
         self->priv->yyscanner = NULL;
+        self->priv->stream = NULL;
 
         gibbon_java_fibs_lexer_lex_destroy (yyscanner);
 
@@ -191,7 +229,72 @@ gibbon_java_fibs_reader_parse (GibbonMatchReader *_self, const gchar *filename)
         g_free (self->priv->white);
         self->priv->white = NULL;
 
-        return self->priv->match;
+        /* The caller owns the match.  */
+        match = self->priv->match;
+        self->priv->match = NULL;
+
+        return match;
+}
+
+/*
+ * The scanner reads its input through this function instead of stdio.
+ * Read errors are reported like syntax errors, and end the input.
+ */
+gsize
+_gibbon_java_fibs_reader_yyinput (gpointer _self, gchar *buf, gsize max_size)
+{
+        GibbonJavaFIBSReader *self = (GibbonJavaFIBSReader *) _self;
+        gssize read_bytes;
+        GError *error = NULL;
+
+        read_bytes = g_input_stream_read (self->priv->stream, buf, max_size,
+                                          NULL, &error);
+        if (read_bytes < 0) {
+                gibbon_java_fibs_reader_error (self, error->message);
+                g_error_free (error);
+                return 0;
+        }
+
+        return read_bytes;
+}
+
+static gboolean
+gibbon_java_fibs_reader_peek (GibbonMatchReader *_self, const gchar *filename,
+                              GibbonMatchReaderInfo *info, gboolean scores)
+{
+        GibbonJavaFIBSReader *self;
+        GibbonMatch *match;
+
+        g_return_val_if_fail (GIBBON_IS_JAVA_FIBS_READER (_self), FALSE);
+        self = GIBBON_JAVA_FIBS_READER (_self);
+
+        /*
+         * Games and actions are skipped.  If the score is requested, we
+         * simply add up the points from the "win game" lines.
+         */
+        self->priv->peeking = TRUE;
+        self->priv->peek_scores = scores;
+        self->priv->peek_done = FALSE;
+        self->priv->scores[0] = self->priv->scores[1] = 0;
+
+        match = gibbon_java_fibs_reader_parse (_self, filename);
+
+        self->priv->peeking = FALSE;
+        self->priv->peek_scores = FALSE;
+        self->priv->peek_done = FALSE;
+
+        if (!match)
+                return FALSE;
+
+        gibbon_match_reader_info_from_match (info, match, FALSE);
+        info->start_time = G_MININT64;
+        if (scores) {
+                info->scores[0] = self->priv->scores[0];
+                info->scores[1] = self->priv->scores[1];
+        }
+        g_object_unref (match);
+
+        return TRUE;
 }
 
 static void
@@ -207,7 +310,12 @@ gibbon_java_fibs_reader_error (const GibbonJavaFIBSReader *self,
         else
                 filename = _("[standard input]");
 
-        lineno = gibbon_java_fibs_lexer_get_lineno (self->priv->yyscanner);
+        /* The input may fail to open before a scanner exists.  */
+        if (self->priv->yyscanner)
+                lineno = gibbon_java_fibs_lexer_get_lineno (
+                                self->priv->yyscanner);
+        else
+                lineno = 0;
 
         if (lineno)
                 full_msg = g_strdup_printf ("%s:%d: %s", filename, lineno, msg);
@@ -276,6 +384,9 @@ _gibbon_java_fibs_reader_add_game (GibbonJavaFIBSReader *self)
         g_return_val_if_fail (GIBBON_IS_JAVA_FIBS_READER (self), FALSE);
         g_return_val_if_fail (self->priv->match, FALSE);
 
+        if (self->priv->peeking)
+                return TRUE;
+
         if (!gibbon_match_add_game (self->priv->match, &error)) {
                 gibbon_java_fibs_reader_error (self, error->message);
                 g_error_free (error);
@@ -406,6 +517,16 @@ _gibbon_java_fibs_reader_win_game (GibbonJavaFIBSReader *self,
         g_return_val_if_fail (GIBBON_IS_JAVA_FIBS_READER (self), FALSE);
         g_return_val_if_fail (self->priv->match, FALSE);
 
+        if (self->priv->peeking) {
+                /* The name of black is always given literally.  */
+                if (0 == g_strcmp0 (name,
+                                    gibbon_match_get_black (self->priv->match)))
+                        self->priv->scores[1] += points;
+                else
+                        self->priv->scores[0] += points;
+                return TRUE;
+        }
+
         game = gibbon_match_get_current_game (self->priv->match);
         if (!game) {
                 gibbon_java_fibs_reader_error (self, _("Syntax error!"));
@@ -461,8 +582,9 @@ _gibbon_java_fibs_reader_resign (GibbonJavaFIBSReader *self,
         g_return_val_if_fail (self->priv->match, FALSE);
         g_return_val_if_fail (points != 0, FALSE);
 
+        /* No games while peeking.  */
         game = gibbon_match_get_current_game (self->priv->match);
-        if (!game) {
+        if (!game && !self->priv->peeking) {
                 gibbon_java_fibs_reader_error (self, _("Syntax error!"));
                 return TRUE;
         }
@@ -501,6 +623,16 @@ gibbon_java_fibs_reader_add_action (GibbonJavaFIBSReader *self,
         GibbonGameAction *reject;
         gint last_side;
 
+        if (self->priv->peeking) {
+                g_object_unref (action);
+                if (self->priv->peek_scores)
+                        return TRUE;
+
+                /* Abort the parser.  Everything we need is known.  */
+                self->priv->peek_done = TRUE;
+                return FALSE;
+        }
+
         game = gibbon_match_get_current_game (self->priv->match);
         if (!game) {
                 gibbon_java_fibs_reader_error (self, _("No game in progress!"));
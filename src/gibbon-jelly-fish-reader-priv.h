@@ -52,7 +52,8 @@ void gibbon_jelly_fish_reader_free_names (GibbonJellyFishReader *self);
 
 int gibbon_jelly_fish_lexer_get_lineno (void *);
 void gibbon_jelly_fish_reader_yyerror (void *scanner, const gchar *msg);
-void gibbon_jelly_fish_lexer_set_in (FILE *input, void *yyscanner);
+gsize _gibbon_jelly_fish_reader_yyinput (gpointer self, gchar *buf,
+                                         gsize max_size);
 int gibbon_jelly_fish_lexer_lex_init_extra (void *self, void **yyscanner);
 int gibbon_jelly_fish_lexer_lex_destroy (void *yyscanner);
 void *gibbon_jelly_fish_lexer_get_extra (void *yyscanner);
@@ -46,11 +46,16 @@ struct _GibbonJellyFishReaderPrivate {
         gpointer user_data;
         const gchar *filename;
         void *yyscanner;
+        GInputStream *stream;
         GibbonMatch *match;
 
         GSList *names;
 
         GibbonPositionSide side;
+
+        /* Set while peeking.  */
+        gboolean peeking;
+        gboolean peek_done;
 };
 
 GibbonJellyFishReader *_gibbon_jelly_fish_reader_instance = NULL;
@@ -62,6 +67,14 @@ G_DEFINE_TYPE (GibbonJellyFishReader, gibbon_jelly_fish_reader, GIBBON_TYPE_MATC
 
 static GibbonMatch *gibbon_jelly_fish_reader_parse (GibbonMatchReader *match_reader,
                                                    const gchar *filename);
+static GibbonMatch *gibbon_jelly_fish_reader_parse_stream (GibbonMatchReader
+                                                           *match_reader,
+                                                           GInputStream *stream,
+                                                           const gchar *filename);
+static gboolean gibbon_jelly_fish_reader_peek (GibbonMatchReader *match_reader,
+                                               const gchar *filename,
+                                               GibbonMatchReaderInfo *info,
+                                               gboolean scores);
 static gboolean gibbon_jelly_fish_reader_add_action (GibbonJellyFishReader *self,
                                                     GibbonGameAction *action);
 static void gibbon_jelly_fish_reader_error (const GibbonJellyFishReader *self,
@@ -78,9 +91,14 @@ gibbon_jelly_fish_reader_init (GibbonJellyFishReader *self)
 
         /* Per parser-instance data.  */
         self->priv->filename = NULL;
+        self->priv->yyscanner = NULL;
+        self->priv->stream = NULL;
         self->priv->match = NULL;
         self->priv->names = NULL;
         self->priv->side = GIBBON_POSITION_SIDE_NONE;
+
+        self->priv->peeking = FALSE;
+        self->priv->peek_done = FALSE;
 }
 
 static void
@@ -101,6 +119,9 @@ gibbon_jelly_fish_reader_class_init (GibbonJellyFishReaderClass *klass)
                         GIBBON_MATCH_READER_CLASS (klass);
 
         gibbon_match_reader_class->parse = gibbon_jelly_fish_reader_parse;
+        gibbon_match_reader_class->parse_stream =
+                gibbon_jelly_fish_reader_parse_stream;
+        gibbon_match_reader_class->peek = gibbon_jelly_fish_reader_peek;
         
         g_type_class_add_private (klass, sizeof (GibbonJellyFishReaderPrivate));
 
@@ -133,11 +154,41 @@ static GibbonMatch *
 gibbon_jelly_fish_reader_parse (GibbonMatchReader *_self, const gchar *filename)
 {
         GibbonJellyFishReader *self;
-        FILE *in;
+        GInputStream *stream;
+        GibbonMatch *match;
+        GError *error = NULL;
+
+        g_return_val_if_fail (GIBBON_IS_JELLY_FISH_READER (_self), NULL);
+        self = GIBBON_JELLY_FISH_READER (_self);
+
+        /* Compressed files are transparently decompressed.  */
+        stream = gibbon_match_reader_open (filename, &error);
+        if (!stream) {
+                self->priv->filename = filename;
+                gibbon_jelly_fish_reader_error (self, error->message);
+                self->priv->filename = NULL;
+                g_error_free (error);
+                return NULL;
+        }
+
+        match = gibbon_jelly_fish_reader_parse_stream (_self, stream, filename);
+        g_object_unref (stream);
+
+        return match;
+}
+
+static GibbonMatch *
+gibbon_jelly_fish_reader_parse_stream (GibbonMatchReader *_self,
+                                       GInputStream *stream,
+                                       const gchar *filename)
+{
+        GibbonJellyFishReader *self;
         int parse_status;
         void *yyscanner;
+        GibbonMatch *match;
 
         g_return_val_if_fail (GIBBON_IS_JELLY_FISH_READER (_self), NULL);
+        g_return_val_if_fail (G_IS_INPUT_STREAM (stream), NULL);
         self = GIBBON_JELLY_FISH_READER (_self);
 
         if (gibbon_jelly_fish_lexer_lex_init_extra (self, &yyscanner)) {
@@ -149,40 +200,94 @@ gibbon_jelly_fish_reader_parse (GibbonMatchReader *_self, const gchar *filename)
 
         self->priv->filename = filename;
         self->priv->yyscanner = yyscanner;
-        if (self->priv->match)
-                g_object_unref (self->priv->match);
+        self->priv->stream = stream;
         self->priv->match = gibbon_match_new (NULL, NULL, 0, FALSE);
         gibbon_jelly_fish_reader_free_names (self);
         self->priv->side = GIBBON_POSITION_SIDE_NONE;
 
-        if (filename)
-                in = fopen (filename, "rb");
-        else
-                in = stdin;
-        if (in) {
-                gibbon_jelly_fish_lexer_set_in (in, yyscanner);
-
-                parse_status = gibbon_jelly_fish_parser_parse (yyscanner);
-                if (filename)
-                        fclose (in);
-                if (parse_status) {
-                        g_object_unref (self->priv->match);
-                        self->priv->match = NULL;
-                        self->priv->side = GIBBON_POSITION_SIDE_NONE;
-                }
-        } else {
+        parse_status = gibbon_jelly_fish_parser_parse (yyscanner);
+        if (parse_status && !self->priv->peek_done) {
                 g_object_unref (self->priv->match);
                 self->priv->match = NULL;
                 self->priv->side = GIBBON_POSITION_SIDE_NONE;
-                gibbon_jelly_fish_reader_error (self, strerror (errno));
         }
 
         self->priv->filename = NULL;
+        self->priv->yyscanner = NULL;
+        self->priv->stream = NULL;
         self->priv->side = GIBBON_POSITION_SIDE_NONE;
 
         gibbon_jelly_fish_lexer_lex_destroy (yyscanner);
 
-        return self->priv->match;
+        /* The caller owns the match.  */
+        match = self->priv->match;
+        self->priv->match = NULL;
+
+        return match;
+}
+
+/*
+ * The scanner reads its input through this function instead of stdio.
+ * Read errors are reported like syntax errors, and end the input.
+ */
+gsize
+_gibbon_jelly_fish_reader_yyinput (gpointer _self, gchar *buf, gsize max_size)
+{
+        GibbonJellyFishReader *self = (GibbonJellyFishReader *) _self;
+        gssize read_bytes;
+        GError *error = NULL;
+
+        read_bytes = g_input_stream_read (self->priv->stream, buf, max_size,
+                                          NULL, &error);
+        if (read_bytes < 0) {
+                gibbon_jelly_fish_reader_error (self, error->message);
+                g_error_free (error);
+                return 0;
+        }
+
+        return read_bytes;
+}
+
+static gboolean
+gibbon_jelly_fish_reader_peek (GibbonMatchReader *_self, const gchar *filename,
+                               GibbonMatchReaderInfo *info, gboolean scores)
+{
+        GibbonJellyFishReader *self;
+        GibbonMatch *match;
+        GibbonMatchReaderClass *parent_class =
+            GIBBON_MATCH_READER_CLASS (gibbon_jelly_fish_reader_parent_class);
+
+        g_return_val_if_fail (GIBBON_IS_JELLY_FISH_READER (_self), FALSE);
+        self = GIBBON_JELLY_FISH_READER (_self);
+
+        /*
+         * The winner of a game is only given by the column of the
+         * "Wins" line.  We have to replay the match in order to get the
+         * score right.
+         */
+        if (scores)
+                return parent_class->peek (_self, filename, info, scores);
+
+        /*
+         * Length and opponents are complete before the first move.  The
+         * format has neither timestamps nor rules.
+         */
+        self->priv->peeking = TRUE;
+        self->priv->peek_done = FALSE;
+
+        match = gibbon_jelly_fish_reader_parse (_self, filename);
+
+        self->priv->peeking = FALSE;
+        self->priv->peek_done = FALSE;
+
+        if (!match)
+                return FALSE;
+
+        gibbon_match_reader_info_from_match (info, match, FALSE);
+        info->start_time = G_MININT64;
+        g_object_unref (match);
+
+        return TRUE;
 }
 
 static void
@@ -198,7 +303,12 @@ gibbon_jelly_fish_reader_error (const GibbonJellyFishReader *self,
         else
                 filename = _("[standard input]");
 
-        lineno = gibbon_jelly_fish_lexer_get_lineno (self->priv->yyscanner);
+        /* The input may fail to open before a scanner exists.  */
+        if (self->priv->yyscanner)
+                lineno = gibbon_jelly_fish_lexer_get_lineno (
+                                self->priv->yyscanner);
+        else
+                lineno = 0;
 
         if (lineno)
                 full_msg = g_strdup_printf ("%s:%d: %s", filename, lineno, msg);
@@ -470,6 +580,13 @@ gibbon_jelly_fish_reader_add_action (GibbonJellyFishReader *self,
         GibbonPositionSide side;
         GError *error = NULL;
 
+        if (self->priv->peeking) {
+                /* Abort the parser.  Everything we need is known.  */
+                self->priv->peek_done = TRUE;
+                g_object_unref (action);
+                return FALSE;
+        }
+
         g_return_val_if_fail (self->priv->side, FALSE);
 
         side = self->priv->side;
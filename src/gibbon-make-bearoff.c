@@ -0,0 +1,268 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Build-time generator for the one-sided bear-off database, see
+ * gibbon-bearoff.h.  Run "gibbon-make-bearoff OUTPUT" in order to write
+ * the table as C source code to OUTPUT.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "gibbon-bearoff.h"
+
+/* Enough for the pathological case of rolling 2-1 all the time.  */
+#define MAX_ROLLS 64
+
+typedef struct _Entry Entry;
+struct _Entry {
+        gboolean solved;
+        gdouble mean;
+        gdouble p[MAX_ROLLS];
+};
+
+static Entry *entries;
+
+static const Entry *solve (const guint counts[GIBBON_BEAROFF_POINTS]);
+static void play (guint counts[GIBBON_BEAROFF_POINTS], const guint *dice,
+                  gsize num_dice, const Entry **best);
+static void quantize (const Entry *entry, guint16 quantized[MAX_ROLLS],
+                      guint *first, guint *last);
+static gboolean emit (FILE *out);
+static void enumerate (guint counts[GIBBON_BEAROFF_POINTS], guint point,
+                       guint checkers);
+
+int
+main (int argc, char *argv[])
+{
+        FILE *out;
+        guint counts[GIBBON_BEAROFF_POINTS];
+
+        if (argc != 2) {
+                g_printerr ("Usage: %s OUTPUT\n", argv[0]);
+                return 1;
+        }
+
+        entries = g_new0 (Entry, GIBBON_BEAROFF_POSITIONS);
+        enumerate (counts, 0, GIBBON_BEAROFF_CHECKERS);
+
+        out = fopen (argv[1], "w");
+        if (!out) {
+                g_printerr ("%s: %s\n", argv[1], strerror (errno));
+                return 1;
+        }
+        if (!emit (out)) {
+                (void) fclose (out);
+                (void) remove (argv[1]);
+                return 1;
+        }
+        if (ferror (out) || fclose (out)) {
+                g_printerr ("%s: %s\n", argv[1], strerror (errno));
+                return 1;
+        }
+
+        g_free (entries);
+
+        return 0;
+}
+
+static void
+enumerate (guint counts[GIBBON_BEAROFF_POINTS], guint point, guint checkers)
+{
+        guint n;
+
+        if (point == GIBBON_BEAROFF_POINTS) {
+                (void) solve (counts);
+                return;
+        }
+
+        for (n = 0; n <= checkers; ++n) {
+                counts[point] = n;
+                enumerate (counts, point + 1, checkers - n);
+        }
+}
+
+static const Entry *
+solve (const guint counts[GIBBON_BEAROFF_POINTS])
+{
+        Entry *entry = entries + gibbon_bearoff_index (counts);
+        guint copy[GIBBON_BEAROFF_POINTS];
+        guint dice[4];
+        const Entry *best;
+        guint die1, die2;
+        gdouble weight;
+        gsize i;
+
+        if (entry->solved)
+                return entry;
+        entry->solved = TRUE;
+
+        for (i = 0; i < GIBBON_BEAROFF_POINTS && !counts[i]; ++i)
+                continue;
+        if (i == GIBBON_BEAROFF_POINTS) {
+                entry->p[0] = 1.0;
+                return entry;
+        }
+
+        for (die1 = 1; die1 <= 6; ++die1) {
+                for (die2 = die1; die2 <= 6; ++die2) {
+                        best = NULL;
+                        memcpy (copy, counts, sizeof copy);
+                        if (die1 == die2) {
+                                dice[0] = dice[1] = dice[2] = dice[3] = die1;
+                                play (copy, dice, 4, &best);
+                                weight = 1.0 / 36.0;
+                        } else {
+                                dice[0] = die1;
+                                dice[1] = die2;
+                                play (copy, dice, 2, &best);
+                                dice[0] = die2;
+                                dice[1] = die1;
+                                play (copy, dice, 2, &best);
+                                weight = 2.0 / 36.0;
+                        }
+                        for (i = 0; i + 1 < MAX_ROLLS; ++i)
+                                entry->p[i + 1] += weight * best->p[i];
+                }
+        }
+
+        for (i = 0; i < MAX_ROLLS; ++i)
+                entry->mean += i * entry->p[i];
+
+        return entry;
+}
+
+/*
+ * All checkers are in the home board.  Therefore, every die can be used
+ * until all checkers are borne off.
+ */
+static void
+play (guint counts[GIBBON_BEAROFF_POINTS], const guint *dice,
+      gsize num_dice, const Entry **best)
+{
+        const Entry *entry;
+        guint die, highest, point;
+
+        for (highest = GIBBON_BEAROFF_POINTS; highest > 0; --highest)
+                if (counts[highest - 1])
+                        break;
+
+        if (!num_dice || !highest) {
+                entry = solve (counts);
+                if (!*best || entry->mean < (*best)->mean)
+                        *best = entry;
+                return;
+        }
+
+        die = dice[0];
+        for (point = 1; point <= highest; ++point) {
+                if (!counts[point - 1])
+                        continue;
+                if (point < die && point != highest)
+                        continue;
+
+                --counts[point - 1];
+                if (point > die)
+                        ++counts[point - die - 1];
+                play (counts, dice + 1, num_dice - 1, best);
+                if (point > die)
+                        --counts[point - die - 1];
+                ++counts[point - 1];
+        }
+}
+
+static void
+quantize (const Entry *entry, guint16 quantized[MAX_ROLLS],
+          guint *first, guint *last)
+{
+        gsize i;
+
+        *first = MAX_ROLLS;
+        *last = 0;
+        for (i = 0; i < MAX_ROLLS; ++i) {
+                quantized[i] = entry->p[i] * GIBBON_BEAROFF_ONE + 0.5;
+                if (!quantized[i])
+                        continue;
+                if (*first == MAX_ROLLS)
+                        *first = i;
+                *last = i;
+        }
+}
+
+static gboolean
+emit (FILE *out)
+{
+        guint32 offset = 0;
+        guint16 quantized[MAX_ROLLS];
+        guint first, last;
+        gsize n, i;
+        guint column = 0;
+
+        fprintf (out, "/* Generated by gibbon-make-bearoff.  Do not edit!  */"
+                 "\n\n#include \"gibbon-bearoff.h\"\n\n");
+
+        fprintf (out, "const guint32 gibbon_bearoff_offsets["
+                 "GIBBON_BEAROFF_POSITIONS] = {\n");
+        for (n = 0; n < GIBBON_BEAROFF_POSITIONS; ++n) {
+                if (!entries[n].solved) {
+                        g_printerr ("Position %u was not solved.\n",
+                                    (guint) n);
+                        return FALSE;
+                }
+                quantize (entries + n, quantized, &first, &last);
+                if (last >= GIBBON_BEAROFF_MAX_ROLLS) {
+                        g_printerr ("Position %u needs more than %u"
+                                    " rolls.\n", (guint) n,
+                                    GIBBON_BEAROFF_MAX_ROLLS);
+                        return FALSE;
+                }
+                fprintf (out, "%s%u,", n % 8 ? " " : "\t", offset);
+                if (n % 8 == 7)
+                        fprintf (out, "\n");
+                offset += 2 + 2 * (last - first + 1);
+        }
+        fprintf (out, "\n};\n\n");
+
+        fprintf (out, "const guint8 gibbon_bearoff_data[] = {\n");
+        for (n = 0; n < GIBBON_BEAROFF_POSITIONS; ++n) {
+                quantize (entries + n, quantized, &first, &last);
+                fprintf (out, "\t%u, %u,", first, last - first + 1);
+                column = 0;
+                for (i = first; i <= last; ++i) {
+                        if (column++ == 6) {
+                                fprintf (out, "\n\t");
+                                column = 1;
+                        }
+                        fprintf (out, " %u, %u,", quantized[i] & 0xff,
+                                 quantized[i] >> 8);
+                }
+                fprintf (out, "\n");
+        }
+        fprintf (out, "};\n");
+
+        return TRUE;
+}
@@ -52,6 +52,12 @@ struct _GibbonMatchListPrivate {
         GtkListStore *games;
         gint active;
         GtkListStore *moves;
+
+        /* Defer filling the moves store while loading a match.  */
+        gboolean loading;
+
+        GibbonMatch *match;
+        gulong actions_appended_handler;
 };
 
 #define GIBBON_MATCH_LIST_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), \
@@ -59,6 +65,10 @@ struct _GibbonMatchListPrivate {
 
 G_DEFINE_TYPE (GibbonMatchList, gibbon_match_list, G_TYPE_OBJECT)
 
+static void gibbon_match_list_on_actions_appended (GibbonMatchList *self,
+                                                   const GibbonMatchRange
+                                                   *range,
+                                                   GibbonMatch *match);
 static gchar *gibbon_match_list_format_roll (GibbonMatchList *self,
                                              GibbonRoll *roll);
 static gchar *gibbon_match_list_format_move (GibbonMatchList *self,
@@ -80,6 +90,10 @@ gibbon_match_list_init (GibbonMatchList *self)
         self->priv->games = NULL;
         self->priv->active = -1;
         self->priv->moves = NULL;
+        self->priv->loading = FALSE;
+
+        self->priv->match = NULL;
+        self->priv->actions_appended_handler = 0;
 }
 
 static void
@@ -87,6 +101,13 @@ gibbon_match_list_finalize (GObject *object)
 {
         GibbonMatchList *self = GIBBON_MATCH_LIST (object);
 
+        if (self->priv->match) {
+                g_signal_handler_disconnect (
+                                self->priv->match,
+                                self->priv->actions_appended_handler);
+                g_object_unref (self->priv->match);
+        }
+
         if (self->priv->games)
                 g_object_unref (self->priv->games);
         if (self->priv->moves)
@@ -177,8 +198,26 @@ gibbon_match_list_on_new_match (GibbonMatchList *self,
         g_return_if_fail (GIBBON_IS_MATCH_LIST (self));
         g_return_if_fail (GIBBON_IS_MATCH (match));
 
+        if (self->priv->match) {
+                g_signal_handler_disconnect (
+                                self->priv->match,
+                                self->priv->actions_appended_handler);
+                g_object_unref (self->priv->match);
+        }
+        self->priv->match = g_object_ref ((gpointer) match);
+        self->priv->actions_appended_handler =
+                g_signal_connect_swapped (
+                        G_OBJECT (match), "actions-appended",
+                        (GCallback) gibbon_match_list_on_actions_appended,
+                        self);
+
         self->priv->active = -1;
 
+        /*
+         * Every added game gets selected by the game list view.  Only the
+         * moves of the last one have to be listed.
+         */
+        self->priv->loading = TRUE;
         gtk_list_store_clear (self->priv->games);
         num_games = gibbon_match_get_number_of_games (match);
 
@@ -187,6 +226,72 @@ gibbon_match_list_on_new_match (GibbonMatchList *self,
                 game = gibbon_match_get_nth_game (match, i);
                 gibbon_match_list_add_game (self, game);
         }
+        self->priv->loading = FALSE;
+
+        gibbon_match_list_set_active_game (self, self->priv->active);
+}
+
+/*
+ * Actions are only appended to the last game of a match.  New games are
+ * selected, and that fills the moves store completely.  Otherwise, only
+ * the new actions are listed.  The move list view is detached from the
+ * store while more than one row changes, so that it does not scroll and
+ * update the board for every single row.
+ */
+static void
+gibbon_match_list_on_actions_appended (GibbonMatchList *self,
+                                       const GibbonMatchRange *range,
+                                       GibbonMatch *match)
+{
+        gsize num_games, listed, i;
+        gsize num_actions, num_new;
+        gint first;
+        const GibbonGame *game;
+
+        g_return_if_fail (GIBBON_IS_MATCH_LIST (self));
+        g_return_if_fail (GIBBON_IS_MATCH (match));
+        g_return_if_fail (range != NULL);
+
+        num_games = gibbon_match_get_number_of_games (match);
+        listed = gtk_tree_model_iter_n_children (
+                        GTK_TREE_MODEL (self->priv->games), NULL);
+
+        if (num_games > listed) {
+                self->priv->loading = TRUE;
+                for (i = listed; i < num_games; ++i) {
+                        self->priv->active = i;
+                        game = gibbon_match_get_nth_game (match, i);
+                        gibbon_match_list_add_game (self, game);
+                }
+                self->priv->loading = FALSE;
+
+                gibbon_match_list_set_active_game (self, num_games - 1);
+                return;
+        }
+
+        if (!num_games || self->priv->active != num_games - 1)
+                return;
+
+        game = gibbon_match_get_nth_game (match, num_games - 1);
+        num_actions = gibbon_game_get_num_actions (game);
+
+        /* Locate the first new action without walking the game.  */
+        if (!gibbon_match_seek (match, range->from, NULL, &first))
+                return;
+        if (first < 0)
+                first = 0;
+        num_new = num_actions - first;
+
+        if (num_new > 1)
+                g_signal_emit (self, gibbon_match_list_signals[GAME_UPDATING],
+                               0, self);
+        for (i = first; i < num_actions; ++i) {
+                if (!gibbon_match_list_add_action (self, game, i))
+                        break;
+        }
+        if (num_new > 1)
+                g_signal_emit (self, gibbon_match_list_signals[GAME_SELECTED],
+                               0, self);
 }
 
 GtkListStore *
@@ -215,6 +320,9 @@ gibbon_match_list_set_active_game (GibbonMatchList *self, gint active)
 
         g_return_if_fail (GIBBON_IS_MATCH_LIST (self));
 
+        if (self->priv->loading)
+                return;
+
         gtk_list_store_clear (self->priv->moves);
 
         if (active < 0)
@@ -40,9 +40,11 @@
 
 G_DEFINE_TYPE (GibbonMatchLoader, gibbon_match_loader, G_TYPE_OBJECT)
 
+static gboolean gibbon_match_loader_sniff (GBufferedInputStream *stream,
+                                           gchar *first, GError **error);
 static GibbonMatchReader *gibbon_match_loader_get_reader (
                 const GibbonMatchLoader *self,
-                const gchar *filename, GError **error);
+                gchar first, GError **error);
 static void gibbon_match_loader_yyerror (GError **error, const gchar *msg);
 
 static void 
@@ -84,68 +86,89 @@ gibbon_match_loader_read_match (GibbonMatchLoader *self,
                                 const gchar *filename,
                                 GError **error)
 {
+        GInputStream *in;
+        GBufferedInputStream *stream;
+        gchar first;
         GibbonMatchReader *reader;
         GibbonMatch *match;
 
         g_return_val_if_fail (GIBBON_IS_MATCH_LOADER (self), NULL);
 
-        reader = gibbon_match_loader_get_reader (self, filename, error);
-        if (!reader)
+        /* Compressed files are transparently decompressed.  */
+        in = gibbon_match_reader_open (filename, error);
+        if (!in)
                 return NULL;
 
-        match = gibbon_match_reader_parse (reader, filename);
-        if (!match)
+        /*
+         * The file is opened only once.  The format is guessed from the
+         * buffered data, and the same stream is then handed to the reader.
+         */
+        stream = G_BUFFERED_INPUT_STREAM (g_buffered_input_stream_new (in));
+        g_object_unref (in);
+
+        if (!gibbon_match_loader_sniff (stream, &first, error)) {
+                g_object_unref (stream);
                 return NULL;
+        }
+
+        reader = gibbon_match_loader_get_reader (self, first, error);
+        match = gibbon_match_reader_parse_stream (reader,
+                                                  G_INPUT_STREAM (stream),
+                                                  filename);
+        g_object_unref (reader);
+        g_object_unref (stream);
 
         return match;
 }
 
-static GibbonMatchReader *
-gibbon_match_loader_get_reader (const GibbonMatchLoader *self,
-                                const gchar *filename, GError **error)
+/*
+ * Find the first non-whitespace character of the input without consuming
+ * it.  The buffer grows as long as it contains nothing but whitespace.
+ */
+static gboolean
+gibbon_match_loader_sniff (GBufferedInputStream *stream, gchar *first,
+                           GError **error)
 {
-        GFile *file;
-        GInputStream *stream;
+        const gchar *buffer;
+        gsize available;
+        gsize i = 0;
         gssize read_bytes;
-        gchar first;
-        GibbonMatchReader *reader;
-
-        /*
-         * FIXME! We should figure out how to interface a GInputStream with
-         * a flex generated scanner.  Then we could open the input file
-         * once, guess the format, rewind it to the start, and parse.
-         *
-         * Until then we have to live with this ugly solution.
-         */
-
-        file = g_file_new_for_path (filename);
-        stream = G_INPUT_STREAM (g_file_read (file, NULL, error));
-        g_object_unref (file);
-
-        if (!stream) {
-                g_object_unref (file);
-                return NULL;
-        }
 
         while (1) {
-                read_bytes = g_input_stream_read (stream, &first, 1, NULL, error);
-                if (read_bytes < 0) {
-                        g_object_unref (stream);
-                        return NULL;
+                buffer = g_buffered_input_stream_peek_buffer (stream,
+                                                              &available);
+                for (; i < available; ++i) {
+                        if (buffer[i] >= 0x09 && buffer[i] <= 0x0d)
+                                continue;
+                        if (buffer[i] != ' ') {
+                                *first = buffer[i];
+                                return TRUE;
+                        }
                 }
 
+                if (available
+                    == g_buffered_input_stream_get_buffer_size (stream))
+                        g_buffered_input_stream_set_buffer_size (stream,
+                                                                 2 * available);
+
+                read_bytes = g_buffered_input_stream_fill (stream, -1, NULL,
+                                                           error);
+                if (read_bytes < 0)
+                        return FALSE;
+
                 if (!read_bytes) {
                         g_set_error_literal (error, GIBBON_ERROR, -1,
                                              _("Premature end of input file!"));
-                        g_object_unref (stream);
-                        return NULL;
+                        return FALSE;
                 }
-
-                if (first >= 0x09 && first <= 0x0d)
-                        continue;
-                if (first != ' ')
-                        break;
         }
+}
+
+static GibbonMatchReader *
+gibbon_match_loader_get_reader (const GibbonMatchLoader *self, gchar first,
+                                GError **error)
+{
+        GibbonMatchReader *reader;
 
         switch (first) {
         case 'G':
@@ -174,8 +197,6 @@ gibbon_match_loader_get_reader (const GibbonMatchLoader *self,
                 break;
         }
 
-        g_object_unref (stream);
-
         return reader;
 }
 
@@ -0,0 +1,36 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify 
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GIBBON_MATCH_PRIV_H
+# define _GIBBON_MATCH_PRIV_H
+
+#include "gibbon-match.h"
+
+G_BEGIN_DECLS
+
+gboolean _gibbon_match_get_missing_actions_bounded (const GibbonMatch *self,
+                                                    const GibbonPosition
+                                                    *target,
+                                                    GSList **result,
+                                                    gsize max_steps);
+gboolean _gibbon_match_guess_detects_loop (const GibbonPosition *position);
+
+G_END_DECLS
+
+#endif
@@ -25,16 +25,37 @@
  *
  * A #GibbonMatchReader is the abstract base class for readers of the
  * individual formats supported by Gibbon.
+ *
+ * Callers that only need the players, the match length, the start time,
+ * the rule, or the score of a match should use gibbon_match_reader_peek()
+ * instead of gibbon_match_reader_parse().  Readers stop reading as soon as
+ * the requested information is complete, or skip parts of the input that
+ * are not needed for it.
  */
 
+#include <string.h>
+
 #include <glib.h>
 #include <glib/gi18n.h>
+#include <gio/gio.h>
+#ifdef G_OS_WIN32
+# include <windows.h>
+# include <gio/gwin32inputstream.h>
+#else
+# include <gio/gunixinputstream.h>
+#endif
 
 #include "gibbon-match-reader.h"
 #include "gibbon-match.h"
 
 G_DEFINE_TYPE (GibbonMatchReader, gibbon_match_reader, G_TYPE_OBJECT)
 
+static gboolean gibbon_match_reader_real_peek (GibbonMatchReader *self,
+                                               const gchar *filename,
+                                               GibbonMatchReaderInfo *info,
+                                               gboolean scores);
+static GInputStream *gibbon_match_reader_map (const gchar *filename);
+
 static void 
 gibbon_match_reader_init (GibbonMatchReader *self)
 {
@@ -52,6 +73,8 @@ gibbon_match_reader_class_init (GibbonMatchReaderClass *klass)
         GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
         klass->parse = NULL;
+        klass->parse_stream = NULL;
+        klass->peek = gibbon_match_reader_real_peek;
 
         object_class->finalize = gibbon_match_reader_finalize;
 }
@@ -65,3 +88,234 @@ gibbon_match_reader_parse (GibbonMatchReader *self, const gchar *filename)
 
         return GIBBON_MATCH_READER_GET_CLASS(self)->parse (self, filename);
 }
+
+/**
+ * gibbon_match_reader_parse_stream:
+ * @self: The #GibbonMatchReader.
+ * @stream: The #GInputStream to read from.
+ * @filename: The name of the input for messages or %NULL.
+ *
+ * Parse a match from an already opened stream.  The stream is read from
+ * its current position but not closed.  This allows to read from memory,
+ * or from a stream that has already been inspected.
+ *
+ * Returns: The #GibbonMatch, owned by the caller, or %NULL in case of
+ *          failure.
+ */
+GibbonMatch *
+gibbon_match_reader_parse_stream (GibbonMatchReader *self,
+                                  GInputStream *stream,
+                                  const gchar *filename)
+{
+        g_return_val_if_fail (GIBBON_IS_MATCH_READER (self), NULL);
+        g_return_val_if_fail (G_IS_INPUT_STREAM (stream), NULL);
+        g_return_val_if_fail (GIBBON_MATCH_READER_GET_CLASS (self)
+                              ->parse_stream, NULL);
+
+        return GIBBON_MATCH_READER_GET_CLASS(self)->parse_stream (self, stream,
+                                                                  filename);
+}
+
+/**
+ * gibbon_match_reader_peek:
+ * @self: The #GibbonMatchReader.
+ * @filename: The file to read or %NULL for standard input.
+ * @info: The #GibbonMatchReaderInfo to fill.
+ * @scores: %TRUE if the final score is needed.
+ *
+ * Read the meta information of a match without building a complete
+ * #GibbonMatch if the format allows that.  Determining the final score
+ * may require reading the complete file.  You should therefore only
+ * request it if you actually need it.
+ *
+ * On failure, @info is left empty.  Otherwise you have to release its
+ * contents with gibbon_match_reader_info_clear().
+ *
+ * Returns: %TRUE for success, %FALSE for failure.
+ */
+gboolean
+gibbon_match_reader_peek (GibbonMatchReader *self, const gchar *filename,
+                          GibbonMatchReaderInfo *info, gboolean scores)
+{
+        g_return_val_if_fail (GIBBON_IS_MATCH_READER (self), FALSE);
+        g_return_val_if_fail (info != NULL, FALSE);
+
+        memset (info, 0, sizeof *info);
+        info->start_time = G_MININT64;
+
+        if (!GIBBON_MATCH_READER_GET_CLASS (self)->peek (self, filename,
+                                                         info, scores)) {
+                gibbon_match_reader_info_clear (info);
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+static gboolean
+gibbon_match_reader_real_peek (GibbonMatchReader *self, const gchar *filename,
+                               GibbonMatchReaderInfo *info, gboolean scores)
+{
+        GibbonMatch *match = gibbon_match_reader_parse (self, filename);
+
+        if (!match)
+                return FALSE;
+
+        gibbon_match_reader_info_from_match (info, match, scores);
+        g_object_unref (match);
+
+        return TRUE;
+}
+
+/**
+ * gibbon_match_reader_info_clear:
+ * @info: The #GibbonMatchReaderInfo to clear.
+ *
+ * Free the strings contained in @info and reset all members.
+ */
+void
+gibbon_match_reader_info_clear (GibbonMatchReaderInfo *info)
+{
+        g_return_if_fail (info != NULL);
+
+        g_free (info->white);
+        g_free (info->black);
+        memset (info, 0, sizeof *info);
+        info->start_time = G_MININT64;
+}
+
+/**
+ * gibbon_match_reader_info_from_match:
+ * @info: The #GibbonMatchReaderInfo to fill.
+ * @match: The #GibbonMatch to read the information from.
+ * @scores: %TRUE if the score should be filled in.
+ *
+ * Fill @info with the meta information of @match.  This is meant as a
+ * helper for the implementations of the @peek method.  The strings in @info
+ * must either be %NULL or allocated with g_malloc().
+ */
+void
+gibbon_match_reader_info_from_match (GibbonMatchReaderInfo *info,
+                                     const GibbonMatch *match,
+                                     gboolean scores)
+{
+        g_return_if_fail (info != NULL);
+        g_return_if_fail (GIBBON_IS_MATCH (match));
+
+        g_free (info->white);
+        info->white = g_strdup (gibbon_match_get_white (match));
+        g_free (info->black);
+        info->black = g_strdup (gibbon_match_get_black (match));
+        info->length = gibbon_match_get_length (match);
+        info->crawford = gibbon_match_get_crawford (match);
+        info->start_time = gibbon_match_get_start_time (match);
+
+        if (scores && gibbon_match_get_current_game (match)) {
+                info->scores[0] = gibbon_match_get_white_score (match);
+                info->scores[1] = gibbon_match_get_black_score (match);
+        }
+}
+
+/**
+ * gibbon_match_reader_is_compressed:
+ * @filename: The name of the file to check or %NULL for standard input.
+ *
+ * Check whether @filename names a gzip compressed file.  The decision is
+ * made on the filename extension ".gz" alone.
+ *
+ * Returns: %TRUE if @filename is compressed, %FALSE otherwise.
+ */
+gboolean
+gibbon_match_reader_is_compressed (const gchar *filename)
+{
+        return filename && g_str_has_suffix (filename, ".gz");
+}
+
+/**
+ * gibbon_match_reader_open:
+ * @filename: The name of the file to open or %NULL for standard input.
+ * @error: A #GError location or %NULL.
+ *
+ * Open @filename for reading.  If the file is compressed (see
+ * gibbon_match_reader_is_compressed()), the returned stream decompresses
+ * it on the fly.
+ *
+ * Uncompressed regular files are mapped into memory, so that the scanners
+ * read them without system calls or stdio buffering.  Standard input and
+ * other special files are read as a plain stream.
+ *
+ * Returns: (transfer full): The #GInputStream or %NULL in case of failure.
+ */
+GInputStream *
+gibbon_match_reader_open (const gchar *filename, GError **error)
+{
+        GFile *file;
+        GFileInputStream *fin;
+        GConverter *decompressor;
+        GInputStream *in;
+
+        if (!filename) {
+#ifdef G_OS_WIN32
+                return g_win32_input_stream_new (
+                                GetStdHandle (STD_INPUT_HANDLE), FALSE);
+#else
+                return g_unix_input_stream_new (0, FALSE);
+#endif
+        }
+
+        if (!gibbon_match_reader_is_compressed (filename)) {
+                in = gibbon_match_reader_map (filename);
+                if (in)
+                        return in;
+        }
+
+        file = g_file_new_for_path (filename);
+        fin = g_file_read (file, NULL, error);
+        g_object_unref (file);
+        if (!fin)
+                return NULL;
+
+        if (!gibbon_match_reader_is_compressed (filename))
+                return G_INPUT_STREAM (fin);
+
+        decompressor = G_CONVERTER (g_zlib_decompressor_new (
+                                        G_ZLIB_COMPRESSOR_FORMAT_GZIP));
+        in = g_converter_input_stream_new (G_INPUT_STREAM (fin), decompressor);
+        g_object_unref (decompressor);
+        g_object_unref (fin);
+
+        return in;
+}
+
+/*
+ * Return a memory stream over the mapped contents of @filename, or NULL if
+ * the file cannot be mapped.  The caller then falls back to reading, which
+ * also produces a proper error message.
+ */
+static GInputStream *
+gibbon_match_reader_map (const gchar *filename)
+{
+        GMappedFile *mapped;
+        GInputStream *in;
+        const gchar *contents;
+        gsize length;
+
+        /* Mapping a pipe or a device yields no data at all.  */
+        if (!g_file_test (filename, G_FILE_TEST_IS_REGULAR))
+                return NULL;
+
+        mapped = g_mapped_file_new (filename, FALSE, NULL);
+        if (!mapped)
+                return NULL;
+
+        length = g_mapped_file_get_length (mapped);
+        contents = length ? g_mapped_file_get_contents (mapped) : "";
+
+        in = g_memory_input_stream_new_from_data (contents, length, NULL);
+
+        /* The mapping lives as long as the stream.  */
+        g_object_set_data_full (G_OBJECT (in), "gibbon-mapped-file", mapped,
+                                (GDestroyNotify) g_mapped_file_unref);
+
+        return in;
+}
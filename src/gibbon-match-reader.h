@@ -26,6 +26,7 @@
 
 #include <glib.h>
 #include <glib-object.h>
+#include <gio/gio.h>
 
 #include "gibbon-match.h"
 
@@ -49,6 +50,29 @@
 typedef void (*GibbonMatchReaderErrorFunc) (gpointer user_data,
                                             const gchar *msg);
 
+/**
+ * GibbonMatchReaderInfo:
+ * @white: Name of white or %NULL.
+ * @black: Name of black or %NULL.
+ * @length: Length of the match or -1 for unlimited matches.
+ * @start_time: Timestamp of the first action or %G_MININT64 if unknown.
+ * @crawford: %TRUE if the Crawford rule applies.
+ * @scores: The final score, white first.  Only filled if requested.
+ *
+ * Meta information about a match as returned by gibbon_match_reader_peek().
+ * Release the contents with gibbon_match_reader_info_clear().
+ */
+typedef struct _GibbonMatchReaderInfo GibbonMatchReaderInfo;
+struct _GibbonMatchReaderInfo
+{
+        gchar *white;
+        gchar *black;
+        gsize length;
+        gint64 start_time;
+        gboolean crawford;
+        guint scores[2];
+};
+
 /**
  * GibbonMatchReader:
  *
@@ -63,8 +87,12 @@ struct _GibbonMatchReader
 /**
  * GibbonMatchReaderClass:
  * @parse: Parse the given filename or %NULL for standard input.
+ * @parse_stream: Parse an already opened stream.  The filename is only
+ *                used for messages and may be %NULL.
+ * @peek: Only read the meta information of a match.  The default
+ *        implementation parses the complete match.
  *
- * IMPORTANT: The @parse method is usually NOT thread-safe!
+ * IMPORTANT: The @parse and @peek methods are usually NOT thread-safe!
  *
  * Abstract base class for readers for backgammon match files.
  */
@@ -76,11 +104,31 @@ struct _GibbonMatchReaderClass
 
         /* <public> */
         GibbonMatch * (*parse) (GibbonMatchReader *self, const gchar *filename);
+        GibbonMatch * (*parse_stream) (GibbonMatchReader *self,
+                                       GInputStream *stream,
+                                       const gchar *filename);
+        gboolean (*peek) (GibbonMatchReader *self, const gchar *filename,
+                          GibbonMatchReaderInfo *info, gboolean scores);
 };
 
 GType gibbon_match_reader_get_type (void) G_GNUC_CONST;
 
 GibbonMatch *gibbon_match_reader_parse (GibbonMatchReader *self,
                                         const gchar *filename);
+GibbonMatch *gibbon_match_reader_parse_stream (GibbonMatchReader *self,
+                                               GInputStream *stream,
+                                               const gchar *filename);
+gboolean gibbon_match_reader_peek (GibbonMatchReader *self,
+                                   const gchar *filename,
+                                   GibbonMatchReaderInfo *info,
+                                   gboolean scores);
+void gibbon_match_reader_info_clear (GibbonMatchReaderInfo *info);
+void gibbon_match_reader_info_from_match (GibbonMatchReaderInfo *info,
+                                          const GibbonMatch *match,
+                                          gboolean scores);
+
+gboolean gibbon_match_reader_is_compressed (const gchar *filename);
+GInputStream *gibbon_match_reader_open (const gchar *filename,
+                                        GError **error);
 
 #endif
@@ -0,0 +1,395 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Statistics are updated whenever an analysed action is added to a game
+ * so that saving a match never has to walk all of its games again.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+#include <gtk/gtk.h>
+
+#include "gibbon-match-statistics.h"
+#include "gibbon-game-actions.h"
+#include "gibbon-analysis-roll.h"
+#include "gibbon-analysis-move.h"
+#include "gibbon-variant-list.h"
+#include "gibbon-met.h"
+
+static const GibbonMET *gibbon_match_statistics_get_met (void);
+static void gibbon_match_statistics_add_cube_error (GibbonMatchStatistics
+                                                    *self, gint i,
+                                                    const GibbonAnalysisMove
+                                                    *a,
+                                                    gdouble error);
+static void gibbon_match_statistics_add_checker_error (GibbonMatchStatistics
+                                                       *self, gint i,
+                                                       const GibbonAnalysisMove
+                                                       *a);
+static gdouble gibbon_match_statistics_to_equity (const GibbonAnalysisMove *a,
+                                                  gdouble p,
+                                                  guint my_score,
+                                                  guint opp_score);
+static gdouble gibbon_match_statistics_to_mwc (gdouble equity,
+                                               gsize match_length, guint cube,
+                                               guint my_score, guint opp_score);
+
+static GibbonMET *gibbon_match_statistics_met = NULL;
+
+/**
+ * gibbon_match_statistics_set_met:
+ * @met: The #GibbonMET to use or %NULL for the default table.
+ *
+ * Set the match equity table used for converting equities into match
+ * winning chances.  The application calls this once at startup, before
+ * any threads are created.
+ */
+void
+gibbon_match_statistics_set_met (GibbonMET *met)
+{
+        if (met)
+                g_object_ref (met);
+        if (gibbon_match_statistics_met)
+                g_object_unref (gibbon_match_statistics_met);
+        gibbon_match_statistics_met = met;
+}
+
+/*
+ * Programs without a GibbonApp, like the batch converter and the tests,
+ * fall back to a private copy of the default table.
+ */
+static const GibbonMET *
+gibbon_match_statistics_get_met (void)
+{
+        static volatile gsize met = 0;
+
+        if (gibbon_match_statistics_met)
+                return gibbon_match_statistics_met;
+
+        if (g_once_init_enter (&met))
+                g_once_init_leave (&met, (gsize) gibbon_met_new ());
+
+        return (const GibbonMET *) met;
+}
+
+/**
+ * gibbon_match_statistics_is_empty:
+ * @self: The #GibbonMatchStatistics.
+ *
+ * Check whether any analysed action was accounted for.  Statistics of a
+ * match without analysis are all zero, but that does not mean that the
+ * players did not make errors.
+ *
+ * Returns: %TRUE if no analysed decision or roll was seen.
+ */
+gboolean
+gibbon_match_statistics_is_empty (const GibbonMatchStatistics *self)
+{
+        gint i;
+
+        g_return_val_if_fail (self != NULL, TRUE);
+
+        for (i = 0; i < 2; ++i)
+                if (self->checker_decisions[i] || self->cube_decisions[i]
+                    || self->rolls[i])
+                        return FALSE;
+
+        return TRUE;
+}
+
+/**
+ * gibbon_match_statistics_init:
+ * @self: The #GibbonMatchStatistics to reset.
+ * @match_length: The length of the match or 0 for money sessions.
+ *
+ * Reset all counters.
+ */
+void
+gibbon_match_statistics_init (GibbonMatchStatistics *self, gsize match_length)
+{
+        g_return_if_fail (self != NULL);
+
+        memset (self, 0, sizeof *self);
+        self->match_length = match_length;
+}
+
+/**
+ * gibbon_match_statistics_add:
+ * @self: The #GibbonMatchStatistics.
+ * @position: The position before @action.
+ * @side: The side that performed @action.
+ * @action: The #GibbonGameAction.
+ * @analysis: The #GibbonAnalysis of @action or %NULL.
+ *
+ * Account for one action.  This takes constant time.
+ */
+void
+gibbon_match_statistics_add (GibbonMatchStatistics *self,
+                             const GibbonPosition *position,
+                             GibbonPositionSide side,
+                             const GibbonGameAction *action,
+                             const GibbonAnalysis *analysis)
+{
+        const GibbonAnalysisMove *a;
+        gdouble luck, best;
+        gdouble p_nodouble, p_take, eq_nodouble, eq_take;
+        gint i;
+        guint my_score, opp_score;
+
+        g_return_if_fail (self != NULL);
+        g_return_if_fail (position != NULL);
+        g_return_if_fail (GIBBON_IS_GAME_ACTION (action));
+
+        if (!analysis)
+                return;
+
+        if (side == GIBBON_POSITION_SIDE_WHITE)
+                i = 0;
+        else if (side == GIBBON_POSITION_SIDE_BLACK)
+                i = 1;
+        else
+                return;
+
+        if (GIBBON_IS_ANALYSIS_ROLL (analysis)) {
+                luck = gibbon_analysis_roll_get_luck_value (
+                                GIBBON_ANALYSIS_ROLL (analysis));
+                my_score = position->scores[i];
+                opp_score = position->scores[!i];
+                ++self->rolls[i];
+                self->luck_emg[i] += luck;
+                self->luck_mwc[i] += gibbon_match_statistics_to_mwc (
+                                luck, position->match_length, position->cube,
+                                my_score, opp_score)
+                        - gibbon_match_statistics_to_mwc (
+                                0.0, position->match_length, position->cube,
+                                my_score, opp_score);
+                return;
+        }
+
+        if (!GIBBON_IS_ANALYSIS_MOVE (analysis))
+                return;
+
+        a = GIBBON_ANALYSIS_MOVE (analysis);
+
+        if (a->ma && GIBBON_IS_MOVE (action))
+                gibbon_match_statistics_add_checker_error (self, i, a);
+
+        if (!a->da)
+                return;
+
+        p_nodouble = a->da_p[0][GIBBON_ANALYSIS_MOVE_CUBEFUL_EQUITY];
+        p_take = a->da_p[1][GIBBON_ANALYSIS_MOVE_CUBEFUL_EQUITY];
+
+        /*
+         * Take analyses are seen from the perspective of the doubler.  The
+         * taker wants to minimize the doubler's equity.
+         */
+        if (a->da_take_analysis) {
+                eq_take = gibbon_match_statistics_to_equity (a, p_take,
+                                                             a->opp_score,
+                                                             a->my_score);
+                best = MIN (eq_take, 1.0);
+                if (GIBBON_IS_TAKE (action))
+                        gibbon_match_statistics_add_cube_error (self, i, a,
+                                                                eq_take - best);
+                else if (GIBBON_IS_DROP (action))
+                        gibbon_match_statistics_add_cube_error (self, i, a,
+                                                                1.0 - best);
+                return;
+        }
+
+        if (!a->may_double)
+                return;
+
+        eq_nodouble = gibbon_match_statistics_to_equity (a, p_nodouble,
+                                                         a->my_score,
+                                                         a->opp_score);
+        eq_take = gibbon_match_statistics_to_equity (a, p_take,
+                                                     a->my_score,
+                                                     a->opp_score);
+        best = MAX (eq_nodouble, MIN (eq_take, 1.0));
+
+        if (GIBBON_IS_DOUBLE (action))
+                gibbon_match_statistics_add_cube_error (self, i, a,
+                                                        best
+                                                        - MIN (eq_take, 1.0));
+        else
+                gibbon_match_statistics_add_cube_error (self, i, a,
+                                                        best - eq_nodouble);
+}
+
+static void
+gibbon_match_statistics_add_checker_error (GibbonMatchStatistics *self, gint i,
+                                           const GibbonAnalysisMove *a)
+{
+        GtkTreeModel *model;
+        GtkTreeIter iter;
+        gdouble best, played;
+
+        model = GTK_TREE_MODEL (gibbon_variant_list_get_store (a->ma_variants));
+
+        if (!gtk_tree_model_get_iter_first (model, &iter))
+                return;
+        gtk_tree_model_get (model, &iter,
+                            GIBBON_VARIANT_LIST_COL_EQUITY, &best,
+                            -1);
+
+        if (!gtk_tree_model_iter_nth_child (model, &iter, NULL, a->ma_imove))
+                return;
+        gtk_tree_model_get (model, &iter,
+                            GIBBON_VARIANT_LIST_COL_EQUITY, &played,
+                            -1);
+
+        ++self->checker_decisions[i];
+        if (best <= played)
+                return;
+
+        self->checker_error_emg[i] += best - played;
+        self->checker_error_mwc[i] +=
+                gibbon_match_statistics_to_mwc (best, a->match_length, a->cube,
+                                                a->my_score, a->opp_score)
+                - gibbon_match_statistics_to_mwc (played, a->match_length,
+                                                  a->cube, a->my_score,
+                                                  a->opp_score);
+}
+
+static void
+gibbon_match_statistics_add_cube_error (GibbonMatchStatistics *self, gint i,
+                                        const GibbonAnalysisMove *a,
+                                        gdouble error)
+{
+        guint my_score, opp_score;
+
+        ++self->cube_decisions[i];
+        if (error <= 0.0)
+                return;
+
+        if (a->da_take_analysis) {
+                my_score = a->opp_score;
+                opp_score = a->my_score;
+        } else {
+                my_score = a->my_score;
+                opp_score = a->opp_score;
+        }
+
+        self->cube_error_emg[i] += error;
+        self->cube_error_mwc[i] +=
+                gibbon_match_statistics_to_mwc (error, a->match_length,
+                                                a->cube, my_score, opp_score)
+                - gibbon_match_statistics_to_mwc (0.0, a->match_length,
+                                                  a->cube, my_score,
+                                                  opp_score);
+}
+
+/*
+ * Cubeful equities of doubling analyses are match winning chances in match
+ * play.
+ */
+static gdouble
+gibbon_match_statistics_to_equity (const GibbonAnalysisMove *a, gdouble p,
+                                   guint my_score, guint opp_score)
+{
+        if (!a->match_length)
+                return p;
+
+        return gibbon_met_mwc2eq (gibbon_match_statistics_get_met (), p,
+                                  a->match_length, a->cube,
+                                  my_score, opp_score);
+}
+
+static gdouble
+gibbon_match_statistics_to_mwc (gdouble equity, gsize match_length, guint cube,
+                                guint my_score, guint opp_score)
+{
+        if (!match_length)
+                return 0.0;
+
+        return gibbon_met_eq2mwc (gibbon_match_statistics_get_met (), equity,
+                                  match_length, cube, my_score, opp_score);
+}
+
+/**
+ * gibbon_match_statistics_get_error_emg:
+ * @self: The #GibbonMatchStatistics.
+ * @side: The player.
+ *
+ * Returns: The sum of checker play and cube errors in normalized equity.
+ */
+gdouble
+gibbon_match_statistics_get_error_emg (const GibbonMatchStatistics *self,
+                                       GibbonPositionSide side)
+{
+        gint i = side == GIBBON_POSITION_SIDE_BLACK ? 1 : 0;
+
+        g_return_val_if_fail (self != NULL, 0.0);
+
+        return self->checker_error_emg[i] + self->cube_error_emg[i];
+}
+
+/**
+ * gibbon_match_statistics_get_error_mwc:
+ * @self: The #GibbonMatchStatistics.
+ * @side: The player.
+ *
+ * Returns: The sum of checker play and cube errors in match winning chances.
+ */
+gdouble
+gibbon_match_statistics_get_error_mwc (const GibbonMatchStatistics *self,
+                                       GibbonPositionSide side)
+{
+        gint i = side == GIBBON_POSITION_SIDE_BLACK ? 1 : 0;
+
+        g_return_val_if_fail (self != NULL, 0.0);
+
+        return self->checker_error_mwc[i] + self->cube_error_mwc[i];
+}
+
+/**
+ * gibbon_match_statistics_get_error_rate:
+ * @self: The #GibbonMatchStatistics.
+ * @side: The player.
+ *
+ * The error rate is the total error in millipoints of normalized equity
+ * per decision, the figure that Snowie and FIBS ratings use.
+ *
+ * Returns: The error rate or a negative number if @side has not made any
+ *          analysed decision.
+ */
+gdouble
+gibbon_match_statistics_get_error_rate (const GibbonMatchStatistics *self,
+                                        GibbonPositionSide side)
+{
+        gint i = side == GIBBON_POSITION_SIDE_BLACK ? 1 : 0;
+        guint64 decisions;
+
+        g_return_val_if_fail (self != NULL, -1.0);
+
+        decisions = self->checker_decisions[i] + self->cube_decisions[i];
+        if (!decisions)
+                return -1.0;
+
+        return 1000.0 * gibbon_match_statistics_get_error_emg (self, side)
+                / decisions;
+}
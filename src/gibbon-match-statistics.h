@@ -0,0 +1,76 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GIBBON_MATCH_STATISTICS_H
+# define _GIBBON_MATCH_STATISTICS_H
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <glib.h>
+
+#include "gibbon-position.h"
+#include "gibbon-game-action.h"
+#include "gibbon-analysis.h"
+#include "gibbon-met.h"
+
+G_BEGIN_DECLS
+
+/*
+ * Per-player aggregates of the analysis of a match.  Index 0 is white,
+ * index 1 is black.  Errors are positive numbers and are given in
+ * normalized equity (EMG) and in match winning chances (MWC, a fraction
+ * between 0 and 1).  The MWC values are meaningless for money games.
+ */
+typedef struct _GibbonMatchStatistics GibbonMatchStatistics;
+struct _GibbonMatchStatistics {
+        gsize match_length;
+
+        guint64 checker_decisions[2];
+        guint64 cube_decisions[2];
+        guint64 rolls[2];
+
+        gdouble checker_error_emg[2];
+        gdouble checker_error_mwc[2];
+        gdouble cube_error_emg[2];
+        gdouble cube_error_mwc[2];
+        gdouble luck_emg[2];
+        gdouble luck_mwc[2];
+};
+
+void gibbon_match_statistics_init (GibbonMatchStatistics *self,
+                                   gsize match_length);
+void gibbon_match_statistics_add (GibbonMatchStatistics *self,
+                                  const GibbonPosition *position,
+                                  GibbonPositionSide side,
+                                  const GibbonGameAction *action,
+                                  const GibbonAnalysis *analysis);
+gdouble gibbon_match_statistics_get_error_emg (const GibbonMatchStatistics
+                                               *self, GibbonPositionSide side);
+gdouble gibbon_match_statistics_get_error_mwc (const GibbonMatchStatistics
+                                               *self, GibbonPositionSide side);
+gdouble gibbon_match_statistics_get_error_rate (const GibbonMatchStatistics
+                                                *self, GibbonPositionSide side);
+gboolean gibbon_match_statistics_is_empty (const GibbonMatchStatistics *self);
+void gibbon_match_statistics_set_met (GibbonMET *met);
+
+G_END_DECLS
+
+#endif
@@ -25,7 +25,13 @@
  *
  * A #GibbonMatchTracker records all relevant match actions and triggers
  * appropriate actions.  It continually updates the match file in the
- * archive and it adds moves made to the move list view.
+ * archive.  The views learn about new moves from the match itself.
+ *
+ * Output to the match file is buffered.  When the buffer is written to
+ * disk depends on the #GibbonMatchTrackerFlush policy.  If the program
+ * crashes in between, the saved match file may be cut off.  Such files
+ * are repaired on the next resume by falling back to the longest prefix
+ * that can still be parsed.
  */
 
 #include <glib.h>
@@ -40,8 +46,14 @@
 #include "gibbon-connection.h"
 #include "gibbon-gmd-reader.h"
 #include "gibbon-match-play.h"
-#include "gibbon-match-list.h"
 #include "gibbon-util.h"
+#include "gibbon-settings.h"
+
+/*
+ * Maximum number of lines dropped from the end of a damaged match file
+ * before we give up.
+ */
+#define GIBBON_MATCH_TRACKER_MAX_RECOVERY 8
 
 typedef struct _GibbonMatchTrackerPrivate GibbonMatchTrackerPrivate;
 struct _GibbonMatchTrackerPrivate {
@@ -51,6 +63,10 @@ struct _GibbonMatchTrackerPrivate {
         gchar *wrank;
         gchar *brank;
 
+        GibbonMatchTrackerFlush flush_policy;
+        guint flush_interval;
+        guint flush_source;
+
         gboolean debug;
 };
 
@@ -74,6 +90,19 @@ static GibbonMatch *gibbon_match_tracker_init_match (GibbonMatchTracker *self,
                                                      const gchar *player2,
                                                      const GibbonPosition
                                                      *initial);
+static GibbonMatch *gibbon_match_tracker_read_saved (GibbonMatchTracker *self,
+                                                     const gchar *path);
+static gboolean gibbon_match_tracker_drop_last_line (const gchar *contents,
+                                                     gsize *length);
+static void gibbon_match_tracker_open (GibbonMatchTracker *self,
+                                       GFileOutputStream *fout);
+static void gibbon_match_tracker_close (GibbonMatchTracker *self);
+static void gibbon_match_tracker_flush (const GibbonMatchTracker *self);
+static void gibbon_match_tracker_update_index (const GibbonMatchTracker *self);
+static void gibbon_match_tracker_written (GibbonMatchTracker *self,
+                                          gboolean boundary);
+static gboolean gibbon_match_tracker_on_flush_timeout (GibbonMatchTracker
+                                                       *self);
 
 static void 
 gibbon_match_tracker_init (GibbonMatchTracker *self)
@@ -83,8 +112,13 @@ gibbon_match_tracker_init (GibbonMatchTracker *self)
 
         self->priv->outname = NULL;
         self->priv->writer = NULL;
+        self->priv->out = NULL;
         self->priv->wrank = self->priv->brank = NULL;
 
+        self->priv->flush_policy = GIBBON_MATCH_TRACKER_FLUSH_ACTION;
+        self->priv->flush_interval = 1000;
+        self->priv->flush_source = 0;
+
         self->priv->debug = FALSE;
 }
 
@@ -92,15 +126,8 @@ static void
 gibbon_match_tracker_finalize (GObject *object)
 {
         GibbonMatchTracker *self = GIBBON_MATCH_TRACKER (object);
-        GError *error = NULL;
 
-        if (self->priv->out && !g_output_stream_close (self->priv->out,
-                                                       NULL, &error)) {
-                gibbon_app_fatal_error (app, _("Write Error"),
-                                        _("Error writing to `%s': %s!\n"),
-                                        self->priv->outname,
-                                        error->message);
-        }
+        gibbon_match_tracker_close (self);
 
         g_free (self->priv->outname);
 
@@ -142,10 +169,25 @@ gibbon_match_tracker_new (const gchar *player1, const gchar *player2,
         GibbonMatchTracker *self = g_object_new (GIBBON_TYPE_MATCH_TRACKER,
                                                  NULL);
         GibbonMatch *match = NULL;
+        GSettings *settings;
+        gchar *policy;
 
         if (gibbon_debug ("match-tracking"))
                 self->priv->debug = TRUE;
 
+        settings = g_settings_new (GIBBON_PREFS_MATCH_SCHEMA);
+        policy = g_settings_get_string (settings,
+                                        GIBBON_PREFS_MATCH_FLUSH_POLICY);
+        if (0 == g_strcmp0 ("game", policy))
+                self->priv->flush_policy = GIBBON_MATCH_TRACKER_FLUSH_GAME;
+        else if (0 == g_strcmp0 ("interval", policy))
+                self->priv->flush_policy = GIBBON_MATCH_TRACKER_FLUSH_INTERVAL;
+        g_free (policy);
+        self->priv->flush_interval =
+                gibbon_settings_get_uint (settings,
+                                          GIBBON_PREFS_MATCH_FLUSH_INTERVAL);
+        g_object_unref (settings);
+
         if (!resume)
                 gibbon_match_tracker_unlink_or_archive (self, player1, player2);
         else
@@ -190,7 +232,7 @@ gibbon_match_tracker_store_rank (const GibbonMatchTracker *self,
                                         self->priv->outname,
                                         error->message);
         }
-        g_output_stream_flush (self->priv->out, NULL, NULL);
+        gibbon_match_tracker_flush (self);
 }
 
 static void
@@ -200,12 +242,13 @@ gibbon_match_tracker_unlink_or_archive (GibbonMatchTracker *self,
 {
         gchar *path;
         GibbonArchive *archive = gibbon_app_get_archive (app);
-        GibbonMatchReader *reader;
         GibbonMatch *match;
-        GibbonMatchReaderErrorFunc yyerror;
         GError *error = NULL;
         gint64 start;
 
+        /* The file may be the one that we are currently writing.  */
+        gibbon_match_tracker_flush (self);
+
         path = gibbon_archive_get_saved_name (archive, player1, player2,
                                               &error);
         if (!g_file_test (path, G_FILE_TEST_EXISTS)) {
@@ -221,14 +264,7 @@ gibbon_match_tracker_unlink_or_archive (GibbonMatchTracker *self,
                         return;
         }
 
-        if (self->priv->debug)
-                yyerror = NULL;
-        else
-                yyerror =
-                    (GibbonMatchReaderErrorFunc) gibbon_match_reader_no_yyerror;
-        reader = GIBBON_MATCH_READER (gibbon_gmd_reader_new (yyerror,
-                                                             (gpointer) self));
-        match = gibbon_match_reader_parse (reader, path);
+        match = gibbon_match_tracker_read_saved (self, path);
 
         if (!match) {
                 g_remove (path);
@@ -275,11 +311,10 @@ gibbon_match_tracker_update (GibbonMatchTracker *self,
         const GibbonGame *game;
         const GibbonGame *last_game;
         GError *error = NULL;
-        GibbonMatchList *list;
-        int num_actions;
         const gchar *white;
         const gchar *black;
         GibbonMatch *match = gibbon_app_get_match (app);
+        gboolean boundary = FALSE;
         GTimeVal timeval;
         struct tm *now;
 
@@ -335,7 +370,11 @@ gibbon_match_tracker_update (GibbonMatchTracker *self,
                 current = gibbon_position_copy (target);
         }
 
-        list = gibbon_app_get_match_list (app);
+        /*
+         * Listeners get notified once for all missing actions, and not
+         * once per action.
+         */
+        gibbon_match_begin_changes (match);
         iter = actions;
         while (iter) {
                 play = (GibbonMatchPlay *) iter->data;
@@ -393,20 +432,18 @@ gibbon_match_tracker_update (GibbonMatchTracker *self,
                                                 self->priv->outname,
                                                 error->message);
                 }
-                if (last_game != game) {
-                        gibbon_match_list_add_game (list, game);
-                } else {
-                        /* Show the new game action(s).  */
-                        num_actions = gibbon_game_get_num_actions (game);
-                        gibbon_match_list_add_action (list, game,
-                                                      num_actions - 1);
-                }
+                if (last_game != game || gibbon_game_over (game))
+                        boundary = TRUE;
                 last_game = game;
                 iter = iter->next;
         }
+        gibbon_match_commit_changes (match);
 
         gibbon_position_free (current);
 
+        if (actions)
+                gibbon_match_tracker_written (self, boundary);
+
         g_slist_free_full (actions, (GDestroyNotify) gibbon_match_play_free);
 
         if (gibbon_match_over (match)) {
@@ -419,6 +456,7 @@ gibbon_match_tracker_update (GibbonMatchTracker *self,
 
 bail_out:
 
+        gibbon_match_commit_changes (match);
         gibbon_position_free (current);
         g_slist_free_full (actions, (GDestroyNotify) gibbon_match_play_free);
 
@@ -440,9 +478,7 @@ gibbon_match_tracker_resume (GibbonMatchTracker *self,
 {
         gchar *path;
         GibbonArchive *archive = gibbon_app_get_archive (app);
-        GibbonMatchReader *reader;
         GibbonMatch *match;
-        GibbonMatchReaderErrorFunc yyerror;
         GError *error = NULL;
         GFile *file;
         GFileOutputStream *out;
@@ -462,10 +498,7 @@ gibbon_match_tracker_resume (GibbonMatchTracker *self,
                         return NULL;
         }
 
-        yyerror = (GibbonMatchReaderErrorFunc) gibbon_match_reader_no_yyerror;
-        reader = GIBBON_MATCH_READER (gibbon_gmd_reader_new (yyerror,
-                                                             (gpointer) self));
-        match = gibbon_match_reader_parse (reader, path);
+        match = gibbon_match_tracker_read_saved (self, path);
 
         if (!match) {
                 g_remove (path);
@@ -492,7 +525,7 @@ gibbon_match_tracker_resume (GibbonMatchTracker *self,
         }
 
         self->priv->outname = path;
-        self->priv->out = G_OUTPUT_STREAM (out);
+        gibbon_match_tracker_open (self, out);
         self->priv->writer = gibbon_gmd_writer_new ();
 
         return match;
@@ -515,6 +548,11 @@ gibbon_match_tracker_init_match (GibbonMatchTracker *self, gsize length,
         GibbonGame *game;
         GibbonMatch *match;
 
+        gibbon_match_tracker_close (self);
+        g_free (self->priv->outname);
+        if (self->priv->writer)
+                g_object_unref (self->priv->writer);
+
         self->priv->outname = gibbon_archive_get_saved_name (archive,
                                                              player1,
                                                              player2,
@@ -534,7 +572,7 @@ gibbon_match_tracker_init_match (GibbonMatchTracker *self, gsize length,
                                         self->priv->outname,
                                         error->message);
         }
-        self->priv->out = G_OUTPUT_STREAM (fout);
+        gibbon_match_tracker_open (self, fout);
 
         /*
          * We always assume that the Crawford rule applies for
@@ -574,7 +612,8 @@ gibbon_match_tracker_init_match (GibbonMatchTracker *self, gsize length,
                                         self->priv->outname,
                                         error->message);
         }
-        g_output_stream_flush (self->priv->out, NULL, NULL);
+        gibbon_match_tracker_flush (self);
+        gibbon_match_tracker_update_index (self);
 
         return match;
 }
@@ -596,3 +635,221 @@ gibbon_match_tracker_set_crawford (GibbonMatchTracker *self, gboolean flag)
                         gibbon_game_set_is_crawford (game, FALSE);
         }
 }
+
+/**
+ * gibbon_match_tracker_set_flush_policy:
+ * @self: The #GibbonMatchTracker.
+ * @policy: The new #GibbonMatchTrackerFlush policy.
+ * @interval: Flush interval in milliseconds for
+ *            %GIBBON_MATCH_TRACKER_FLUSH_INTERVAL, ignored otherwise.
+ *
+ * Change the durability policy for the match file.  The initial policy
+ * is taken from the preferences.
+ */
+void
+gibbon_match_tracker_set_flush_policy (GibbonMatchTracker *self,
+                                       GibbonMatchTrackerFlush policy,
+                                       guint interval)
+{
+        g_return_if_fail (GIBBON_IS_MATCH_TRACKER (self));
+        g_return_if_fail (policy != GIBBON_MATCH_TRACKER_FLUSH_INTERVAL
+                          || interval > 0);
+
+        /* Do not leave pending data behind with the old policy.  */
+        if (self->priv->flush_source)
+                gibbon_match_tracker_flush (self);
+
+        self->priv->flush_policy = policy;
+        if (policy == GIBBON_MATCH_TRACKER_FLUSH_INTERVAL)
+                self->priv->flush_interval = interval;
+}
+
+static GibbonMatch *
+gibbon_match_tracker_read_saved (GibbonMatchTracker *self, const gchar *path)
+{
+        GibbonMatchReaderErrorFunc yyerror;
+        GibbonMatchReader *reader;
+        GibbonMatch *match;
+        gchar *contents;
+        gsize length;
+        gint attempts;
+        GInputStream *stream;
+
+        if (self->priv->debug)
+                yyerror = NULL;
+        else
+                yyerror =
+                    (GibbonMatchReaderErrorFunc) gibbon_match_reader_no_yyerror;
+        reader = GIBBON_MATCH_READER (gibbon_gmd_reader_new (yyerror,
+                                                             (gpointer) self));
+        match = gibbon_match_reader_parse (reader, path);
+
+        /*
+         * A crash may have left an incomplete line or action at the end of
+         * the file.  Fall back to the longest prefix that can be parsed.
+         * The prefixes are tried in memory, and the file is only rewritten
+         * once one of them has been parsed successfully.
+         */
+        if (!match && g_file_get_contents (path, &contents, &length, NULL)) {
+                for (attempts = 0;
+                     !match && attempts < GIBBON_MATCH_TRACKER_MAX_RECOVERY;
+                     ++attempts) {
+                        if (!gibbon_match_tracker_drop_last_line (contents,
+                                                                  &length))
+                                break;
+                        stream = g_memory_input_stream_new_from_data (contents,
+                                                                      length,
+                                                                      NULL);
+                        match = gibbon_match_reader_parse_stream (reader,
+                                                                  stream,
+                                                                  path);
+                        g_object_unref (stream);
+                }
+                if (match && !g_file_set_contents (path, contents, length,
+                                                   NULL)) {
+                        /* Leave the file alone for another attempt.  */
+                        g_object_unref (match);
+                        match = NULL;
+                }
+                if (match && self->priv->debug)
+                        g_printerr ("Recovered damaged match file `%s'.\n",
+                                    path);
+                g_free (contents);
+        }
+
+        g_object_unref (reader);
+
+        return match;
+}
+
+static gboolean
+gibbon_match_tracker_drop_last_line (const gchar *contents, gsize *length)
+{
+        gsize end = *length;
+
+        if (end && contents[end - 1] == '\n')
+                --end;
+        while (end && contents[end - 1] != '\n')
+                --end;
+
+        /* Never drop the first line.  */
+        if (!end)
+                return FALSE;
+
+        *length = end;
+
+        return TRUE;
+}
+
+static void
+gibbon_match_tracker_open (GibbonMatchTracker *self, GFileOutputStream *fout)
+{
+        self->priv->out = g_buffered_output_stream_new (G_OUTPUT_STREAM (fout));
+        g_object_unref (fout);
+}
+
+static void
+gibbon_match_tracker_close (GibbonMatchTracker *self)
+{
+        GError *error = NULL;
+
+        if (self->priv->flush_source) {
+                g_source_remove (self->priv->flush_source);
+                self->priv->flush_source = 0;
+        }
+
+        if (!self->priv->out)
+                return;
+
+        if (!g_output_stream_close (self->priv->out, NULL, &error)) {
+                gibbon_app_fatal_error (app, _("Write Error"),
+                                        _("Error writing to `%s': %s!\n"),
+                                        self->priv->outname,
+                                        error->message);
+        }
+        g_object_unref (self->priv->out);
+        self->priv->out = NULL;
+
+        gibbon_match_tracker_update_index (self);
+}
+
+static void
+gibbon_match_tracker_flush (const GibbonMatchTracker *self)
+{
+        GError *error = NULL;
+
+        if (self->priv->flush_source) {
+                g_source_remove (self->priv->flush_source);
+                self->priv->flush_source = 0;
+        }
+
+        if (!self->priv->out)
+                return;
+
+        if (!g_output_stream_flush (self->priv->out, NULL, &error)) {
+                gibbon_app_fatal_error (app, _("Write Error"),
+                                        _("Error writing to `%s': %s!\n"),
+                                        self->priv->outname,
+                                        error->message);
+        }
+}
+
+/*
+ * Keep the index of saved matches up to date so that the file does not
+ * have to be parsed at the next login.  Rewriting the index after every
+ * action would cost more than it saves.  It is therefore only done when a
+ * match or game starts or ends, and when the file is closed.  If the
+ * index is stale after a crash, the file is simply parsed again.
+ */
+static void
+gibbon_match_tracker_update_index (const GibbonMatchTracker *self)
+{
+        GibbonMatch *match;
+
+        if (!app || !self->priv->outname)
+                return;
+
+        match = gibbon_app_get_match (app);
+        if (match)
+                (void) gibbon_archive_update_saved (
+                                gibbon_app_get_archive (app),
+                                self->priv->outname, match, NULL);
+}
+
+static void
+gibbon_match_tracker_written (GibbonMatchTracker *self, gboolean boundary)
+{
+        GSourceFunc callback =
+                (GSourceFunc) gibbon_match_tracker_on_flush_timeout;
+
+        /* The index must see the final size of the file.  */
+        if (boundary) {
+                gibbon_match_tracker_flush (self);
+                gibbon_match_tracker_update_index (self);
+                return;
+        }
+
+        switch (self->priv->flush_policy) {
+        case GIBBON_MATCH_TRACKER_FLUSH_ACTION:
+                gibbon_match_tracker_flush (self);
+                break;
+        case GIBBON_MATCH_TRACKER_FLUSH_GAME:
+                /* Already handled above.  */
+                break;
+        case GIBBON_MATCH_TRACKER_FLUSH_INTERVAL:
+                if (!self->priv->flush_source)
+                        self->priv->flush_source =
+                                g_timeout_add (self->priv->flush_interval,
+                                               callback, self);
+                break;
+        }
+}
+
+static gboolean
+gibbon_match_tracker_on_flush_timeout (GibbonMatchTracker *self)
+{
+        self->priv->flush_source = 0;
+        gibbon_match_tracker_flush (self);
+
+        return FALSE;
+}
@@ -64,6 +64,25 @@ struct _GibbonMatchTracker
         struct _GibbonMatchTrackerPrivate *priv;
 };
 
+/**
+ * GibbonMatchTrackerFlush:
+ * @GIBBON_MATCH_TRACKER_FLUSH_ACTION: Flush the match file after every
+ *                                     action.
+ * @GIBBON_MATCH_TRACKER_FLUSH_GAME: Flush the match file when a game
+ *                                   starts or ends.
+ * @GIBBON_MATCH_TRACKER_FLUSH_INTERVAL: Flush the match file at most a
+ *                                       fixed interval after a write.
+ *
+ * When the buffered output to the match file is written to disk.  The
+ * header, rank changes, the end of the match, and the destruction of the
+ * tracker always cause a flush.
+ */
+typedef enum {
+        GIBBON_MATCH_TRACKER_FLUSH_ACTION = 0,
+        GIBBON_MATCH_TRACKER_FLUSH_GAME = 1,
+        GIBBON_MATCH_TRACKER_FLUSH_INTERVAL = 2
+} GibbonMatchTrackerFlush;
+
 /**
  * GibbonMatchTrackerClass:
  *
@@ -89,5 +108,8 @@ void gibbon_match_tracker_update (GibbonMatchTracker *self,
                                   const GibbonPosition *pos);
 void gibbon_match_tracker_set_crawford (GibbonMatchTracker *self,
                                         gboolean flag);
+void gibbon_match_tracker_set_flush_policy (GibbonMatchTracker *self,
+                                            GibbonMatchTrackerFlush policy,
+                                            guint interval);
 
 #endif
@@ -34,15 +34,39 @@
 #include <glib/gi18n.h>
 
 #include "gibbon-match.h"
+#include "gibbon-match-priv.h"
 #include "gibbon-game.h"
 #include "gibbon-position.h"
 #include "gibbon-game-actions.h"
 #include "gibbon-match-play.h"
+#include "gibbon-match-statistics.h"
 #include "gibbon-util.h"
 
+enum gibbon_match_signal {
+        ACTIONS_APPENDED,
+        LAST_SIGNAL
+};
+static guint gibbon_match_signals[LAST_SIGNAL] = { 0 };
+
 typedef struct _GibbonMatchPrivate GibbonMatchPrivate;
 struct _GibbonMatchPrivate {
-        GList *games;
+        GPtrArray *games;
+
+        /*
+         * For every game the number of positions in all previous games,
+         * for gibbon_match_seek().  Only the last game can still grow.
+         */
+        GArray *offsets;
+
+        /* Updated by every analysed action that is added to a game.  */
+        GibbonMatchStatistics statistics;
+
+        /*
+         * Nesting depth of gibbon_match_begin_changes() and the number of
+         * positions when the outermost batch was started.
+         */
+        guint batch_depth;
+        gsize batch_start;
 
         gchar *white;
         gchar *black;
@@ -60,29 +84,74 @@ struct _GibbonMatchPrivate {
 
 G_DEFINE_TYPE (GibbonMatch, gibbon_match, G_TYPE_OBJECT)
 
-static GSList *_gibbon_match_get_missing_actions (const GibbonMatch *self,
-                                                  GibbonPosition *current,
-                                                  const GibbonPosition *target,
-                                                  gboolean try_move);
-static GSList *gibbon_match_try_roll (const GibbonMatch *self,
-                                      GibbonPosition *current,
-                                      const GibbonPosition *target,
-                                      gboolean try_move);
-static GSList *gibbon_match_try_accept (const GibbonMatch *self,
-                                        GibbonPosition *current,
-                                        const GibbonPosition *target);
-static GSList *gibbon_match_try_double (const GibbonMatch *self,
-                                        GibbonPosition *current,
-                                        const GibbonPosition *target);
-static GSList *gibbon_match_try_take (const GibbonMatch *self,
-                                      GibbonPosition *current,
-                                      const GibbonPosition *target);
-static GSList *gibbon_match_try_drop (const GibbonMatch *self,
-                                      GibbonPosition *current,
-                                      const GibbonPosition *target);
-static GSList *gibbon_match_try_move (const GibbonMatch *self,
-                                      GibbonPosition *current,
-                                      const GibbonPosition *target);
+/*
+ * Upper bound for the number of steps that gibbon_match_get_missing_actions()
+ * takes.  Every step guesses one or two actions.  Gaps in real life are a
+ * lot shorter.
+ */
+#define GIBBON_MATCH_MAX_GUESS_STEPS 32
+
+typedef struct _GibbonMatchGuess GibbonMatchGuess;
+struct _GibbonMatchGuess {
+        GibbonMatchPlay *plays[2 * GIBBON_MATCH_MAX_GUESS_STEPS];
+        gsize num_plays;
+
+        /* States already visited, for detecting loops.  */
+        GibbonPositionKey keys[GIBBON_MATCH_MAX_GUESS_STEPS];
+        guint64 hashes[GIBBON_MATCH_MAX_GUESS_STEPS];
+        gboolean try_move[GIBBON_MATCH_MAX_GUESS_STEPS];
+        gsize num_visited;
+};
+
+G_LOCK_DEFINE_STATIC (guess_stats);
+static guint64 guess_searches = 0;
+static guint64 guess_failures = 0;
+static guint64 guess_steps = 0;
+static guint guess_max_depth = 0;
+static gdouble guess_seconds = 0.0;
+
+static gboolean gibbon_match_append_action (GibbonMatch *self,
+                                            GibbonPositionSide side,
+                                            GibbonGameAction *action,
+                                            gint64 timestamp, GError **error);
+static gboolean _gibbon_match_get_missing_actions (const GibbonMatch *self,
+                                                   GibbonPosition *current,
+                                                   const GibbonPosition
+                                                   *target,
+                                                   GibbonMatchGuess *guess,
+                                                   gsize max_steps,
+                                                   gsize *depth);
+static gboolean gibbon_match_guess_visit (GibbonMatchGuess *guess,
+                                          const GibbonPosition *current,
+                                          gboolean try_move);
+static void gibbon_match_guess_push (GibbonMatchGuess *guess,
+                                     GibbonGameAction *action,
+                                     GibbonPositionSide side);
+static gboolean gibbon_match_try_roll (const GibbonMatch *self,
+                                       GibbonPosition *current,
+                                       const GibbonPosition *target,
+                                       gboolean try_move,
+                                       GibbonMatchGuess *guess);
+static gboolean gibbon_match_try_accept (const GibbonMatch *self,
+                                         GibbonPosition *current,
+                                         const GibbonPosition *target,
+                                         GibbonMatchGuess *guess);
+static gboolean gibbon_match_try_double (const GibbonMatch *self,
+                                         GibbonPosition *current,
+                                         const GibbonPosition *target,
+                                         GibbonMatchGuess *guess);
+static gboolean gibbon_match_try_take (const GibbonMatch *self,
+                                       GibbonPosition *current,
+                                       const GibbonPosition *target,
+                                       GibbonMatchGuess *guess);
+static gboolean gibbon_match_try_drop (const GibbonMatch *self,
+                                       GibbonPosition *current,
+                                       const GibbonPosition *target,
+                                       GibbonMatchGuess *guess);
+static gboolean gibbon_match_try_move (const GibbonMatch *self,
+                                       GibbonPosition *current,
+                                       const GibbonPosition *target,
+                                       GibbonMatchGuess *guess);
 
 static void 
 gibbon_match_init (GibbonMatch *self)
@@ -90,7 +159,11 @@ gibbon_match_init (GibbonMatch *self)
         self->priv = G_TYPE_INSTANCE_GET_PRIVATE (self,
                 GIBBON_TYPE_MATCH, GibbonMatchPrivate);
 
-        self->priv->games = NULL;
+        self->priv->games = g_ptr_array_new ();
+        self->priv->offsets = g_array_new (FALSE, FALSE, sizeof (gsize));
+        gibbon_match_statistics_init (&self->priv->statistics, 0);
+        self->priv->batch_depth = 0;
+        self->priv->batch_start = 0;
 
         self->priv->white = NULL;
         self->priv->black = NULL;
@@ -109,12 +182,16 @@ gibbon_match_finalize (GObject *object)
         GibbonMatch *self = GIBBON_MATCH (object);
 
         if (self->priv->games) {
-                g_list_foreach (self->priv->games,
-                                (GFunc) g_object_unref, NULL);
-                g_list_free (self->priv->games);
+                g_ptr_array_foreach (self->priv->games,
+                                     (GFunc) g_object_unref, NULL);
+                g_ptr_array_free (self->priv->games, TRUE);
         }
         self->priv->games = NULL;
 
+        if (self->priv->offsets)
+                g_array_free (self->priv->offsets, TRUE);
+        self->priv->offsets = NULL;
+
         g_free (self->priv->white);
         g_free (self->priv->black);
         g_free (self->priv->wrank);
@@ -131,6 +208,27 @@ gibbon_match_class_init (GibbonMatchClass *klass)
         
         g_type_class_add_private (klass, sizeof (GibbonMatchPrivate));
 
+        /**
+         * GibbonMatch::actions-appended:
+         * @match: The #GibbonMatch.
+         * @range: The #GibbonMatchRange of new positions.
+         *
+         * Emitted after actions have been added with
+         * gibbon_match_add_action().  Inside of a batch started with
+         * gibbon_match_begin_changes() the signal is emitted only once,
+         * when the batch is committed.
+         */
+        gibbon_match_signals[ACTIONS_APPENDED] =
+                g_signal_new ("actions-appended",
+                              G_TYPE_FROM_CLASS (klass),
+                              G_SIGNAL_RUN_FIRST,
+                              0,
+                              NULL, NULL,
+                              g_cclosure_marshal_VOID__POINTER,
+                              G_TYPE_NONE,
+                              1,
+                              G_TYPE_POINTER);
+
         object_class->finalize = gibbon_match_finalize;
 }
 
@@ -163,15 +261,15 @@ gibbon_match_new (const gchar *white, const gchar *black,
 GibbonGame *
 gibbon_match_get_current_game (const GibbonMatch *self)
 {
-        GList *iter;
+        GPtrArray *games;
 
         g_return_val_if_fail (GIBBON_IS_MATCH (self), NULL);
 
-        iter = g_list_last (self->priv->games);
-        if (!iter)
+        games = self->priv->games;
+        if (!games->len)
                 return NULL;
 
-        return iter->data;
+        return g_ptr_array_index (games, games->len - 1);
 }
 
 GibbonGame *
@@ -182,20 +280,21 @@ gibbon_match_add_game (GibbonMatch *self, GError **error)
         gboolean is_crawford = FALSE;
         gint white_away, black_away;
         const GibbonPosition *last_position;
-        GList *iter;
+        gsize offset = 0;
 
         gibbon_return_val_if_fail (GIBBON_IS_MATCH (self), NULL, error);
 
-        iter = g_list_last (self->priv->games);
+        game = gibbon_match_get_current_game (self);
 
-        if (iter) {
-                game = iter->data;
+        if (game) {
                 position = gibbon_position_copy (gibbon_game_get_position (game));
                 gibbon_position_reset (position);
         } else {
                 position = gibbon_position_new ();
-                position->players[0] = g_strdup (self->priv->white);
-                position->players[1] = g_strdup (self->priv->black);
+                gibbon_position_set_player (position, self->priv->white,
+                                            GIBBON_POSITION_SIDE_WHITE);
+                gibbon_position_set_player (position, self->priv->black,
+                                            GIBBON_POSITION_SIDE_BLACK);
                 position->match_length = self->priv->length;
         }
 
@@ -261,7 +360,16 @@ gibbon_match_add_game (GibbonMatch *self, GError **error)
         game = gibbon_game_new (self, position,
                                 self->priv->crawford, is_crawford);
         gibbon_position_free (position);
-        self->priv->games = g_list_append (self->priv->games, game);
+
+        /* The previous game is complete now.  */
+        if (self->priv->games->len) {
+                offset = g_array_index (self->priv->offsets, gsize,
+                                        self->priv->offsets->len - 1);
+                offset += 1 + gibbon_game_get_num_actions (
+                        gibbon_match_get_current_game (self));
+        }
+        g_ptr_array_add (self->priv->games, game);
+        g_array_append_val (self->priv->offsets, offset);
 
         return game;
 }
@@ -282,7 +390,7 @@ gibbon_match_get_current_position (const GibbonMatch *self)
 void
 gibbon_match_set_white (GibbonMatch *self, const gchar *white)
 {
-        GList *iter;
+        gsize i;
         GibbonGame *game;
 
         g_return_if_fail (GIBBON_IS_MATCH (self));
@@ -293,11 +401,9 @@ gibbon_match_set_white (GibbonMatch *self, const gchar *white)
         else
                 self->priv->white = g_strdup ("white");
 
-        iter = self->priv->games;
-        while (iter) {
-                game = GIBBON_GAME (iter->data);
+        for (i = 0; i < self->priv->games->len; ++i) {
+                game = g_ptr_array_index (self->priv->games, i);
                 gibbon_game_set_white (game, self->priv->white);
-                iter = iter->next;
         }
 }
 
@@ -312,7 +418,7 @@ gibbon_match_get_white (const GibbonMatch *self)
 void
 gibbon_match_set_black (GibbonMatch *self, const gchar *black)
 {
-        GList *iter;
+        gsize i;
         GibbonGame *game;
 
         g_return_if_fail (GIBBON_IS_MATCH (self));
@@ -323,11 +429,9 @@ gibbon_match_set_black (GibbonMatch *self, const gchar *black)
         else
                 self->priv->black = g_strdup ("black");
 
-        iter = self->priv->games;
-        while (iter) {
-                game = GIBBON_GAME (iter->data);
+        for (i = 0; i < self->priv->games->len; ++i) {
+                game = g_ptr_array_index (self->priv->games, i);
                 gibbon_game_set_black (game, self->priv->black);
-                iter = iter->next;
         }
 }
 const gchar *
@@ -369,18 +473,17 @@ gibbon_match_get_rank (const GibbonMatch *self, GibbonPositionSide side)
 void
 gibbon_match_set_length (GibbonMatch *self, gsize length)
 {
-        GList *iter;
+        gsize i;
         GibbonGame *game;
 
         g_return_if_fail (GIBBON_IS_MATCH (self));
 
         self->priv->length = length;
+        self->priv->statistics.match_length = length;
 
-        iter = self->priv->games;
-        while (iter) {
-                game = GIBBON_GAME (iter->data);
+        for (i = 0; i < self->priv->games->len; ++i) {
+                game = g_ptr_array_index (self->priv->games, i);
                 gibbon_game_set_match_length (game, length);
-                iter = iter->next;
         }
 
 }
@@ -417,21 +520,132 @@ gibbon_match_get_number_of_games (const GibbonMatch *self)
 {
         g_return_val_if_fail (GIBBON_IS_MATCH (self), 0);
 
-        return g_list_length (self->priv->games);
+        return self->priv->games->len;
 }
 
 GibbonGame *
 gibbon_match_get_nth_game (const GibbonMatch *self, gsize i)
 {
-        GList *iter;
+        g_return_val_if_fail (GIBBON_IS_MATCH (self), NULL);
+
+        if (i >= self->priv->games->len)
+                return NULL;
+
+        return g_ptr_array_index (self->priv->games, i);
+}
+
+/**
+ * gibbon_match_get_number_of_positions:
+ * @self: The #GibbonMatch.
+ *
+ * Every game contributes its initial position and the positions after
+ * each of its actions.
+ *
+ * Returns: The number of positions in the match that can be retrieved
+ *          with gibbon_match_seek().
+ */
+gsize
+gibbon_match_get_number_of_positions (const GibbonMatch *self)
+{
+        GibbonGame *game;
+        gsize offset;
+
+        g_return_val_if_fail (GIBBON_IS_MATCH (self), 0);
+
+        game = gibbon_match_get_current_game (self);
+        if (!game)
+                return 0;
+
+        offset = g_array_index (self->priv->offsets, gsize,
+                                self->priv->offsets->len - 1);
+
+        return offset + 1 + gibbon_game_get_num_actions (game);
+}
+
+/**
+ * gibbon_match_seek:
+ * @self: The #GibbonMatch.
+ * @n: The number of the position in the whole match.
+ * @game_no: Return location for the number of the game or %NULL.
+ * @action_no: Return location for the number of the action in the game
+ *             or %NULL.  The initial position of a game is action -1.
+ *
+ * Find the @n-th position of the match.  Finding the game takes
+ * logarithmic time in the number of games, and retrieving the position
+ * is bounded by the keyframe interval of #GibbonGame.
+ *
+ * Returns: The position or %NULL if @n is out of range.
+ */
+const GibbonPosition *
+gibbon_match_seek (const GibbonMatch *self, gsize n, gsize *game_no,
+                   gint *action_no)
+{
+        const gsize *offsets;
+        gsize low, high, mid;
+        GibbonGame *game;
+        gint action;
 
         g_return_val_if_fail (GIBBON_IS_MATCH (self), NULL);
 
-        iter = g_list_nth (self->priv->games, i);
-        if (!iter)
+        if (n >= gibbon_match_get_number_of_positions (self))
                 return NULL;
 
-        return iter->data;
+        /* The last game that starts at or before n.  */
+        offsets = (const gsize *) self->priv->offsets->data;
+        low = 0;
+        high = self->priv->offsets->len - 1;
+        while (low < high) {
+                mid = low + (high - low + 1) / 2;
+                if (offsets[mid] <= n)
+                        low = mid;
+                else
+                        high = mid - 1;
+        }
+
+        game = g_ptr_array_index (self->priv->games, low);
+        action = (gint) (n - offsets[low]) - 1;
+
+        if (game_no)
+                *game_no = low;
+        if (action_no)
+                *action_no = action;
+
+        if (action < 0)
+                return gibbon_game_get_initial_position (game);
+
+        return gibbon_game_get_nth_position (game, action);
+}
+
+/**
+ * gibbon_match_tell:
+ * @self: The #GibbonMatch.
+ * @game_no: The number of the game.
+ * @action_no: The number of the action in the game or -1 for the initial
+ *             position.
+ *
+ * The inverse of gibbon_match_seek().
+ *
+ * Returns: The number of the position in the whole match or the number of
+ *          positions if the arguments are out of range.
+ */
+gsize
+gibbon_match_tell (const GibbonMatch *self, gsize game_no, gint action_no)
+{
+        gsize num_positions, n;
+        GibbonGame *game;
+
+        g_return_val_if_fail (GIBBON_IS_MATCH (self), 0);
+
+        num_positions = gibbon_match_get_number_of_positions (self);
+
+        game = gibbon_match_get_nth_game (self, game_no);
+        if (!game || action_no < -1
+            || action_no >= (gint) gibbon_game_get_num_actions (game))
+                return num_positions;
+
+        n = g_array_index (self->priv->offsets, gsize, game_no);
+
+        return n + 1 + action_no;
 }
 
 gboolean
@@ -458,13 +672,28 @@ gibbon_match_add_action (GibbonMatch *self, GibbonPositionSide side,
                          GibbonGameAction *action, gint64 timestamp,
                          GError **error)
 {
-        GibbonGame *game;
-        const GibbonPosition *current;
+        gboolean result;
 
         gibbon_return_val_if_fail (GIBBON_IS_MATCH (self), FALSE, error);
         gibbon_return_val_if_fail (GIBBON_IS_GAME_ACTION (action), FALSE,
                                          error);
 
+        gibbon_match_begin_changes (self);
+        result = gibbon_match_append_action (self, side, action, timestamp,
+                                             error);
+        gibbon_match_commit_changes (self);
+
+        return result;
+}
+
+static gboolean
+gibbon_match_append_action (GibbonMatch *self, GibbonPositionSide side,
+                            GibbonGameAction *action, gint64 timestamp,
+                            GError **error)
+{
+        GibbonGame *game;
+        const GibbonPosition *current;
+
         game = gibbon_match_get_current_game (self);
         if (!game) {
                 game = gibbon_match_add_game (self, error);
@@ -492,6 +721,52 @@ gibbon_match_add_action (GibbonMatch *self, GibbonPositionSide side,
         return TRUE;
 }
 
+/**
+ * gibbon_match_begin_changes:
+ * @self: The #GibbonMatch.
+ *
+ * Start a batch of changes.  Listeners to #GibbonMatch::actions-appended
+ * are notified only once for all actions added until the matching call
+ * to gibbon_match_commit_changes().  Batches may be nested.
+ */
+void
+gibbon_match_begin_changes (GibbonMatch *self)
+{
+        g_return_if_fail (GIBBON_IS_MATCH (self));
+
+        if (!self->priv->batch_depth++)
+                self->priv->batch_start =
+                        gibbon_match_get_number_of_positions (self);
+}
+
+/**
+ * gibbon_match_commit_changes:
+ * @self: The #GibbonMatch.
+ *
+ * End a batch of changes started with gibbon_match_begin_changes().  When
+ * the outermost batch ends, and positions have been appended in the
+ * meantime, #GibbonMatch::actions-appended is emitted.
+ */
+void
+gibbon_match_commit_changes (GibbonMatch *self)
+{
+        GibbonMatchRange range;
+
+        g_return_if_fail (GIBBON_IS_MATCH (self));
+        g_return_if_fail (self->priv->batch_depth > 0);
+
+        if (--self->priv->batch_depth)
+                return;
+
+        range.from = self->priv->batch_start;
+        range.to = gibbon_match_get_number_of_positions (self);
+        if (range.to <= range.from)
+                return;
+
+        g_signal_emit (self, gibbon_match_signals[ACTIONS_APPENDED], 0,
+                       &range);
+}
+
 /**
  * gibbon_match_get_missing_actions:
  * @self: The incomplete #GibbonMatch.
@@ -519,19 +794,44 @@ gibbon_match_add_action (GibbonMatch *self, GibbonPositionSide side,
  * position in the match.  In that case, %TRUE is returned, and the output
  * list @result will be empty.
  *
+ * The search gives up after a fixed number of steps, or when it arrives at
+ * a state that it has already visited.
+ *
  * Returns: %TRUE for success, %FALSE for failure.
  */
 gboolean
 gibbon_match_get_missing_actions (const GibbonMatch *self,
                                   const GibbonPosition *target,
-                                  GSList **_result)
+                                  GSList **result)
+{
+        return _gibbon_match_get_missing_actions_bounded (
+                        self, target, result, GIBBON_MATCH_MAX_GUESS_STEPS);
+}
+
+/*
+ * The same as gibbon_match_get_missing_actions() but with a lower bound
+ * for the number of steps.  The test suite uses this in order to check
+ * that the search gives up cleanly.
+ */
+gboolean
+_gibbon_match_get_missing_actions_bounded (const GibbonMatch *self,
+                                           const GibbonPosition *target,
+                                           GSList **_result, gsize max_steps)
 {
         GSList *result;
         const GibbonPosition *last_pos;
         GibbonPosition *current;
+        GibbonMatchGuess *guess;
+        GTimer *timer;
+        gdouble seconds;
+        gsize depth = 0;
+        gboolean success;
+        gsize i;
 
         g_return_val_if_fail (GIBBON_IS_MATCH (self), FALSE);
         g_return_val_if_fail (target != NULL, FALSE);
+        g_return_val_if_fail (max_steps <= GIBBON_MATCH_MAX_GUESS_STEPS,
+                              FALSE);
 
         last_pos = gibbon_match_get_current_position (self);
         if (last_pos) {
@@ -578,68 +878,170 @@ gibbon_match_get_missing_actions (const GibbonMatch *self,
                 current->match_length = target->match_length;
         }
 
-        result = _gibbon_match_get_missing_actions (self, current,
-                                                    target, TRUE);
+        guess = g_slice_new (GibbonMatchGuess);
+        guess->num_plays = 0;
+        guess->num_visited = 0;
+
+        timer = g_timer_new ();
+        success = _gibbon_match_get_missing_actions (self, current, target,
+                                                     guess, max_steps, &depth);
+        seconds = g_timer_elapsed (timer, NULL);
+        g_timer_destroy (timer);
         gibbon_position_free (current);
 
-        if (result) {
-                if (_result)
-                        *_result = g_slist_reverse (result);
-                return TRUE;
+        G_LOCK (guess_stats);
+        ++guess_searches;
+        if (!success)
+                ++guess_failures;
+        guess_steps += depth;
+        if (depth > guess_max_depth)
+                guess_max_depth = depth;
+        guess_seconds += seconds;
+        G_UNLOCK (guess_stats);
+
+        if (self->priv->debug)
+                g_printerr ("Guessing missing actions: %s after %u steps"
+                            " in %f s.\n", success ? "success" : "failure",
+                            (guint) depth, seconds);
+
+        result = NULL;
+        for (i = guess->num_plays; i > 0; --i) {
+                if (success && _result)
+                        result = g_slist_prepend (result,
+                                                  guess->plays[i - 1]);
+                else
+                        gibbon_match_play_free (guess->plays[i - 1]);
         }
+        g_slice_free (GibbonMatchGuess, guess);
 
-        return FALSE;
+        if (success && _result)
+                *_result = result;
+
+        return success;
 }
 
-static GSList *
+/**
+ * gibbon_match_get_missing_actions_stats:
+ * @searches: Return location for the number of searches or %NULL.
+ * @failures: Return location for the number of failed searches or %NULL.
+ * @steps: Return location for the total number of steps or %NULL.
+ * @max_depth: Return location for the maximum number of steps of a single
+ *             search or %NULL.
+ * @seconds: Return location for the total time spent or %NULL.
+ *
+ * Retrieve statistics about gibbon_match_get_missing_actions() since the
+ * program started or since gibbon_match_reset_missing_actions_stats().
+ */
+void
+gibbon_match_get_missing_actions_stats (guint64 *searches, guint64 *failures,
+                                        guint64 *steps, guint *max_depth,
+                                        gdouble *seconds)
+{
+        G_LOCK (guess_stats);
+        if (searches)
+                *searches = guess_searches;
+        if (failures)
+                *failures = guess_failures;
+        if (steps)
+                *steps = guess_steps;
+        if (max_depth)
+                *max_depth = guess_max_depth;
+        if (seconds)
+                *seconds = guess_seconds;
+        G_UNLOCK (guess_stats);
+}
+
+/**
+ * gibbon_match_reset_missing_actions_stats:
+ *
+ * Reset the statistics of gibbon_match_get_missing_actions().
+ */
+void
+gibbon_match_reset_missing_actions_stats (void)
+{
+        G_LOCK (guess_stats);
+        guess_searches = guess_failures = guess_steps = 0;
+        guess_max_depth = 0;
+        guess_seconds = 0.0;
+        G_UNLOCK (guess_stats);
+}
+
+/*
+ * Every step guesses the next action from the state of the current position.
+ * The steps are deterministic.  Arriving at a state for the second time
+ * therefore means that we are going in circles.
+ */
+static gboolean
 _gibbon_match_get_missing_actions (const GibbonMatch *self,
                                    GibbonPosition *current,
                                    const GibbonPosition *target,
-                                   gboolean try_move)
+                                   GibbonMatchGuess *guess,
+                                   gsize max_steps,
+                                   gsize *depth)
 {
-        GSList *retval = NULL;
-        GSList *head;
+        gboolean success;
+        gboolean try_move = TRUE;
         GTimeVal timeval;
         struct tm *now;
 
-        g_return_val_if_fail (GIBBON_IS_MATCH (self), FALSE);
-        g_return_val_if_fail (target != NULL, FALSE);
+        for (*depth = 0; *depth < max_steps; ++*depth) {
+                if (gibbon_position_game_over (current)) {
+                        gibbon_position_reset (current);
+                        /*
+                         * FIXME! We must check for the crawford game here,
+                         * and see whether we have to adjust the may_double
+                         * flags.
+                         */
+                }
 
-        if (gibbon_position_game_over (current)) {
-                gibbon_position_reset (current);
-                /*
-                 * FIXME! We must check for the crawford game here, and see
-                 * whether we have to adjust the may_double flags.
-                 */
-        }
+                if (!gibbon_match_guess_visit (guess, current, try_move))
+                        break;
 
-        if (current->resigned) {
-                retval = gibbon_match_try_accept (self, current, target);
-        } else if (current->cube_turned) {
-                retval = gibbon_match_try_take (self, current, target);
-                if (!retval)
-                        retval = gibbon_match_try_drop (self, current, target);
-        } else if (!current->dice[0]) {
-                retval = gibbon_match_try_double (self, current, target);
-                if (!retval) {
-                        retval = gibbon_match_try_roll (self, current, target,
-                                                        try_move);
+                success = FALSE;
+                if (current->resigned) {
+                        success = gibbon_match_try_accept (self, current,
+                                                           target, guess);
+                } else if (current->cube_turned) {
+                        success = gibbon_match_try_take (self, current,
+                                                         target, guess)
+                                || gibbon_match_try_drop (self, current,
+                                                          target, guess);
+                } else if (!current->dice[0]) {
+                        success = gibbon_match_try_double (self, current,
+                                                           target, guess);
+                        if (!success) {
+                                success = gibbon_match_try_roll (self, current,
+                                                                 target,
+                                                                 try_move,
+                                                                 guess);
+                                try_move = FALSE;
+                        }
+                } else if (!current->turn) {
+                        /*
+                         * Handle the case after an initial opening double.
+                         */
+                        success = gibbon_match_try_roll (self, current, target,
+                                                         try_move, guess);
+                } else if (try_move) {
+                        success = gibbon_match_try_move (self, current, target,
+                                                         guess);
                         try_move = FALSE;
                 }
-        } else {
-                /*
-                 * Handle the case after an initial opening double.
-                 */
-                if (!current->turn) {
-                        retval = gibbon_match_try_roll (self, current, target,
-                                                        try_move);
-                } else if (!retval && try_move) {
-                        retval = gibbon_match_try_move (self, current, target);
-                        try_move = FALSE;
+
+                if (!success)
+                        break;
+
+                if (gibbon_position_equals_technically (current, target)) {
+                        ++*depth;
+                        return TRUE;
                 }
         }
 
-        if (!retval && self->priv->debug) {
+        if (*depth >= GIBBON_MATCH_MAX_GUESS_STEPS)
+                g_warning ("Giving up guessing missing actions after %u"
+                           " steps.", (guint) *depth);
+
+        if (self->priv->debug) {
                 g_get_current_time (&timeval);
                 now = localtime ((time_t *) &timeval.tv_sec);
                 g_printerr ("[%02d:%02d:%02d.%06ld] Got stuck here:\n",
@@ -648,37 +1050,89 @@ _gibbon_match_get_missing_actions (const GibbonMatch *self,
                 gibbon_position_dump (current);
         }
 
-        if (!retval)
-                return NULL;
+        return FALSE;
+}
 
-        if (gibbon_position_equals_technically (current, target))
-                return retval;
+/*
+ * Remember the state of the search.  Returns FALSE, if the state has been
+ * visited before.
+ */
+static gboolean
+gibbon_match_guess_visit (GibbonMatchGuess *guess,
+                          const GibbonPosition *current, gboolean try_move)
+{
+        GibbonPositionKey *key = guess->keys + guess->num_visited;
+        guint64 hash;
+        gsize i;
 
-        head = _gibbon_match_get_missing_actions (self, current, target,
-                                                  try_move);
+        gibbon_position_get_key (current, key);
+        hash = gibbon_position_key_hash64 (key);
 
-        if (!head) {
-                g_slist_free_full (retval,
-                                   (GDestroyNotify) gibbon_match_play_free);
-                return NULL;
+        for (i = 0; i < guess->num_visited; ++i) {
+                if (guess->hashes[i] == hash
+                    && guess->try_move[i] == try_move
+                    && gibbon_position_key_equal (guess->keys + i, key))
+                        return FALSE;
         }
 
-        return g_slist_concat (head, retval);
+        guess->hashes[guess->num_visited] = hash;
+        guess->try_move[guess->num_visited] = try_move;
+        ++guess->num_visited;
+
+        return TRUE;
 }
 
-static GSList *
+/*
+ * Every step of the search changes the dice, the cube, the turn or the
+ * score, so the actions that are guessed now never lead back to a state
+ * that was already visited.  The loop detection is a safeguard, and the
+ * test suite checks it directly: @position is visited with and without a
+ * move to try, and then again with a move to try.  Only the last visit
+ * must be refused.
+ */
+gboolean
+_gibbon_match_guess_detects_loop (const GibbonPosition *position)
+{
+        GibbonMatchGuess *guess;
+        gboolean first, other, again;
+
+        g_return_val_if_fail (position != NULL, FALSE);
+
+        guess = g_slice_new (GibbonMatchGuess);
+        guess->num_plays = 0;
+        guess->num_visited = 0;
+
+        first = gibbon_match_guess_visit (guess, position, TRUE);
+        other = gibbon_match_guess_visit (guess, position, FALSE);
+        again = gibbon_match_guess_visit (guess, position, TRUE);
+
+        g_slice_free (GibbonMatchGuess, guess);
+
+        return first && other && !again;
+}
+
+static void
+gibbon_match_guess_push (GibbonMatchGuess *guess, GibbonGameAction *action,
+                         GibbonPositionSide side)
+{
+        g_return_if_fail (guess->num_plays < G_N_ELEMENTS (guess->plays));
+
+        guess->plays[guess->num_plays++] = gibbon_match_play_new (action,
+                                                                  side);
+}
+
+static gboolean
 gibbon_match_try_roll (const GibbonMatch *self,
                        GibbonPosition *current,
                        const GibbonPosition *target,
-                       gboolean try_move)
+                       gboolean try_move,
+                       GibbonMatchGuess *guess)
 {
         GibbonGameAction *action;
         gboolean must_move;
         gboolean white_moved, black_moved;
         guint die1, die2;
         GibbonMove *move;
-        GibbonMatchPlay *play;
-        GSList *retval = NULL;
         gboolean reverse;
 
         /*
@@ -708,7 +1162,7 @@ gibbon_match_try_roll (const GibbonMatch *self,
                         black_moved = TRUE;
 
                 if (white_moved && black_moved)
-                        return NULL;
+                        return FALSE;
 
                 if (white_moved)
                         current->turn = GIBBON_POSITION_SIDE_WHITE;
@@ -749,13 +1203,12 @@ gibbon_match_try_roll (const GibbonMatch *self,
 
                 action = GIBBON_GAME_ACTION (gibbon_roll_new (target->dice[0],
                                                               target->dice[1]));
-                return g_slist_prepend (NULL,
-                                        gibbon_match_play_new (action,
-                                                               current->turn));
+                gibbon_match_guess_push (guess, action, current->turn);
+                return TRUE;
         }
 
         if (!try_move)
-                return NULL;
+                return FALSE;
 
         /*
          * First try non-doubles.  They are more likely and easier to
@@ -775,23 +1228,20 @@ gibbon_match_try_roll (const GibbonMatch *self,
                         if (!gibbon_position_apply_move (current, move,
                                                          current->turn,
                                                          reverse))
-                                return NULL;
+                                return FALSE;
                         /*
                          * gibbon_position_apply_move() has already swapped
                          * the sides! */
-                        play = gibbon_match_play_new (GIBBON_GAME_ACTION (
+                        gibbon_match_guess_push (guess, GIBBON_GAME_ACTION (
                                         gibbon_roll_new (die1, die2)),
                                         -current->turn);
-                        retval = g_slist_prepend (NULL, play);
-                        play = gibbon_match_play_new (GIBBON_GAME_ACTION (move),
-                                                      -current->turn);
-                        retval = g_slist_prepend (retval, play);
-                        break;
+                        gibbon_match_guess_push (guess,
+                                                 GIBBON_GAME_ACTION (move),
+                                                 -current->turn);
+                        return TRUE;
                 }
-                if (retval)
-                        break;
         }
-        for (die1 = 6; !retval && die1 > 0; --die1) {
+        for (die1 = 6; die1 > 0; --die1) {
                 current->dice[0] = die1;
                 current->dice[1] = die1;
                 move = gibbon_position_check_move (current, target, current->turn);
@@ -805,54 +1255,51 @@ gibbon_match_try_roll (const GibbonMatch *self,
                 /*
                  * gibbon_position_apply_move() has already swapped
                  * the sides! */
-                play = gibbon_match_play_new (GIBBON_GAME_ACTION (
+                gibbon_match_guess_push (guess, GIBBON_GAME_ACTION (
                                 gibbon_roll_new (die1, die1)),
                                 -current->turn);
-                retval = g_slist_prepend (NULL, play);
-                play = gibbon_match_play_new (GIBBON_GAME_ACTION (move),
-                                              -current->turn);
-                retval = g_slist_prepend (retval, play);
-                break;
+                gibbon_match_guess_push (guess, GIBBON_GAME_ACTION (move),
+                                         -current->turn);
+                return TRUE;
         }
 
-        return retval;
+        return FALSE;
 }
 
-static GSList *
+static gboolean
 gibbon_match_try_move (const GibbonMatch *self,
                        GibbonPosition *current,
-                       const GibbonPosition *target)
+                       const GibbonPosition *target,
+                       GibbonMatchGuess *guess)
 {
         GibbonMove *move;
-        GibbonMatchPlay *play;
-        GSList *retval = NULL;
         gboolean reverse;
 
         if (!current->dice[0] || !current->dice[1])
-                return NULL;
+                return FALSE;
 
         move = gibbon_position_check_move (current, target, current->turn);
         if (move->status != GIBBON_MOVE_LEGAL) {
                 g_object_unref (move);
-                return NULL;
+                return FALSE;
         }
         reverse = current->turn < 0 ? TRUE : FALSE;
         if (!gibbon_position_apply_move (current, move, current->turn,
                                          reverse))
-                return NULL;
+                return FALSE;
 
         /* Gibbon_position_apply_move() has already swapped the sides! */
-        play = gibbon_match_play_new (GIBBON_GAME_ACTION (move),
-                                      -current->turn);
-        retval = g_slist_prepend (NULL, play);
+        gibbon_match_guess_push (guess, GIBBON_GAME_ACTION (move),
+                                 -current->turn);
 
-        return retval;
+        return TRUE;
 }
 
-static GSList *
+static gboolean
 gibbon_match_try_accept (const GibbonMatch *self,
                          GibbonPosition *current,
-                         const GibbonPosition *target)
+                         const GibbonPosition *target,
+                         GibbonMatchGuess *guess)
 {
         GibbonGameAction *action;
         GibbonPositionSide side;
@@ -861,16 +1308,16 @@ gibbon_match_try_accept (const GibbonMatch *self,
                 if (current->scores[0] != target->scores[0]
                     || (current->scores[1] + current->resigned
                         != target->scores[1]))
-                        return NULL;
+                        return FALSE;
                 side = GIBBON_POSITION_SIDE_WHITE;
         } else if (current->resigned < 0) {
                 if (current->scores[1] != target->scores[1]
                     || (current->scores[0] - current->resigned
                         != target->scores[0]))
-                        return NULL;
+                        return FALSE;
                 side = GIBBON_POSITION_SIDE_BLACK;
         } else {
-                return NULL;
+                return FALSE;
         }
 
         current->turn = GIBBON_POSITION_SIDE_NONE;
@@ -880,71 +1327,77 @@ gibbon_match_try_accept (const GibbonMatch *self,
 
         action = GIBBON_GAME_ACTION (gibbon_accept_new ());
 
-        return g_slist_prepend (NULL, gibbon_match_play_new (action, -side));
+        gibbon_match_guess_push (guess, action, -side);
+
+        return TRUE;
 }
 
-static GSList *
+static gboolean
 gibbon_match_try_double (const GibbonMatch *self,
                          GibbonPosition *current,
-                         const GibbonPosition *target)
+                         const GibbonPosition *target,
+                         GibbonMatchGuess *guess)
 {
         GibbonGameAction *action;
         GibbonPositionSide side;
 
         if (current->dice[0] || current->dice[1])
-                return NULL;
+                return FALSE;
 
         if (current->turn < 0) {
                 if (!current->may_double[1])
-                        return NULL;
+                        return FALSE;
                 if (target->cube_turned) {
                         if (target->cube_turned != GIBBON_POSITION_SIDE_BLACK)
-                                return NULL;
+                                return FALSE;
                 } else if (target->cube == 1) {
                         if (current->scores[1] + current->cube
                                         != target->scores[1]
                             || current->scores[0] != target->scores[0])
-                                return NULL;
+                                return FALSE;
                 } else if (current->cube << 1 != target->cube) {
-                        return NULL;
+                        return FALSE;
                 }
                 side = GIBBON_POSITION_SIDE_BLACK;
         } else if (current->turn > 0) {
                 if (!current->may_double[0])
-                        return NULL;
+                        return FALSE;
                 if (target->cube_turned) {
                         if (target->cube_turned != GIBBON_POSITION_SIDE_WHITE)
-                                return NULL;
+                                return FALSE;
                 } else if (target->cube == 1) {
                         if (current->scores[0] + current->cube
                                         != target->scores[0]
                             || current->scores[1] != target->scores[1])
-                                return NULL;
+                                return FALSE;
                 } else if ((current->cube << 1) != target->cube) {
-                        return NULL;
+                        return FALSE;
                 }
                 side = GIBBON_POSITION_SIDE_WHITE;
         } else {
-                return NULL;
+                return FALSE;
         }
 
         current->cube_turned = side;
 
         action = GIBBON_GAME_ACTION (gibbon_double_new ());
 
-        return g_slist_prepend (NULL, gibbon_match_play_new (action, side));
+        gibbon_match_guess_push (guess, action, side);
+
+        return TRUE;
 }
 
-static GSList *
+static gboolean
 gibbon_match_try_take (const GibbonMatch *self,
                        GibbonPosition *current,
-                       const GibbonPosition *target)
+                       const GibbonPosition *target,
+                       GibbonMatchGuess *guess)
 {
         GibbonGameAction *action;
         GibbonPositionSide side;
 
         if (current->cube << 1 != target->cube)
-                return NULL;
+                return FALSE;
 
         if (current->cube_turned < 0) {
                 current->may_double[0] = TRUE;
@@ -955,7 +1408,7 @@ gibbon_match_try_take (const GibbonMatch *self,
                 current->may_double[1] = TRUE;
                 side = GIBBON_POSITION_SIDE_BLACK;
         } else {
-                return NULL;
+                return FALSE;
         }
 
         current->cube_turned = GIBBON_POSITION_SIDE_NONE;
@@ -963,13 +1416,16 @@ gibbon_match_try_take (const GibbonMatch *self,
 
         action = GIBBON_GAME_ACTION (gibbon_take_new ());
 
-        return g_slist_prepend (NULL, gibbon_match_play_new (action, side));
+        gibbon_match_guess_push (guess, action, side);
+
+        return TRUE;
 }
 
-static GSList *
+static gboolean
 gibbon_match_try_drop (const GibbonMatch *self,
                        GibbonPosition *current,
-                       const GibbonPosition *target)
+                       const GibbonPosition *target,
+                       GibbonMatchGuess *guess)
 {
         GibbonGameAction *action;
         GibbonPositionSide side;
@@ -983,12 +1439,52 @@ gibbon_match_try_drop (const GibbonMatch *self,
                 current->scores[0] += current->cube;
                 current->score = +current->cube;
         } else {
-                return NULL;
+                return FALSE;
         }
 
         action = GIBBON_GAME_ACTION (gibbon_drop_new ());
 
-        return g_slist_prepend (NULL, gibbon_match_play_new (action, side));
+        gibbon_match_guess_push (guess, action, side);
+
+        return TRUE;
+}
+
+/**
+ * gibbon_match_update_statistics:
+ * @self: The #GibbonMatch.
+ * @position: The position before @action.
+ * @side: The side that performed @action.
+ * @action: The #GibbonGameAction.
+ * @analysis: The #GibbonAnalysis of @action.
+ *
+ * Account for an analysed action.  This is called by the games of the
+ * match.
+ */
+void
+gibbon_match_update_statistics (GibbonMatch *self,
+                                const GibbonPosition *position,
+                                GibbonPositionSide side,
+                                const GibbonGameAction *action,
+                                const GibbonAnalysis *analysis)
+{
+        g_return_if_fail (GIBBON_IS_MATCH (self));
+
+        gibbon_match_statistics_add (&self->priv->statistics, position, side,
+                                     action, analysis);
+}
+
+/**
+ * gibbon_match_get_statistics:
+ * @self: The #GibbonMatch.
+ *
+ * Returns: The aggregated analysis of all actions added so far.
+ */
+const GibbonMatchStatistics *
+gibbon_match_get_statistics (const GibbonMatch *self)
+{
+        g_return_val_if_fail (GIBBON_IS_MATCH (self), NULL);
+
+        return &self->priv->statistics;
 }
 
 gint64
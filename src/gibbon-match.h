@@ -25,6 +25,8 @@
 
 #include "gibbon-position.h"
 #include "gibbon-game-action.h"
+#include "gibbon-analysis.h"
+#include "gibbon-match-statistics.h"
 
 #define GIBBON_TYPE_MATCH \
         (gibbon_match_get_type ())
@@ -112,6 +114,20 @@ typedef enum {
         GIBBON_MATCH_ERROR_UNRESPONDED_RESIGNATION
 } GibbonMatchError;
 
+/**
+ * GibbonMatchRange:
+ * @from: Number of the first new position.
+ * @to: Number of the position after the last new one.
+ *
+ * A range of positions as counted by gibbon_match_seek().
+ */
+typedef struct _GibbonMatchRange GibbonMatchRange;
+struct _GibbonMatchRange
+{
+        gsize from;
+        gsize to;
+};
+
 GType gibbon_match_get_type (void) G_GNUC_CONST;
 
 GibbonMatch *gibbon_match_new (const gchar *white, const gchar *black,
@@ -125,6 +141,11 @@ struct _GibbonGame *gibbon_match_get_current_game (const GibbonMatch
 gsize gibbon_match_get_number_of_games (const GibbonMatch *self);
 struct _GibbonGame *gibbon_match_get_nth_game (const GibbonMatch *self,
                                                gsize i);
+gsize gibbon_match_get_number_of_positions (const GibbonMatch *self);
+const GibbonPosition *gibbon_match_seek (const GibbonMatch *self, gsize n,
+                                         gsize *game_no, gint *action_no);
+gsize gibbon_match_tell (const GibbonMatch *self, gsize game_no,
+                         gint action_no);
 const GibbonPosition *gibbon_match_get_current_position (const GibbonMatch *
                                                          self);
 struct _GibbonGame *gibbon_match_add_game (GibbonMatch *self, GError **error);
@@ -145,10 +166,25 @@ const gchar *gibbon_match_get_rank (const GibbonMatch *self,
 gboolean gibbon_match_add_action (GibbonMatch *self, GibbonPositionSide side,
                                   GibbonGameAction *action,
                                   gint64 timestamp, GError **error);
+void gibbon_match_begin_changes (GibbonMatch *self);
+void gibbon_match_commit_changes (GibbonMatch *self);
 
 gboolean gibbon_match_get_missing_actions (const GibbonMatch *self,
                                            const GibbonPosition *target,
                                            GSList **result);
+void gibbon_match_get_missing_actions_stats (guint64 *searches,
+                                             guint64 *failures,
+                                             guint64 *steps,
+                                             guint *max_depth,
+                                             gdouble *seconds);
+void gibbon_match_reset_missing_actions_stats (void);
+void gibbon_match_update_statistics (GibbonMatch *self,
+                                     const GibbonPosition *position,
+                                     GibbonPositionSide side,
+                                     const GibbonGameAction *action,
+                                     const GibbonAnalysis *analysis);
+const GibbonMatchStatistics *gibbon_match_get_statistics (const GibbonMatch
+                                                          *self);
 gint64 gibbon_match_get_start_time (const GibbonMatch *self);
 void gibbon_match_set_start_time (GibbonMatch *self, gint64 timestamp);
 guint gibbon_match_get_white_score (const GibbonMatch *self);
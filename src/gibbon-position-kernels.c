@@ -0,0 +1,340 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The 26 entries of a board are covered by two overlapping 16 byte
+ * vectors, one for the indices 0 to 15, and one for the indices 10 to 25.
+ * Comparisons can simply combine the two results.  Sums mask out index 0,
+ * which holds the opponent's checkers on the bar, and the first six lanes
+ * of the upper vector, which are already counted in the lower one.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <glib.h>
+
+#include "gibbon-position-kernels.h"
+
+#if defined (__SSE2__) || defined (_M_X64)
+# define GIBBON_POSITION_KERNELS_SSE2 1
+# include <emmintrin.h>
+#elif defined (__ARM_NEON) && defined (__aarch64__)
+# define GIBBON_POSITION_KERNELS_NEON 1
+# include <arm_neon.h>
+#endif
+
+#define GIBBON_POSITION_KERNEL_MASK ((1 << 26) - 1)
+
+#if GIBBON_POSITION_KERNELS_SSE2
+
+const gchar *
+gibbon_position_kernels_name (void)
+{
+        return "SSE2";
+}
+
+guint32
+gibbon_position_kernel_differ (const gint8 a[26], const gint8 b[26])
+{
+        __m128i lo, hi;
+
+        lo = _mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i *) a),
+                             _mm_loadu_si128 ((const __m128i *) b));
+        hi = _mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i *) (a + 10)),
+                             _mm_loadu_si128 ((const __m128i *) (b + 10)));
+
+        return ~(_mm_movemask_epi8 (lo) | (_mm_movemask_epi8 (hi) << 10))
+                & GIBBON_POSITION_KERNEL_MASK;
+}
+
+guint32
+gibbon_position_kernel_decreased (const gint8 before[26],
+                                  const gint8 after[26])
+{
+        __m128i lo, hi;
+
+        lo = _mm_cmpgt_epi8 (_mm_loadu_si128 ((const __m128i *) before),
+                             _mm_loadu_si128 ((const __m128i *) after));
+        hi = _mm_cmpgt_epi8 (
+                _mm_loadu_si128 ((const __m128i *) (before + 10)),
+                _mm_loadu_si128 ((const __m128i *) (after + 10)));
+
+        return _mm_movemask_epi8 (lo) | (_mm_movemask_epi8 (hi) << 10);
+}
+
+/* The own checkers in both vectors, with the lanes masked out that must
+ * not be counted.
+ */
+static inline void
+gibbon_position_kernel_own (const gint8 board[26], __m128i *lo, __m128i *hi)
+{
+        const __m128i zero = _mm_setzero_si128 ();
+        const __m128i lo_lanes = _mm_setr_epi8 (0, -1, -1, -1, -1, -1, -1, -1,
+                                                -1, -1, -1, -1, -1, -1, -1, -1);
+        const __m128i hi_lanes = _mm_setr_epi8 (0, 0, 0, 0, 0, 0, -1, -1,
+                                                -1, -1, -1, -1, -1, -1, -1, -1);
+
+        *lo = _mm_loadu_si128 ((const __m128i *) board);
+        *hi = _mm_loadu_si128 ((const __m128i *) (board + 10));
+        *lo = _mm_and_si128 (*lo, _mm_and_si128 (_mm_cmpgt_epi8 (*lo, zero),
+                                                 lo_lanes));
+        *hi = _mm_and_si128 (*hi, _mm_and_si128 (_mm_cmpgt_epi8 (*hi, zero),
+                                                 hi_lanes));
+}
+
+guint
+gibbon_position_kernel_pips (const gint8 board[26])
+{
+        const __m128i zero = _mm_setzero_si128 ();
+        __m128i lo, hi, sum;
+
+        gibbon_position_kernel_own (board, &lo, &hi);
+
+        /* The checker counts are positive now, and can be widened to 16
+         * bits by interleaving them with zeros.
+         */
+        sum = _mm_madd_epi16 (_mm_unpacklo_epi8 (lo, zero),
+                              _mm_setr_epi16 (0, 1, 2, 3, 4, 5, 6, 7));
+        sum = _mm_add_epi32 (sum, _mm_madd_epi16 (
+                _mm_unpackhi_epi8 (lo, zero),
+                _mm_setr_epi16 (8, 9, 10, 11, 12, 13, 14, 15)));
+        sum = _mm_add_epi32 (sum, _mm_madd_epi16 (
+                _mm_unpacklo_epi8 (hi, zero),
+                _mm_setr_epi16 (10, 11, 12, 13, 14, 15, 16, 17)));
+        sum = _mm_add_epi32 (sum, _mm_madd_epi16 (
+                _mm_unpackhi_epi8 (hi, zero),
+                _mm_setr_epi16 (18, 19, 20, 21, 22, 23, 24, 25)));
+
+        sum = _mm_add_epi32 (sum, _mm_shuffle_epi32 (sum, 0x4e));
+        sum = _mm_add_epi32 (sum, _mm_shuffle_epi32 (sum, 0xb1));
+
+        return _mm_cvtsi128_si32 (sum);
+}
+
+guint
+gibbon_position_kernel_checkers (const gint8 board[26])
+{
+        const __m128i zero = _mm_setzero_si128 ();
+        __m128i lo, hi, sum;
+
+        gibbon_position_kernel_own (board, &lo, &hi);
+
+        sum = _mm_add_epi64 (_mm_sad_epu8 (lo, zero), _mm_sad_epu8 (hi, zero));
+
+        return _mm_cvtsi128_si32 (sum)
+                + _mm_cvtsi128_si32 (_mm_srli_si128 (sum, 8));
+}
+
+#elif GIBBON_POSITION_KERNELS_NEON
+
+const gchar *
+gibbon_position_kernels_name (void)
+{
+        return "NEON";
+}
+
+/* NEON has no equivalent of _mm_movemask_epi8().  */
+static inline guint32
+gibbon_position_kernel_movemask (uint8x16_t v)
+{
+        static const guint8 bits[16] = {
+                1, 2, 4, 8, 16, 32, 64, 128,
+                1, 2, 4, 8, 16, 32, 64, 128
+        };
+        uint8x16_t masked = vandq_u8 (v, vld1q_u8 (bits));
+
+        return vaddv_u8 (vget_low_u8 (masked))
+                | (vaddv_u8 (vget_high_u8 (masked)) << 8);
+}
+
+guint32
+gibbon_position_kernel_differ (const gint8 a[26], const gint8 b[26])
+{
+        guint32 lo, hi;
+
+        lo = gibbon_position_kernel_movemask (vceqq_s8 (vld1q_s8 (a),
+                                                        vld1q_s8 (b)));
+        hi = gibbon_position_kernel_movemask (vceqq_s8 (vld1q_s8 (a + 10),
+                                                        vld1q_s8 (b + 10)));
+
+        return ~(lo | (hi << 10)) & GIBBON_POSITION_KERNEL_MASK;
+}
+
+guint32
+gibbon_position_kernel_decreased (const gint8 before[26],
+                                  const gint8 after[26])
+{
+        guint32 lo, hi;
+
+        lo = gibbon_position_kernel_movemask (vcgtq_s8 (vld1q_s8 (before),
+                                                        vld1q_s8 (after)));
+        hi = gibbon_position_kernel_movemask (
+                vcgtq_s8 (vld1q_s8 (before + 10), vld1q_s8 (after + 10)));
+
+        return lo | (hi << 10);
+}
+
+/* The own checkers in both vectors, with the lanes masked out that must
+ * not be counted.
+ */
+static inline void
+gibbon_position_kernel_own (const gint8 board[26], int8x16_t *lo,
+                            int8x16_t *hi)
+{
+        static const gint8 lo_lanes[16] = {
+                0, -1, -1, -1, -1, -1, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1
+        };
+        static const gint8 hi_lanes[16] = {
+                0, 0, 0, 0, 0, 0, -1, -1,
+                -1, -1, -1, -1, -1, -1, -1, -1
+        };
+        const int8x16_t zero = vdupq_n_s8 (0);
+
+        *lo = vandq_s8 (vmaxq_s8 (vld1q_s8 (board), zero),
+                        vld1q_s8 (lo_lanes));
+        *hi = vandq_s8 (vmaxq_s8 (vld1q_s8 (board + 10), zero),
+                        vld1q_s8 (hi_lanes));
+}
+
+guint
+gibbon_position_kernel_pips (const gint8 board[26])
+{
+        static const gint16 weights[32] = {
+                 0,  1,  2,  3,  4,  5,  6,  7,
+                 8,  9, 10, 11, 12, 13, 14, 15,
+                10, 11, 12, 13, 14, 15, 16, 17,
+                18, 19, 20, 21, 22, 23, 24, 25
+        };
+        int8x16_t lo, hi;
+        int32x4_t sum;
+
+        gibbon_position_kernel_own (board, &lo, &hi);
+
+        sum = vpaddlq_s16 (vmulq_s16 (vmovl_s8 (vget_low_s8 (lo)),
+                                      vld1q_s16 (weights)));
+        sum = vpadalq_s16 (sum, vmulq_s16 (vmovl_s8 (vget_high_s8 (lo)),
+                                           vld1q_s16 (weights + 8)));
+        sum = vpadalq_s16 (sum, vmulq_s16 (vmovl_s8 (vget_low_s8 (hi)),
+                                           vld1q_s16 (weights + 16)));
+        sum = vpadalq_s16 (sum, vmulq_s16 (vmovl_s8 (vget_high_s8 (hi)),
+                                           vld1q_s16 (weights + 24)));
+
+        return vaddvq_s32 (sum);
+}
+
+guint
+gibbon_position_kernel_checkers (const gint8 board[26])
+{
+        int8x16_t lo, hi;
+
+        gibbon_position_kernel_own (board, &lo, &hi);
+
+        return vaddlvq_s8 (lo) + vaddlvq_s8 (hi);
+}
+
+#else
+
+const gchar *
+gibbon_position_kernels_name (void)
+{
+        return "scalar";
+}
+
+guint32
+gibbon_position_kernel_differ (const gint8 a[26], const gint8 b[26])
+{
+        return gibbon_position_kernel_differ_scalar (a, b);
+}
+
+guint32
+gibbon_position_kernel_decreased (const gint8 before[26],
+                                  const gint8 after[26])
+{
+        return gibbon_position_kernel_decreased_scalar (before, after);
+}
+
+guint
+gibbon_position_kernel_pips (const gint8 board[26])
+{
+        return gibbon_position_kernel_pips_scalar (board);
+}
+
+guint
+gibbon_position_kernel_checkers (const gint8 board[26])
+{
+        return gibbon_position_kernel_checkers_scalar (board);
+}
+
+#endif
+
+guint32
+gibbon_position_kernel_differ_scalar (const gint8 a[26], const gint8 b[26])
+{
+        guint32 mask = 0;
+        gint i;
+
+        for (i = 0; i < 26; ++i)
+                if (a[i] != b[i])
+                        mask |= 1 << i;
+
+        return mask;
+}
+
+guint32
+gibbon_position_kernel_decreased_scalar (const gint8 before[26],
+                                         const gint8 after[26])
+{
+        guint32 mask = 0;
+        gint i;
+
+        for (i = 0; i < 26; ++i)
+                if (after[i] < before[i])
+                        mask |= 1 << i;
+
+        return mask;
+}
+
+guint
+gibbon_position_kernel_pips_scalar (const gint8 board[26])
+{
+        guint pips = 0;
+        gint i;
+
+        for (i = 1; i <= 25; ++i)
+                if (board[i] > 0)
+                        pips += i * board[i];
+
+        return pips;
+}
+
+guint
+gibbon_position_kernel_checkers_scalar (const gint8 board[26])
+{
+        guint checkers = 0;
+        gint i;
+
+        for (i = 1; i <= 25; ++i)
+                if (board[i] > 0)
+                        checkers += board[i];
+
+        return checkers;
+}
@@ -0,0 +1,56 @@
+/*
+ * This file is part of gibbon.
+ * Gibbon is a Gtk+ frontend for the First Internet Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GIBBON_POSITION_KERNELS_H
+# define _GIBBON_POSITION_KERNELS_H
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Kernels operating on the side-relative gint8 boards of a GibbonPosition,
+ * see gibbon_position_get_board().  Bit i of a returned mask stands for
+ * index i of the board.
+ *
+ * The kernels use SSE2 or NEON, where available.  The _scalar variants
+ * are the portable reference implementations.
+ */
+const gchar *gibbon_position_kernels_name (void);
+
+guint32 gibbon_position_kernel_differ (const gint8 a[26], const gint8 b[26]);
+guint32 gibbon_position_kernel_decreased (const gint8 before[26],
+                                          const gint8 after[26]);
+guint gibbon_position_kernel_pips (const gint8 board[26]);
+guint gibbon_position_kernel_checkers (const gint8 board[26]);
+
+guint32 gibbon_position_kernel_differ_scalar (const gint8 a[26],
+                                              const gint8 b[26]);
+guint32 gibbon_position_kernel_decreased_scalar (const gint8 before[26],
+                                                 const gint8 after[26]);
+guint gibbon_position_kernel_pips_scalar (const gint8 board[26]);
+guint gibbon_position_kernel_checkers_scalar (const gint8 board[26]);
+
+G_END_DECLS
+
+#endif
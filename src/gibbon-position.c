@@ -58,17 +58,107 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <glib.h>
 #include <glib/gi18n.h>
 
 #include "gibbon-position.h"
+#include "gibbon-position-kernels.h"
+#include "gibbon-bearoff.h"
 #include "gibbon-util.h"
 #include "gibbon-move.h"
 
 G_DEFINE_BOXED_TYPE (GibbonPosition, gibbon_position,            \
                      gibbon_position_copy, gibbon_position_free)
 
+/* State of gibbon_position_legal_moves().  */
+typedef struct _GibbonMoveGenerator GibbonMoveGenerator;
+struct _GibbonMoveGenerator
+{
+        guint dice[4];
+        gsize num_dice;
+        gboolean is_double;
+
+        GibbonMovement path[4];
+
+        gsize best_depth;
+        gint best_die;
+
+        GibbonLegalMove *moves;
+        gsize max_moves;
+        gsize num_moves;
+};
+
+/*
+ * A candidate of gibbon_position_check_move().  Candidates live on the
+ * stack, only the final result is turned into a GibbonMove.  The largest
+ * move pattern table has 15 entries.
+ */
+#define GIBBON_POSITION_MAX_CANDIDATES 16
+typedef struct _GibbonMoveCandidate GibbonMoveCandidate;
+struct _GibbonMoveCandidate
+{
+        gsize number;
+        GibbonMovement movements[4];
+        GibbonMoveError status;
+};
+
+/*
+ * Key of the legality cache of gibbon_position_check_move().  The boards
+ * are side-relative, so that equivalent moves of both sides share their
+ * entries.
+ */
+typedef struct _GibbonLegalityKey GibbonLegalityKey;
+struct _GibbonLegalityKey
+{
+        gint8 before[26];
+        gint8 after[26];
+        guint32 dice[2];
+};
+
+typedef struct _GibbonLegalityEntry GibbonLegalityEntry;
+struct _GibbonLegalityEntry
+{
+        GibbonLegalityKey key;
+        GList link;
+
+        guint die1, die2;
+        gsize number;
+        GibbonMovement movements[4];
+        GibbonMoveError status;
+};
+
+G_STATIC_ASSERT (sizeof (GibbonLegalityKey) == 60);
+
+G_LOCK_DEFINE_STATIC (legality_cache);
+static GHashTable *legality_cache = NULL;
+static GQueue legality_cache_lru = G_QUEUE_INIT;
+static gsize legality_cache_size = GIBBON_POSITION_LEGALITY_CACHE_SIZE;
+static guint64 legality_cache_hits = 0;
+static guint64 legality_cache_misses = 0;
+
+/*
+ * The player names, the game info and the status of all positions are
+ * interned in a pool of reference counted strings, so that copying a
+ * position does not copy the strings.  The reference count is stored
+ * in front of the characters.
+ */
+typedef struct _GibbonPositionString GibbonPositionString;
+struct _GibbonPositionString
+{
+        volatile gint ref_count;
+        gchar string[1];
+};
+
+#define GIBBON_POSITION_STRING(s) \
+        ((GibbonPositionString *) ((s) \
+                - G_STRUCT_OFFSET (GibbonPositionString, string)))
+
+G_LOCK_DEFINE_STATIC (string_pool);
+static GHashTable *string_pool = NULL;
+static gsize string_pool_bytes = 0;
+
 static GibbonPosition initial = {
                 /* match_length */
                 0,
@@ -175,34 +265,153 @@ guint move_patterns4[] = {
                 0x31211101
 };
 
+G_STATIC_ASSERT (G_N_ELEMENTS (move_patterns1)
+                 <= GIBBON_POSITION_MAX_CANDIDATES);
+G_STATIC_ASSERT (G_N_ELEMENTS (move_patterns2)
+                 <= GIBBON_POSITION_MAX_CANDIDATES);
+G_STATIC_ASSERT (G_N_ELEMENTS (move_patterns3)
+                 <= GIBBON_POSITION_MAX_CANDIDATES);
+
 #if (0)
 static void dump_move (const GibbonMove *move);
 #endif
 
-static void gibbon_position_fill_movement (GibbonMove *move,
+static void gibbon_position_fill_movement (GibbonMoveCandidate *candidate,
                                            guint point, guint die);
-static GList *gibbon_position_find_double (const gint *before,
-                                           const gint *after,
-                                           guint die,
-                                           gsize num_froms,
-                                           const guint *froms);
-static GList *gibbon_position_find_non_double (const gint *before,
-                                               const gint *after,
-                                               guint die1, guint die2,
-                                               gsize num_froms,
-                                               const guint *froms);
-static gboolean gibbon_position_is_diff (const gint before[26],
-                                         const gint after[26],
-                                         GibbonMove *move);
-static gboolean gibbon_position_can_move (const gint board[26], gint die);
-static gboolean gibbon_position_can_move_checker (const gint board[26],
+static gsize gibbon_position_find_double (guint die,
+                                          gsize num_froms,
+                                          const guint *froms,
+                                          GibbonMoveCandidate *candidates);
+static gsize gibbon_position_find_non_double (guint die1, guint die2,
+                                              gsize num_froms,
+                                              const guint *froms,
+                                              GibbonMoveCandidate *candidates);
+static gboolean gibbon_position_is_diff (const gint8 before[26],
+                                         const gint8 after[26],
+                                         GibbonMoveCandidate *candidate);
+static GibbonMove *gibbon_position_new_move (guint die1, guint die2,
+                                             GibbonMoveError status);
+static const gint8 *gibbon_position_normalized (const GibbonPosition *self,
+                                                GibbonPositionSide side,
+                                                gint8 board[26]);
+static GibbonMove *gibbon_position_check_move_uncached (
+        const GibbonPosition *before, const GibbonPosition *after,
+        GibbonPositionSide side);
+static void gibbon_position_trim_legality_cache (void);
+static guint gibbon_position_legality_key_hash (gconstpointer key);
+static gboolean gibbon_position_legality_key_equal (gconstpointer a,
+                                                    gconstpointer b);
+static gboolean gibbon_position_can_move (const gint8 board[26], gint die);
+static gboolean gibbon_position_can_move_checker (const gint8 board[26],
                                                   gint point,
                                                   gint die, gint backmost);
-static gboolean gibbon_position_can_move2 (gint board[26],
+static gboolean gibbon_position_can_move2 (gint8 board[26],
                                            gint die1, gint die2);
-static gint find_backmost_checker (const gint board[26]);
+static gint find_backmost_checker (const gint8 board[26]);
 static void swap_movements (GibbonMovement *m1, GibbonMovement *m2);
-static void order_movements (GibbonMove *move);
+static void order_movements (GibbonMoveCandidate *candidate);
+static void gibbon_position_generate (GibbonMoveGenerator *gen,
+                                      gint8 board[26], gsize depth,
+                                      gint max_from);
+static void gibbon_position_record_move (GibbonMoveGenerator *gen,
+                                         const gint8 board[26], gsize depth);
+
+/*
+ * Return a new reference to the interned copy of @string.  All decrements
+ * of a reference count happen with the lock held, so that a string that
+ * is about to be released is never resurrected by a lookup.
+ */
+static gchar *
+gibbon_position_string_intern (const gchar *string)
+{
+        GibbonPositionString *interned;
+        gsize length;
+
+        if (!string)
+                return NULL;
+
+        G_LOCK (string_pool);
+
+        if (!string_pool)
+                string_pool = g_hash_table_new (g_str_hash, g_str_equal);
+
+        interned = g_hash_table_lookup (string_pool, string);
+        if (interned) {
+                g_atomic_int_inc (&interned->ref_count);
+        } else {
+                length = strlen (string);
+                interned = g_malloc (sizeof *interned + length);
+                interned->ref_count = 1;
+                memcpy (interned->string, string, length + 1);
+                g_hash_table_insert (string_pool, interned->string, interned);
+                string_pool_bytes += length + 1;
+        }
+
+        G_UNLOCK (string_pool);
+
+        return interned->string;
+}
+
+/* Like gibbon_position_string_intern() but frees @string.  */
+static gchar *
+gibbon_position_string_take (gchar *string)
+{
+        gchar *interned = gibbon_position_string_intern (string);
+
+        g_free (string);
+
+        return interned;
+}
+
+/* Lock-free because the caller already owns a reference.  */
+static inline gchar *
+gibbon_position_string_ref (gchar *string)
+{
+        if (string)
+                g_atomic_int_inc (&GIBBON_POSITION_STRING (string)->ref_count);
+
+        return string;
+}
+
+static void
+gibbon_position_string_unref (gchar *string)
+{
+        GibbonPositionString *interned;
+
+        if (!string)
+                return;
+
+        interned = GIBBON_POSITION_STRING (string);
+
+        G_LOCK (string_pool);
+        if (g_atomic_int_dec_and_test (&interned->ref_count)) {
+                g_hash_table_remove (string_pool, string);
+                string_pool_bytes -= strlen (string) + 1;
+                g_free (interned);
+        }
+        G_UNLOCK (string_pool);
+}
+
+/**
+ * gibbon_position_get_string_pool_stats:
+ * @strings: Return location for the number of interned strings or %NULL.
+ * @bytes: Return location for the size of the interned strings or %NULL.
+ *
+ * Retrieve the statistics of the pool that the player names, game infos,
+ * and status strings of all positions are interned in.
+ */
+void
+gibbon_position_get_string_pool_stats (gsize *strings, gsize *bytes)
+{
+        G_LOCK (string_pool);
+
+        if (strings)
+                *strings = string_pool ? g_hash_table_size (string_pool) : 0;
+        if (bytes)
+                *bytes = string_pool_bytes;
+
+        G_UNLOCK (string_pool);
+}
 
 /**
  * gibbon_position_new:
@@ -227,16 +436,17 @@ gibbon_position_new (void)
  * gibbon_position_free:
  *
  * Free all resources associated with the #GibbonPosition.  Note that this
- * function calls g_free() with the player names if not %NULL.
+ * function releases the player names, the game info, and the status
+ * if not %NULL.
  */
 void
 gibbon_position_free (GibbonPosition *self)
 {
         if (self) {
-                g_free (self->players[0]);
-                g_free (self->players[1]);
-                g_free (self->game_info);
-                g_free (self->status);
+                gibbon_position_string_unref (self->players[0]);
+                gibbon_position_string_unref (self->players[1]);
+                gibbon_position_string_unref (self->game_info);
+                gibbon_position_string_unref (self->status);
                 g_free (self);
         }
 }
@@ -245,9 +455,8 @@ gibbon_position_free (GibbonPosition *self)
  * gibbon_position_copy:
  * @self: the original #GibbonPosition.
  *
- * Creates an exact copy of @self.  If player names were set, they are
- * identical in the copy but will use new buffers that can be freed with
- * g_free().
+ * Creates an exact copy of @self.  The player names, the game info, and
+ * the status are interned strings that are shared with @self.
  *
  * Returns: The copied #GibbonPosition or %NULL if @self was %NULL;
  */
@@ -260,35 +469,108 @@ gibbon_position_copy (const GibbonPosition *self)
 
         copy = g_malloc (sizeof *self);
         *copy = *self;
-        copy->players[0] = g_strdup (copy->players[0]);
-        copy->players[1] = g_strdup (copy->players[1]);
-        copy->game_info = g_strdup (copy->game_info);
-        copy->status = g_strdup (copy->status);
+        gibbon_position_string_ref (copy->players[0]);
+        gibbon_position_string_ref (copy->players[1]);
+        gibbon_position_string_ref (copy->game_info);
+        gibbon_position_string_ref (copy->status);
 
         return copy;
 }
 
+/**
+ * gibbon_position_set_player:
+ * @self: The #GibbonPosition.
+ * @name: The new name of the player or %NULL.
+ * @side: %GIBBON_POSITION_SIDE_WHITE or %GIBBON_POSITION_SIDE_BLACK.
+ *
+ * Set the name of a player.  The fields for the player names, the game
+ * info, and the status must only be modified with the setters because
+ * the strings are shared between positions.
+ */
+void
+gibbon_position_set_player (GibbonPosition *self, const gchar *name,
+                            GibbonPositionSide side)
+{
+        gchar **player;
+
+        g_return_if_fail (self != NULL);
+        g_return_if_fail (side != GIBBON_POSITION_SIDE_NONE);
+
+        player = &self->players[side == GIBBON_POSITION_SIDE_WHITE ? 0 : 1];
+        if (*player == name)
+                return;
+
+        gibbon_position_string_unref (*player);
+        *player = gibbon_position_string_intern (name);
+}
+
+/**
+ * gibbon_position_set_game_info:
+ * @self: The #GibbonPosition.
+ * @game_info: The new game info or %NULL.
+ *
+ * Set the free-form game info.
+ */
+void
+gibbon_position_set_game_info (GibbonPosition *self, const gchar *game_info)
+{
+        g_return_if_fail (self != NULL);
+
+        if (self->game_info == game_info)
+                return;
+
+        gibbon_position_string_unref (self->game_info);
+        self->game_info = gibbon_position_string_intern (game_info);
+}
+
+/**
+ * gibbon_position_set_status:
+ * @self: The #GibbonPosition.
+ * @status: The new status or %NULL.
+ *
+ * Set the free-form status.
+ */
+void
+gibbon_position_set_status (GibbonPosition *self, const gchar *status)
+{
+        g_return_if_fail (self != NULL);
+
+        if (self->status == status)
+                return;
+
+        gibbon_position_string_unref (self->status);
+        self->status = gibbon_position_string_intern (status);
+}
+
+/**
+ * gibbon_position_take_status:
+ * @self: The #GibbonPosition.
+ * @status: The new status or %NULL.
+ *
+ * Like gibbon_position_set_status() but frees @status with g_free().
+ */
+void
+gibbon_position_take_status (GibbonPosition *self, gchar *status)
+{
+        g_return_if_fail (self != NULL);
+
+        gibbon_position_string_unref (self->status);
+        self->status = gibbon_position_string_take (status);
+}
+
 guint
 gibbon_position_get_borne_off (const GibbonPosition *self,
                                GibbonPositionSide side)
 {
+        gint8 buffer[26];
+        const gint8 *board;
         gint checkers = 15;
-        guint i;
 
         if (!side)
                 return 0;
 
-        for (i = 0; i < 24; ++i) {
-                if (side < 0 && self->points[i] < 0)
-                        checkers += self->points[i];
-                else if (side > 0 && self->points[i] > 0)
-                        checkers -= self->points[i];
-        }
-
-        if (side < 0)
-                checkers -= self->bar[1];
-        else if (side > 0)
-                checkers -= self->bar[0];
+        board = gibbon_position_normalized (self, side, buffer);
+        checkers -= (gint) gibbon_position_kernel_checkers (board);
 
         if (checkers < 0)
                 checkers = 0;
@@ -300,139 +582,375 @@ guint
 gibbon_position_get_pip_count (const GibbonPosition *self,
                                GibbonPositionSide side)
 {
-        guint pips = 0;
-        guint i;
+        gint8 buffer[26];
+        const gint8 *board;
 
         if (!side)
                 return 0;
 
-        if (side < 0) {
-                for (i = 0; i < 24; ++i) {
-                        if (self->points[i] < 0)
-                                pips -= (24 - i) * self->points[i];
-                }
-                pips += 25 * self->bar[1];
-        } else {
-                for (i = 0; i < 24; ++i) {
-                        if (self->points[i] > 0)
-                                pips += (i + 1) * self->points[i];
-                }
-                pips += 25 * self->bar[0];
+        board = gibbon_position_normalized (self, side, buffer);
+
+        return gibbon_position_kernel_pips (board);
+}
+
+/* Fill @counts with the checkers of @side in the home board.  Returns
+ * FALSE, if @side has checkers outside of the home board.
+ */
+static gboolean
+gibbon_position_get_bearoff_counts (const GibbonPosition *self,
+                                    GibbonPositionSide side,
+                                    guint counts[GIBBON_BEAROFF_POINTS])
+{
+        gint8 buffer[26];
+        const gint8 *board = gibbon_position_normalized (self, side, buffer);
+        guint checkers = 0;
+        gint i;
+
+        for (i = 0; i < GIBBON_BEAROFF_POINTS; ++i) {
+                counts[i] = board[i + 1] > 0 ? board[i + 1] : 0;
+                checkers += counts[i];
         }
 
-        return pips;
+        return checkers == gibbon_position_kernel_checkers (board);
+}
+
+/**
+ * gibbon_position_get_bearoff_rolls:
+ * @self: The #GibbonPosition.
+ * @side: The side to check.
+ *
+ * Look up the expected number of rolls that @side needs in order to bear
+ * off all checkers in the one-sided bear-off database.
+ *
+ * Returns: The expected number of rolls or a negative number if @side
+ *          has checkers outside of the home board.
+ */
+gdouble
+gibbon_position_get_bearoff_rolls (const GibbonPosition *self,
+                                   GibbonPositionSide side)
+{
+        guint counts[GIBBON_BEAROFF_POINTS];
+
+        g_return_val_if_fail (self != NULL, -1.0);
+        g_return_val_if_fail (side != GIBBON_POSITION_SIDE_NONE, -1.0);
+
+        if (!gibbon_position_get_bearoff_counts (self, side, counts))
+                return -1.0;
+
+        return gibbon_bearoff_expected_rolls (counts);
+}
+
+/**
+ * gibbon_position_get_bearoff_win:
+ * @self: The #GibbonPosition.
+ * @side: The side on roll.
+ *
+ * Look up the cubeless probability that @side wins the game, when on
+ * roll.  This is only possible, if both sides have all their remaining
+ * checkers in their home boards.
+ *
+ * Returns: The probability or a negative number if the position is not
+ *          a bear-off position.
+ */
+gdouble
+gibbon_position_get_bearoff_win (const GibbonPosition *self,
+                                 GibbonPositionSide side)
+{
+        guint on_roll[GIBBON_BEAROFF_POINTS];
+        guint opponent[GIBBON_BEAROFF_POINTS];
+
+        g_return_val_if_fail (self != NULL, -1.0);
+        g_return_val_if_fail (side != GIBBON_POSITION_SIDE_NONE, -1.0);
+
+        if (!gibbon_position_get_bearoff_counts (self, side, on_roll)
+            || !gibbon_position_get_bearoff_counts (self, -side, opponent))
+                return -1.0;
+
+        return gibbon_bearoff_win_probability (on_roll, opponent);
 }
 
+/**
+ * gibbon_position_check_move:
+ * @before: The position before the move, including the dice.
+ * @after: The position after the move.
+ * @side: The side that moved.
+ *
+ * Find the move that leads from @before to @after, and check whether it
+ * is legal.  Results are memoized in a bounded cache, see
+ * gibbon_position_set_legality_cache_size().
+ *
+ * Returns: A new #GibbonMove, the status tells whether it is legal.
+ */
 GibbonMove *
-gibbon_position_check_move (const GibbonPosition *_before,
-                            const GibbonPosition *_after,
+gibbon_position_check_move (const GibbonPosition *before,
+                            const GibbonPosition *after,
                             GibbonPositionSide side)
 {
-        GibbonMove *move, *this_move;
-        GList *found;
-        gint before[26];
-        gint after[26];
-        gint i, tmp;
+        GibbonLegalityKey key;
+        GibbonLegalityEntry *entry;
+        GibbonMove *move;
+
+        if (!before || !after || !side || !before->dice[0] || !before->dice[1])
+                return gibbon_position_check_move_uncached (before, after,
+                                                            side);
+
+        (void) gibbon_position_normalized (before, side, key.before);
+        (void) gibbon_position_normalized (after, side, key.after);
+        key.dice[0] = before->dice[0];
+        key.dice[1] = before->dice[1];
+
+        G_LOCK (legality_cache);
+        if (legality_cache_size) {
+                if (!legality_cache)
+                        legality_cache = g_hash_table_new_full (
+                                gibbon_position_legality_key_hash,
+                                gibbon_position_legality_key_equal,
+                                NULL, g_free);
+                entry = g_hash_table_lookup (legality_cache, &key);
+                if (entry) {
+                        ++legality_cache_hits;
+                        g_queue_unlink (&legality_cache_lru, &entry->link);
+                        g_queue_push_head_link (&legality_cache_lru,
+                                                &entry->link);
+                        move = gibbon_move_new (entry->die1, entry->die2,
+                                                entry->number);
+                        move->number = entry->number;
+                        if (entry->number)
+                                memcpy (move->movements, entry->movements,
+                                        entry->number
+                                        * sizeof *entry->movements);
+                        move->status = entry->status;
+                        G_UNLOCK (legality_cache);
+
+                        return move;
+                }
+                ++legality_cache_misses;
+        }
+        G_UNLOCK (legality_cache);
+
+        move = gibbon_position_check_move_uncached (before, after, side);
+
+        G_LOCK (legality_cache);
+        if (legality_cache && !g_hash_table_lookup (legality_cache, &key)) {
+                entry = g_new (GibbonLegalityEntry, 1);
+                entry->key = key;
+                entry->link.data = entry;
+                entry->link.prev = entry->link.next = NULL;
+                entry->die1 = move->die1;
+                entry->die2 = move->die2;
+                entry->number = MIN (move->number, 4);
+                if (entry->number)
+                        memcpy (entry->movements, move->movements,
+                                entry->number * sizeof *entry->movements);
+                entry->status = move->status;
+                g_hash_table_insert (legality_cache, &entry->key, entry);
+                g_queue_push_head_link (&legality_cache_lru, &entry->link);
+                gibbon_position_trim_legality_cache ();
+        }
+        G_UNLOCK (legality_cache);
+
+        return move;
+}
+
+/**
+ * gibbon_position_set_legality_cache_size:
+ * @max_entries: The maximum number of cached results, 0 to disable the
+ *               cache.
+ *
+ * Change the size of the cache used by gibbon_position_check_move().  The
+ * default is %GIBBON_POSITION_LEGALITY_CACHE_SIZE.  Tests that exercise
+ * the move checking code should disable the cache.
+ */
+void
+gibbon_position_set_legality_cache_size (gsize max_entries)
+{
+        G_LOCK (legality_cache);
+
+        legality_cache_size = max_entries;
+        if (legality_cache) {
+                gibbon_position_trim_legality_cache ();
+                if (!max_entries) {
+                        g_hash_table_destroy (legality_cache);
+                        legality_cache = NULL;
+                }
+        }
+
+        G_UNLOCK (legality_cache);
+}
+
+/**
+ * gibbon_position_get_legality_cache_stats:
+ * @hits: Return location for the number of cache hits or %NULL.
+ * @misses: Return location for the number of cache misses or %NULL.
+ * @entries: Return location for the number of cached results or %NULL.
+ *
+ * Retrieve the statistics of the cache used by
+ * gibbon_position_check_move().  The counters are cumulative since the
+ * program started or since gibbon_position_reset_legality_cache_stats().
+ */
+void
+gibbon_position_get_legality_cache_stats (guint64 *hits, guint64 *misses,
+                                          gsize *entries)
+{
+        G_LOCK (legality_cache);
+
+        if (hits)
+                *hits = legality_cache_hits;
+        if (misses)
+                *misses = legality_cache_misses;
+        if (entries)
+                *entries = legality_cache_lru.length;
+
+        G_UNLOCK (legality_cache);
+}
+
+/**
+ * gibbon_position_reset_legality_cache_stats:
+ *
+ * Reset the hit and miss counters of the legality cache.
+ */
+void
+gibbon_position_reset_legality_cache_stats (void)
+{
+        G_LOCK (legality_cache);
+        legality_cache_hits = legality_cache_misses = 0;
+        G_UNLOCK (legality_cache);
+}
+
+/* Must be called with the lock held.  */
+static void
+gibbon_position_trim_legality_cache (void)
+{
+        GList *link;
+        GibbonLegalityEntry *entry;
+
+        while (legality_cache_lru.length > legality_cache_size) {
+                link = g_queue_pop_tail_link (&legality_cache_lru);
+                entry = link->data;
+                g_hash_table_remove (legality_cache, &entry->key);
+        }
+}
+
+static guint
+gibbon_position_legality_key_hash (gconstpointer _key)
+{
+        const GibbonLegalityKey *key = _key;
+        const guint8 *bytes = (const guint8 *) key;
+        guint32 hash = 2166136261U;
+        gsize i;
+
+        /* FNV-1a.  */
+        for (i = 0; i < sizeof *key; ++i) {
+                hash ^= bytes[i];
+                hash *= 16777619U;
+        }
+
+        return hash;
+}
+
+static gboolean
+gibbon_position_legality_key_equal (gconstpointer a, gconstpointer b)
+{
+        return !memcmp (a, b, sizeof (GibbonLegalityKey));
+}
+
+static GibbonMove *
+gibbon_position_check_move_uncached (const GibbonPosition *_before,
+                                     const GibbonPosition *_after,
+                                     GibbonPositionSide side)
+{
+        GibbonMove *move;
+        GibbonMoveCandidate candidates[GIBBON_POSITION_MAX_CANDIDATES];
+        GibbonMoveCandidate *candidate, *best = NULL;
+        gsize num_candidates, n;
+        gint8 before[26];
+        gint8 after_buffer[26];
+        const gint8 *after;
+        gint i;
         guint num_froms = 0;
         guint froms[4];
+        guint32 decreased;
         guint die1, die2, this_die, other_die;
-        GList *iter;
 
         die1 = _before->dice[0];
         die2 = _before->dice[1];
-        move = gibbon_move_new (die1, die2, 0);
-        move->status = GIBBON_MOVE_ILLEGAL;
 
-        g_return_val_if_fail (die1 != 0, move);
-        g_return_val_if_fail (die2 != 0, move);
-        g_return_val_if_fail (side != GIBBON_POSITION_SIDE_NONE, move);
-
-        /* This structure is handier for us.  It would probably be easier
-         * if we also change GibbonPosition accordingly.
+        g_return_val_if_fail (die1 != 0,
+                              gibbon_position_new_move (die1, die2,
+                                                        GIBBON_MOVE_ILLEGAL));
+        g_return_val_if_fail (die2 != 0,
+                              gibbon_position_new_move (die1, die2,
+                                                        GIBBON_MOVE_ILLEGAL));
+        g_return_val_if_fail (side != GIBBON_POSITION_SIDE_NONE,
+                              gibbon_position_new_move (die1, die2,
+                                                        GIBBON_MOVE_ILLEGAL));
+
+        /* The board before gets modified temporarily.  */
+        (void) gibbon_position_normalized (_before, side, before);
+        after = gibbon_position_normalized (_after, side, after_buffer);
+
+        /* Find the number of possible starting points.  Index 0 is the
+         * opponent's bar.
          */
-        memcpy (before + 1, _before->points, 24 * sizeof *before);
-        memcpy (after + 1, _after->points, 24 * sizeof *after);
-        if (side > 0) {
-                before[0] = _before->bar[1];
-                after[0] = _after->bar[1];
-                before[25] = _before->bar[0];
-                after[25] = _after->bar[0];
-        } else {
-                /* "Normalize" the board representation.  Negative
-                 * checker counts are ours, positive ones are hers.
-                 */
-                before[0] = _before->bar[0];
-                after[0] = _after->bar[0];
-                for (i = 1; i <= 24; ++i) {
-                        before[i] = -before[i];
-                        after[i] = -after[i];
-                }
-
-                /* And swap the direction.  */
-                for (i = 1; i <= 12; ++i) {
-                        tmp = before[25 - i];
-                        before[25 - i] = before[i];
-                        before[i] = tmp;
-                        tmp = after[25 - i];
-                        after[25 - i] = after[i];
-                        after[i] = tmp;
-                }
-                before[25] = _before->bar[1];
-                after[25] = _after->bar[1];
-        }
-
-        /* Find the number of possible starting points.  */
-        for (i = 25; i >= 1; --i) {
-                if (after[i] < before[i]) {
-                        froms[num_froms++] = i;
-                        /* More than four are always illegal.  */
-                        if (num_froms > 4) {
-                                move->status = GIBBON_MOVE_TOO_MANY_MOVES;
-                                return move;
-                        }
-                }
+        decreased = gibbon_position_kernel_decreased (before, after) & ~1;
+        for (i = g_bit_nth_msf (decreased, -1); i >= 1;
+             i = g_bit_nth_msf (decreased, i)) {
+                /* More than four are always illegal.  */
+                if (num_froms == 4)
+                        return gibbon_position_new_move (
+                                die1, die2,
+                                GIBBON_MOVE_TOO_MANY_MOVES);
+                froms[num_froms++] = i;
         }
 
         /* Find candidate moves.  */
         if (die1 == die2) {
-                found = gibbon_position_find_double (before, after,
-                                                     die1,
-                                                     num_froms, froms);
+                num_candidates = gibbon_position_find_double (die1,
+                                                              num_froms, froms,
+                                                              candidates);
         } else {
-                found = gibbon_position_find_non_double (before, after,
-                                                         die1, die2,
-                                                         num_froms, froms);
+                num_candidates = gibbon_position_find_non_double (die1, die2,
+                                                                  num_froms,
+                                                                  froms,
+                                                                  candidates);
+                /* The candidates use the lower die first.  */
+                if (die1 > die2) {
+                        this_die = die1;
+                        die1 = die2;
+                        die2 = this_die;
+                }
         }
 
-        iter = found;
-        while (iter) {
-                if (gibbon_position_is_diff (before, after,
-                                             (GibbonMove *) iter->data)) {
-                        this_move = (GibbonMove *) iter->data;
-
-                        if (this_move->status == GIBBON_MOVE_LEGAL
-                            || move->status == GIBBON_MOVE_ILLEGAL) {
-                                g_object_unref (move);
-                                move = this_move;
-                                iter->data = NULL;
-                        }
+        for (n = 0; n < num_candidates; ++n) {
+                candidate = candidates + n;
+                if (!gibbon_position_is_diff (before, after, candidate))
+                        continue;
 
-                        /* If this is a bear-off error, we keep on
-                         * searching for a possibly legal alternative.
-                         */
-                        if (this_move->status == GIBBON_MOVE_LEGAL
-                            || (move->status != GIBBON_MOVE_PREMATURE_BEAR_OFF
-                                && move->status != GIBBON_MOVE_ILLEGAL_WASTE))
-                                break;
-                }
-                iter = iter->next;
+                if (!best || candidate->status == GIBBON_MOVE_LEGAL
+                    || best->status == GIBBON_MOVE_ILLEGAL)
+                        best = candidate;
+
+                /* If this is a bear-off error, we keep on
+                 * searching for a possibly legal alternative.
+                 */
+                if (candidate->status == GIBBON_MOVE_LEGAL
+                    || (best->status != GIBBON_MOVE_PREMATURE_BEAR_OFF
+                        && best->status != GIBBON_MOVE_ILLEGAL_WASTE))
+                        break;
         }
-        /*
-         * We cannot use g_object_unref here because we may have set the
-         * data pointer to NULL for certain items.
-         */
-        g_list_foreach (found, (GFunc) gibbon_safe_object_unref, NULL);
-        g_list_free (found);
+
+        if (!best)
+                return gibbon_position_new_move (_before->dice[0],
+                                                 _before->dice[1],
+                                                 GIBBON_MOVE_ILLEGAL);
+
+        /* This is the only GibbonMove that gets allocated.  */
+        move = gibbon_move_new (die1, die2, best->number);
+        if (best->number)
+                memcpy (move->movements, best->movements,
+                        best->number * sizeof *best->movements);
+        move->number = best->number;
+        move->status = best->status;
 
         if (move->status != GIBBON_MOVE_LEGAL)
                 return move;
@@ -510,8 +1028,242 @@ gibbon_position_check_move (const GibbonPosition *_before,
         return move;
 }
 
+/**
+ * gibbon_position_get_board:
+ * @self: The #GibbonPosition.
+ * @side: The side to move.
+ * @board: The array to fill.
+ *
+ * Fill @board with the position from the perspective of @side.  Index
+ * 1 is the ace point of @side and index 24 its 24 point.  Checkers of
+ * @side are counted positive, those of the opponent negative.  Index 25
+ * holds the checkers of @side on the bar, index 0 those of the opponent
+ * (as a positive number).
+ */
+void
+gibbon_position_get_board (const GibbonPosition *self,
+                           GibbonPositionSide side, gint board[26])
+{
+        gint8 normalized[26];
+        gint i;
+
+        g_return_if_fail (self != NULL);
+        g_return_if_fail (side != GIBBON_POSITION_SIDE_NONE);
+
+        (void) gibbon_position_normalized (self, side, normalized);
+        for (i = 0; i < 26; ++i)
+                board[i] = normalized[i];
+}
+
+/*
+ * Fill @board like gibbon_position_get_board() but with the compact type
+ * that the kernels and the move generator use, and return it.  The board
+ * lives on the stack of the caller.  Computing it takes about as long as
+ * checking whether a cached copy in the position would still be valid.
+ */
+static const gint8 *
+gibbon_position_normalized (const GibbonPosition *self,
+                            GibbonPositionSide side, gint8 board[26])
+{
+        gint i;
+
+        if (side > 0) {
+                for (i = 1; i <= 24; ++i)
+                        board[i] = self->points[i - 1];
+                board[0] = self->bar[1];
+                board[25] = self->bar[0];
+        } else {
+                for (i = 1; i <= 24; ++i)
+                        board[i] = -self->points[24 - i];
+                board[0] = self->bar[0];
+                board[25] = self->bar[1];
+        }
+
+        return board;
+}
+
+/**
+ * gibbon_position_legal_moves:
+ * @self: The #GibbonPosition.
+ * @side: The side to move.
+ * @die1: The first die.
+ * @die2: The second die.
+ * @moves: Caller-provided array for the moves found.
+ * @max_moves: Number of elements in @moves.
+ *
+ * Enumerate all legal moves of @side for the roll @die1 and @die2.  Moves
+ * that result in the same position are only reported once.  If no checker
+ * can be moved, exactly one move with @number 0 is reported.
+ *
+ * The function does not allocate memory.  An array of
+ * %GIBBON_POSITION_MAX_LEGAL_MOVES elements is always big enough, moves
+ * that do not fit into a smaller array are dropped.
+ *
+ * Returns: The number of moves stored in @moves.
+ */
+gsize
+gibbon_position_legal_moves (const GibbonPosition *self,
+                             GibbonPositionSide side,
+                             guint die1, guint die2,
+                             GibbonLegalMove *moves, gsize max_moves)
+{
+        GibbonMoveGenerator gen;
+        gint8 board[26];
+
+        g_return_val_if_fail (self != NULL, 0);
+        g_return_val_if_fail (side != GIBBON_POSITION_SIDE_NONE, 0);
+        g_return_val_if_fail (die1 >= 1 && die1 <= 6, 0);
+        g_return_val_if_fail (die2 >= 1 && die2 <= 6, 0);
+        g_return_val_if_fail (moves != NULL || !max_moves, 0);
+
+        (void) gibbon_position_normalized (self, side, board);
+
+        memset (&gen, 0, sizeof gen);
+        gen.moves = moves;
+        gen.max_moves = max_moves;
+
+        if (die1 == die2) {
+                gen.is_double = TRUE;
+                gen.num_dice = 4;
+                gen.dice[0] = gen.dice[1] = gen.dice[2] = gen.dice[3] = die1;
+                gibbon_position_generate (&gen, board, 0, 25);
+        } else {
+                gen.num_dice = 2;
+                gen.dice[0] = die1;
+                gen.dice[1] = die2;
+                gibbon_position_generate (&gen, board, 0, 25);
+                gen.dice[0] = die2;
+                gen.dice[1] = die1;
+                gibbon_position_generate (&gen, board, 0, 25);
+        }
+
+        return gen.num_moves;
+}
+
+/*
+ * Depth-first search over the remaining dice.  The board is modified in
+ * place and restored before returning.  For doubles, the checkers are
+ * moved in the order of their starting points, so that permutations of
+ * the same movements are not visited again.
+ */
+static void
+gibbon_position_generate (GibbonMoveGenerator *gen, gint8 board[26],
+                          gsize depth, gint max_from)
+{
+        gint die, from, to, lowest;
+        gint backmost;
+        gint saved_to;
+        gboolean moved = FALSE;
+
+        if (depth == gen->num_dice) {
+                gibbon_position_record_move (gen, board, depth);
+                return;
+        }
+
+        die = gen->dice[depth];
+
+        /* Checkers on the bar have to come in first.  */
+        if (board[25] > 0) {
+                from = 25;
+                lowest = 25;
+        } else {
+                from = max_from < 24 ? max_from : 24;
+                lowest = 1;
+        }
+
+        backmost = find_backmost_checker (board);
+
+        for (; from >= lowest; --from) {
+                if (board[from] < 1)
+                        continue;
+
+                to = from - die;
+                if (to >= 1) {
+                        if (board[to] < -1)
+                                continue;
+                } else {
+                        /* Bear-off.  Wasting pips is only allowed for
+                         * the backmost checker.
+                         */
+                        if (backmost > 6)
+                                break;
+                        if (to < 0 && from != backmost)
+                                continue;
+                        to = 0;
+                }
+
+                saved_to = board[to];
+                --board[from];
+                if (to) {
+                        if (saved_to == -1) {
+                                board[to] = 0;
+                                ++board[0];
+                        }
+                        ++board[to];
+                }
+
+                gen->path[depth].from = from;
+                gen->path[depth].to = to;
+                gen->path[depth].die = die;
+                moved = TRUE;
+
+                gibbon_position_generate (gen, board, depth + 1,
+                                          gen->is_double ? from : 25);
+
+                ++board[from];
+                if (to) {
+                        board[to] = saved_to;
+                        if (saved_to == -1)
+                                --board[0];
+                }
+        }
+
+        if (!moved)
+                gibbon_position_record_move (gen, board, depth);
+}
+
+static void
+gibbon_position_record_move (GibbonMoveGenerator *gen, const gint8 board[26],
+                             gsize depth)
+{
+        gsize i;
+        GibbonLegalMove *move;
+
+        /* As many dice as possible must be used.  */
+        if (depth < gen->best_depth)
+                return;
+        if (depth > gen->best_depth) {
+                gen->best_depth = depth;
+                gen->best_die = 0;
+                gen->num_moves = 0;
+        }
+
+        /* If only one die can be used, it must be the higher one.  */
+        if (depth == 1 && !gen->is_double) {
+                if (gen->path[0].die < gen->best_die)
+                        return;
+                if (gen->path[0].die > gen->best_die) {
+                        gen->best_die = gen->path[0].die;
+                        gen->num_moves = 0;
+                }
+        }
+
+        for (i = 0; i < gen->num_moves; ++i)
+                if (!memcmp (board, gen->moves[i].board,
+                             sizeof gen->moves[i].board))
+                        return;
+
+        if (gen->num_moves >= gen->max_moves)
+                return;
+
+        move = gen->moves + gen->num_moves++;
+        move->number = depth;
+        memcpy (move->movements, gen->path, depth * sizeof *gen->path);
+        memcpy (move->board, board, sizeof move->board);
+}
+
 static gboolean
-gibbon_position_can_move (const gint board[26], gint die)
+gibbon_position_can_move (const gint8 board[26], gint die)
 {
         gint i;
         gint backmost;
@@ -546,7 +1298,7 @@ gibbon_position_can_move (const gint board[26], gint die)
 }
 
 static gboolean
-gibbon_position_can_move_checker (const gint board[26], gint point,
+gibbon_position_can_move_checker (const gint8 board[26], gint point,
                                   gint backmost, gint die)
 {
         if (board[point] < 1)
@@ -573,7 +1325,7 @@ gibbon_position_can_move_checker (const gint board[26], gint point,
 }
 
 static gboolean
-gibbon_position_can_move2 (gint board[26], gint die1, gint die2)
+gibbon_position_can_move2 (gint8 board[26], gint die1, gint die2)
 {
         gint i;
         gint backmost = 0;
@@ -645,10 +1397,10 @@ gibbon_position_can_move2 (gint board[26], gint die1, gint die2)
 }
 
 static gboolean
-gibbon_position_is_diff (const gint _before[26], const gint after[26],
-                         GibbonMove *move)
+gibbon_position_is_diff (const gint8 _before[26], const gint8 after[26],
+                         GibbonMoveCandidate *move)
 {
-        gint before[26];
+        gint8 before[26];
         gint i, from, to;
         const GibbonMovement *movement;
         gint backmost;
@@ -697,7 +1449,7 @@ gibbon_position_is_diff (const gint _before[26], const gint after[26],
                 --before[from];
         }
 
-        if (memcmp (before, after, sizeof before))
+        if (gibbon_position_kernel_differ (before, after))
                 return FALSE;
 
         /* At this point we know:
@@ -715,26 +1467,38 @@ gibbon_position_is_diff (const gint _before[26], const gint after[26],
 }
 
 static void
-gibbon_position_fill_movement (GibbonMove *move, guint point, guint die)
+gibbon_position_fill_movement (GibbonMoveCandidate *candidate,
+                               guint point, guint die)
+{
+        gsize movement_num = candidate->number;
+
+        candidate->movements[movement_num].from = point;
+        candidate->movements[movement_num].to = point - die;
+        if (candidate->movements[movement_num].to < 0)
+                candidate->movements[movement_num].to = 0;
+        candidate->movements[movement_num].die = die;
+        ++candidate->number;
+}
+
+static GibbonMoveCandidate *
+gibbon_position_add_candidate (GibbonMoveCandidate *candidates,
+                               gsize *num_candidates)
 {
-        guint movement_num = move->number;
+        GibbonMoveCandidate *candidate = candidates + (*num_candidates)++;
 
-        move->movements[movement_num].from = point;
-        move->movements[movement_num].to = point - die;
-        if (move->movements[movement_num].to < 0)
-                move->movements[movement_num].to = 0;
-        move->movements[movement_num].die = die;
-        ++move->number;
+        candidate->number = 0;
+        candidate->status = GIBBON_MOVE_LEGAL;
+
+        return candidate;
 }
 
-static GList *
-gibbon_position_find_non_double (const gint *before,
-                                 const gint *after,
-                                 guint _die1, guint _die2,
-                                 gsize num_froms, const guint *froms)
+static gsize
+gibbon_position_find_non_double (guint _die1, guint _die2,
+                                 gsize num_froms, const guint *froms,
+                                 GibbonMoveCandidate *candidates)
 {
-        GibbonMove *move;
-        GList *moves = NULL;
+        GibbonMoveCandidate *candidate;
+        gsize num_candidates = 0;
         guint die1, die2;
 
         if (_die1 < _die2) {
@@ -746,69 +1510,69 @@ gibbon_position_find_non_double (const gint *before,
         }
 
         if (!num_froms) {
-                move = gibbon_move_new (die1, die2, 0);
-                moves = g_list_append (moves, move);
+                gibbon_position_add_candidate (candidates, &num_candidates);
 
-                return moves;
+                return num_candidates;
         }
 
         /* Two possibilities.  */
         if (2 == num_froms) {
-                move = gibbon_move_new (die1, die2, 2);
-                gibbon_position_fill_movement (move, froms[0], die1);
-                gibbon_position_fill_movement (move, froms[1], die2);
-                moves = g_list_append (moves, move);
+                candidate = gibbon_position_add_candidate (candidates,
+                                                           &num_candidates);
+                gibbon_position_fill_movement (candidate, froms[0], die1);
+                gibbon_position_fill_movement (candidate, froms[1], die2);
 
-                move = gibbon_move_new (die1, die2, 2);
-                gibbon_position_fill_movement (move, froms[0], die2);
-                gibbon_position_fill_movement (move, froms[1], die1);
-                moves = g_list_append (moves, move);
+                candidate = gibbon_position_add_candidate (candidates,
+                                                           &num_candidates);
+                gibbon_position_fill_movement (candidate, froms[0], die2);
+                gibbon_position_fill_movement (candidate, froms[1], die1);
 
-                return moves;
+                return num_candidates;
         }
 
         /* Only one checker was moved.  This can happen in five distinct
          * ways.
          */
         if (froms[0] > die1) {
-                move = gibbon_move_new (die1, die2, 2);
-                gibbon_position_fill_movement (move, froms[0], die1);
-                gibbon_position_fill_movement (move, froms[0] - die1, die2);
-                moves = g_list_append (moves, move);
+                candidate = gibbon_position_add_candidate (candidates,
+                                                           &num_candidates);
+                gibbon_position_fill_movement (candidate, froms[0], die1);
+                gibbon_position_fill_movement (candidate, froms[0] - die1,
+                                               die2);
         }
         if (froms[0] > die2) {
-                move = gibbon_move_new (die1, die2, 2);
-                gibbon_position_fill_movement (move, froms[0], die2);
-                gibbon_position_fill_movement (move, froms[0] - die2, die1);
-                moves = g_list_append (moves, move);
+                candidate = gibbon_position_add_candidate (candidates,
+                                                           &num_candidates);
+                gibbon_position_fill_movement (candidate, froms[0], die2);
+                gibbon_position_fill_movement (candidate, froms[0] - die2,
+                                               die1);
         }
 
-        move = gibbon_move_new (die1, die2, 1);
-        gibbon_position_fill_movement (move, froms[0], die1);
-        moves = g_list_append (moves, move);
+        candidate = gibbon_position_add_candidate (candidates,
+                                                   &num_candidates);
+        gibbon_position_fill_movement (candidate, froms[0], die1);
 
-        move = gibbon_move_new (die1, die2, 1);
-        gibbon_position_fill_movement (move, froms[0], die2);
-        moves = g_list_append (moves, move);
+        candidate = gibbon_position_add_candidate (candidates,
+                                                   &num_candidates);
+        gibbon_position_fill_movement (candidate, froms[0], die2);
 
-        move = gibbon_move_new (die1, die2, 2);
-        gibbon_position_fill_movement (move, froms[0], die1);
-        gibbon_position_fill_movement (move, froms[0], die2);
-        moves = g_list_append (moves, move);
+        candidate = gibbon_position_add_candidate (candidates,
+                                                   &num_candidates);
+        gibbon_position_fill_movement (candidate, froms[0], die1);
+        gibbon_position_fill_movement (candidate, froms[0], die2);
 
-        return moves;
+        return num_candidates;
 }
 
-static GList *
-gibbon_position_find_double (const gint *before,
-                             const gint *after,
-                             guint die,
-                             gsize num_froms, const guint *froms)
+static gsize
+gibbon_position_find_double (guint die,
+                             gsize num_froms, const guint *froms,
+                             GibbonMoveCandidate *candidates)
 {
         guint *move_patterns;
-        GList *moves = NULL;
+        gsize num_candidates = 0;
         gsize i, j, num_patterns;
-        GibbonMove *move;
+        GibbonMoveCandidate *candidate;
         gsize num_steps;
         guint pattern;
         guint from_index;
@@ -817,10 +1581,10 @@ gibbon_position_find_double (const gint *before,
 
         switch (num_froms) {
                 case 0:
-                        move = gibbon_move_new (die, die, 0);
-                        moves = g_list_append (moves, move);
+                        gibbon_position_add_candidate (candidates,
+                                                       &num_candidates);
 
-                        return moves;
+                        return num_candidates;
                 case 1:
                         move_patterns = move_patterns1;
                         num_patterns = (sizeof move_patterns1)
@@ -845,10 +1609,8 @@ gibbon_position_find_double (const gint *before,
 
         for (i = 0; i < num_patterns; ++i) {
                 pattern = move_patterns[i];
-                /* This may allocate too much but calculating the correct size
-                 * would never pay out.
-                 */
-                move = gibbon_move_new (die, die, 4);
+                candidate = gibbon_position_add_candidate (candidates,
+                                                           &num_candidates);
                 is_bear_off = FALSE;
 
                 while (pattern) {
@@ -856,7 +1618,8 @@ gibbon_position_find_double (const gint *before,
                         from_index = (pattern & 0xf0) >> 4;
                         from = froms[from_index];
                         for (j = 0; j < num_steps; ++j) {
-                                gibbon_position_fill_movement (move, from, die);
+                                gibbon_position_fill_movement (candidate,
+                                                               from, die);
                                 from -= die;
 
                                 if (from <= 0)
@@ -867,12 +1630,20 @@ gibbon_position_find_double (const gint *before,
                 }
 
                 if (is_bear_off)
-                        order_movements (move);
-
-                moves = g_list_append (moves, move);
+                        order_movements (candidate);
         }
 
-        return moves;
+        return num_candidates;
+}
+
+static GibbonMove *
+gibbon_position_new_move (guint die1, guint die2, GibbonMoveError status)
+{
+        GibbonMove *move = gibbon_move_new (die1, die2, 0);
+
+        move->status = status;
+
+        return move;
 }
 
 #if (0)
@@ -896,7 +1667,7 @@ dump_move (const GibbonMove *move)
 #endif
 
 static gint
-find_backmost_checker (const gint board[26])
+find_backmost_checker (const gint8 board[26])
 {
         gint i;
 
@@ -921,7 +1692,7 @@ swap_movements (GibbonMovement *m1, GibbonMovement *m2)
 }
 
 static void
-order_movements (GibbonMove *move)
+order_movements (GibbonMoveCandidate *move)
 {
         gint i;
 
@@ -961,6 +1732,381 @@ gibbon_position_equals_technically (const GibbonPosition *self,
         return TRUE;
 }
 
+G_STATIC_ASSERT (sizeof (GibbonPositionKey) == 40);
+
+static void
+gibbon_position_encode_side (guint8 position_id[10], guint *bit,
+                             const GibbonPosition *self,
+                             GibbonPositionSide side)
+{
+        gint8 buffer[26];
+        const gint8 *board = gibbon_position_normalized (self, side, buffer);
+        gint i, n;
+
+        /* One 1-bit per checker, and one 0-bit after each point.  */
+        for (i = 1; i <= 25; ++i) {
+                for (n = 0; n < board[i] && *bit < 80; ++n, ++*bit)
+                        position_id[*bit >> 3] |= 1 << (*bit & 0x7);
+                ++*bit;
+        }
+}
+
+/**
+ * gibbon_position_get_key:
+ * @self: The #GibbonPosition.
+ * @key: The #GibbonPositionKey to fill.
+ *
+ * Fill @key with the compact representation of @self.  Player names, the
+ * unused dice, and the free-form strings are not part of the key.
+ */
+void
+gibbon_position_get_key (const GibbonPosition *self, GibbonPositionKey *key)
+{
+        GibbonPositionSide on_roll;
+        guint bit = 0;
+
+        g_return_if_fail (self != NULL);
+        g_return_if_fail (key != NULL);
+
+        memset (key, 0, sizeof *key);
+
+        on_roll = self->turn == GIBBON_POSITION_SIDE_BLACK
+                ? GIBBON_POSITION_SIDE_BLACK : GIBBON_POSITION_SIDE_WHITE;
+        gibbon_position_encode_side (key->position_id, &bit, self, -on_roll);
+        gibbon_position_encode_side (key->position_id, &bit, self, on_roll);
+
+        key->dice[0] = (gint) self->dice[0];
+        key->dice[1] = (gint) self->dice[1];
+        key->turn = self->turn;
+        key->cube_turned = self->cube_turned;
+        if (self->may_double[0])
+                key->flags |= 0x1;
+        if (self->may_double[1])
+                key->flags |= 0x2;
+        if (self->dice_swapped)
+                key->flags |= 0x4;
+        key->match_length = self->match_length;
+        key->scores[0] = self->scores[0];
+        key->scores[1] = self->scores[1];
+        key->cube = self->cube;
+        key->resigned = self->resigned;
+        key->score = self->score;
+}
+
+/**
+ * gibbon_position_hash:
+ * @self: The #GibbonPosition.
+ *
+ * Returns: A 64 bit hash value of all significant properties of @self.
+ */
+guint64
+gibbon_position_hash (const GibbonPosition *self)
+{
+        GibbonPositionKey key;
+
+        gibbon_position_get_key (self, &key);
+
+        return gibbon_position_key_hash64 (&key);
+}
+
+/**
+ * gibbon_position_key_hash64:
+ * @key: The #GibbonPositionKey.
+ *
+ * Returns: A 64 bit hash value for @key.
+ */
+guint64
+gibbon_position_key_hash64 (const GibbonPositionKey *key)
+{
+        const guint8 *bytes = (const guint8 *) key;
+        guint64 hash = G_GUINT64_CONSTANT (0xcbf29ce484222325);
+        guint64 word;
+        gsize i;
+
+        for (i = 0; i < sizeof *key; i += sizeof word) {
+                memcpy (&word, bytes + i, sizeof word);
+                hash ^= word;
+                hash *= G_GUINT64_CONSTANT (0x9e3779b97f4a7c15);
+                hash ^= hash >> 32;
+        }
+
+        return hash;
+}
+
+/**
+ * gibbon_position_key_hash:
+ * @key: A #GibbonPositionKey.
+ *
+ * A #GHashFunc for #GibbonPositionKey.
+ *
+ * Returns: The hash value of @key.
+ */
+guint
+gibbon_position_key_hash (gconstpointer key)
+{
+        guint64 hash = gibbon_position_key_hash64 (key);
+
+        return (guint) (hash ^ (hash >> 32));
+}
+
+/**
+ * gibbon_position_key_equal:
+ * @a: A #GibbonPositionKey.
+ * @b: Another #GibbonPositionKey.
+ *
+ * A #GEqualFunc for #GibbonPositionKey.
+ *
+ * Returns: %TRUE if @a and @b are equal.
+ */
+gboolean
+gibbon_position_key_equal (gconstpointer a, gconstpointer b)
+{
+        return !memcmp (a, b, sizeof (GibbonPositionKey));
+}
+
+/*
+ * A delta is a sequence of records.  Each record starts with a tag byte
+ * that identifies the property, followed by the new value.  Small integers
+ * take one byte, 64 bit integers eight bytes in little-endian byte order.
+ * Strings are preceded by their length plus one in four bytes, and a
+ * length of zero stands for NULL.
+ */
+enum {
+        GIBBON_POSITION_DELTA_POINTS = 0,
+        GIBBON_POSITION_DELTA_BAR = 24,
+        GIBBON_POSITION_DELTA_DICE = 26,
+        GIBBON_POSITION_DELTA_UNUSED_DICE = 28,
+        GIBBON_POSITION_DELTA_MAY_DOUBLE = 32,
+        GIBBON_POSITION_DELTA_CUBE_TURNED = 34,
+        GIBBON_POSITION_DELTA_TURN,
+        GIBBON_POSITION_DELTA_DICE_SWAPPED,
+        GIBBON_POSITION_DELTA_MATCH_LENGTH = 40,
+        GIBBON_POSITION_DELTA_CUBE,
+        GIBBON_POSITION_DELTA_SCORES,
+        GIBBON_POSITION_DELTA_RESIGNED = 44,
+        GIBBON_POSITION_DELTA_SCORE,
+        GIBBON_POSITION_DELTA_PLAYERS = 48,
+        GIBBON_POSITION_DELTA_GAME_INFO = 50,
+        GIBBON_POSITION_DELTA_STATUS
+};
+
+static void
+gibbon_position_delta_small (GByteArray *delta, guint8 tag,
+                             gint from, gint to)
+{
+        guint8 record[2];
+
+        if (from == to)
+                return;
+
+        record[0] = tag;
+        record[1] = (guint8) (gint8) to;
+        g_byte_array_append (delta, record, 2);
+}
+
+static void
+gibbon_position_delta_large (GByteArray *delta, guint8 tag,
+                             guint64 from, guint64 to)
+{
+        guint8 record[9];
+        gint i;
+
+        if (from == to)
+                return;
+
+        record[0] = tag;
+        for (i = 0; i < 8; ++i)
+                record[i + 1] = (to >> (8 * i)) & 0xff;
+        g_byte_array_append (delta, record, 9);
+}
+
+static void
+gibbon_position_delta_string (GByteArray *delta, guint8 tag,
+                              const gchar *from, const gchar *to)
+{
+        guint8 record[5];
+        guint32 length;
+        gint i;
+
+        /* Interned strings are equal if the pointers are.  */
+        if (from == to)
+                return;
+
+        length = to ? strlen (to) + 1 : 0;
+        record[0] = tag;
+        for (i = 0; i < 4; ++i)
+                record[i + 1] = (length >> (8 * i)) & 0xff;
+        g_byte_array_append (delta, record, 5);
+        if (length > 1)
+                g_byte_array_append (delta, (const guint8 *) to, length - 1);
+}
+
+/**
+ * gibbon_position_delta_encode:
+ * @from: The original #GibbonPosition.
+ * @to: The modified #GibbonPosition.
+ * @delta: The #GByteArray to append the delta to.
+ *
+ * Append the differences between @from and @to to @delta.  Nothing is
+ * appended if the two positions are identical.  Use
+ * gibbon_position_delta_apply() in order to get from @from to @to.
+ */
+void
+gibbon_position_delta_encode (const GibbonPosition *from,
+                              const GibbonPosition *to, GByteArray *delta)
+{
+        gint i;
+
+        g_return_if_fail (from != NULL);
+        g_return_if_fail (to != NULL);
+        g_return_if_fail (delta != NULL);
+
+        for (i = 0; i < 24; ++i)
+                gibbon_position_delta_small (delta,
+                                             GIBBON_POSITION_DELTA_POINTS + i,
+                                             from->points[i], to->points[i]);
+        for (i = 0; i < 2; ++i) {
+                gibbon_position_delta_small (delta,
+                                             GIBBON_POSITION_DELTA_BAR + i,
+                                             from->bar[i], to->bar[i]);
+                gibbon_position_delta_small (delta,
+                                             GIBBON_POSITION_DELTA_DICE + i,
+                                             from->dice[i], to->dice[i]);
+                gibbon_position_delta_small (delta,
+                                             GIBBON_POSITION_DELTA_MAY_DOUBLE
+                                             + i, from->may_double[i],
+                                             to->may_double[i]);
+                gibbon_position_delta_large (delta,
+                                             GIBBON_POSITION_DELTA_SCORES + i,
+                                             from->scores[i], to->scores[i]);
+                gibbon_position_delta_string (delta,
+                                              GIBBON_POSITION_DELTA_PLAYERS
+                                              + i, from->players[i],
+                                              to->players[i]);
+        }
+        for (i = 0; i < 4; ++i)
+                gibbon_position_delta_small (delta,
+                                             GIBBON_POSITION_DELTA_UNUSED_DICE
+                                             + i, from->unused_dice[i],
+                                             to->unused_dice[i]);
+        gibbon_position_delta_small (delta, GIBBON_POSITION_DELTA_CUBE_TURNED,
+                                     from->cube_turned, to->cube_turned);
+        gibbon_position_delta_small (delta, GIBBON_POSITION_DELTA_TURN,
+                                     from->turn, to->turn);
+        gibbon_position_delta_small (delta, GIBBON_POSITION_DELTA_DICE_SWAPPED,
+                                     from->dice_swapped, to->dice_swapped);
+        gibbon_position_delta_large (delta, GIBBON_POSITION_DELTA_MATCH_LENGTH,
+                                     from->match_length, to->match_length);
+        gibbon_position_delta_large (delta, GIBBON_POSITION_DELTA_CUBE,
+                                     from->cube, to->cube);
+        gibbon_position_delta_large (delta, GIBBON_POSITION_DELTA_RESIGNED,
+                                     from->resigned, to->resigned);
+        gibbon_position_delta_large (delta, GIBBON_POSITION_DELTA_SCORE,
+                                     from->score, to->score);
+        gibbon_position_delta_string (delta, GIBBON_POSITION_DELTA_GAME_INFO,
+                                      from->game_info, to->game_info);
+        gibbon_position_delta_string (delta, GIBBON_POSITION_DELTA_STATUS,
+                                      from->status, to->status);
+}
+
+/**
+ * gibbon_position_delta_apply:
+ * @self: The #GibbonPosition to modify.
+ * @delta: A delta created by gibbon_position_delta_encode().
+ * @length: The length of @delta in bytes.
+ *
+ * Apply the differences in @delta to @self.
+ *
+ * Returns: %FALSE if @delta is corrupted.
+ */
+gboolean
+gibbon_position_delta_apply (GibbonPosition *self, const guint8 *delta,
+                             gsize length)
+{
+        const guint8 *end = delta + length;
+        guint8 tag;
+        guint64 value;
+        guint32 size;
+        gchar **string;
+        gint i;
+
+        g_return_val_if_fail (self != NULL, FALSE);
+        g_return_val_if_fail (delta != NULL || !length, FALSE);
+
+        while (delta < end) {
+                tag = *delta++;
+                if (tag < GIBBON_POSITION_DELTA_MATCH_LENGTH) {
+                        if (delta >= end)
+                                return FALSE;
+                        value = (gint8) *delta++;
+                } else if (tag < GIBBON_POSITION_DELTA_PLAYERS) {
+                        if (end - delta < 8)
+                                return FALSE;
+                        for (i = 0, value = 0; i < 8; ++i)
+                                value |= ((guint64) *delta++) << (8 * i);
+                } else {
+                        if (end - delta < 4)
+                                return FALSE;
+                        for (i = 0, size = 0; i < 4; ++i)
+                                size |= ((guint32) *delta++) << (8 * i);
+                        if (size && (gsize) (end - delta) < size - 1)
+                                return FALSE;
+                        if (tag == GIBBON_POSITION_DELTA_STATUS)
+                                string = &self->status;
+                        else if (tag == GIBBON_POSITION_DELTA_GAME_INFO)
+                                string = &self->game_info;
+                        else if (tag == GIBBON_POSITION_DELTA_PLAYERS
+                                 || tag == GIBBON_POSITION_DELTA_PLAYERS + 1)
+                                string = &self->players[tag
+                                        - GIBBON_POSITION_DELTA_PLAYERS];
+                        else
+                                return FALSE;
+                        gibbon_position_string_unref (*string);
+                        *string = size ? gibbon_position_string_take (
+                                g_strndup ((const gchar *) delta, size - 1))
+                                : NULL;
+                        if (size)
+                                delta += size - 1;
+                        continue;
+                }
+
+                if (tag < GIBBON_POSITION_DELTA_BAR)
+                        self->points[tag] = (gint) value;
+                else if (tag < GIBBON_POSITION_DELTA_DICE)
+                        self->bar[tag - GIBBON_POSITION_DELTA_BAR] = value;
+                else if (tag < GIBBON_POSITION_DELTA_UNUSED_DICE)
+                        self->dice[tag - GIBBON_POSITION_DELTA_DICE] = value;
+                else if (tag < GIBBON_POSITION_DELTA_MAY_DOUBLE)
+                        self->unused_dice[tag
+                                - GIBBON_POSITION_DELTA_UNUSED_DICE] = value;
+                else if (tag < GIBBON_POSITION_DELTA_CUBE_TURNED)
+                        self->may_double[tag
+                                - GIBBON_POSITION_DELTA_MAY_DOUBLE] = value;
+                else if (tag == GIBBON_POSITION_DELTA_CUBE_TURNED)
+                        self->cube_turned = (gint) value;
+                else if (tag == GIBBON_POSITION_DELTA_TURN)
+                        self->turn = (gint) value;
+                else if (tag == GIBBON_POSITION_DELTA_DICE_SWAPPED)
+                        self->dice_swapped = value;
+                else if (tag == GIBBON_POSITION_DELTA_MATCH_LENGTH)
+                        self->match_length = value;
+                else if (tag == GIBBON_POSITION_DELTA_CUBE)
+                        self->cube = value;
+                else if (tag == GIBBON_POSITION_DELTA_SCORES
+                         || tag == GIBBON_POSITION_DELTA_SCORES + 1)
+                        self->scores[tag - GIBBON_POSITION_DELTA_SCORES]
+                                = value;
+                else if (tag == GIBBON_POSITION_DELTA_RESIGNED)
+                        self->resigned = value;
+                else if (tag == GIBBON_POSITION_DELTA_SCORE)
+                        self->score = value;
+                else
+                        return FALSE;
+        }
+
+        return TRUE;
+}
+
 gboolean
 gibbon_position_apply_move (GibbonPosition *self, GibbonMove *move,
                             GibbonPositionSide side, gboolean reverse)
@@ -1073,49 +2219,36 @@ gibbon_position_apply_move (GibbonPosition *self, GibbonMove *move,
 gint
 gibbon_position_game_over (const GibbonPosition *position)
 {
-        guint white_borne_off =
-                gibbon_position_get_borne_off (position,
-                                               GIBBON_POSITION_SIDE_WHITE);
-        guint black_borne_off;
+        GibbonPositionSide winner;
+        gint8 buffer[26];
+        const gint8 *loser;
         gint i;
         guint cube = position->cube;
 
         if (position->score)
                 return position->score;
 
-        if (white_borne_off >= 15) {
-                black_borne_off =
-                        gibbon_position_get_borne_off (position,
-                                                    GIBBON_POSITION_SIDE_BLACK);
-                if (black_borne_off)
-                        return cube;
-                if (position->bar[1])
-                        return 3 * cube;
-                for (i = 0; i < 6; ++i)
-                        if (position->points[i])
-                                return 3 * cube;
-                return 2 * cube;
-        }
-
-        black_borne_off =
-                gibbon_position_get_borne_off (position,
-                                               GIBBON_POSITION_SIDE_BLACK);
-
-        if (black_borne_off >= 15) {
-                white_borne_off =
-                        gibbon_position_get_borne_off (position,
-                                                    GIBBON_POSITION_SIDE_WHITE);
-                if (white_borne_off)
-                        return -cube;
-                if (position->bar[0])
-                        return -3 * cube;
-                for (i = 23; i > 17; --i)
-                        if (position->points[i])
-                                return -3 * cube;
-                return -2 * cube;
-        }
+        if (gibbon_position_get_borne_off (position,
+                                           GIBBON_POSITION_SIDE_WHITE) >= 15)
+                winner = GIBBON_POSITION_SIDE_WHITE;
+        else if (gibbon_position_get_borne_off (position,
+                                                GIBBON_POSITION_SIDE_BLACK)
+                 >= 15)
+                winner = GIBBON_POSITION_SIDE_BLACK;
+        else
+                return 0;
 
-        return 0;
+        /* The loser's checkers in the winner's home board are on the
+         * points 19 to 24 from the loser's perspective.
+         */
+        if (gibbon_position_get_borne_off (position, -winner))
+                return winner * cube;
+        loser = gibbon_position_normalized (position, -winner, buffer);
+        for (i = 19; i <= 25; ++i)
+                if (loser[i] > 0)
+                        return 3 * winner * cube;
+
+        return 2 * winner * cube;
 }
 
 static GRegex *re_adjacent1 = NULL;
@@ -27,6 +27,8 @@
 #include <glib.h>
 #include <glib-object.h>
 
+#include "gibbon-movement.h"
+
 #define GIBBON_TYPE_POSITION (gibbon_position_get_type ())
 
 /**
@@ -46,9 +48,9 @@ typedef enum {
 /**
  * GibbonPosition:
  * @players: @players[0] is the white player name, @players[1] the black player;
- *           %NULL representing unknown.  If you use gibbon_position_free()
- *           for disposing the object the pointers used will be passed
- *           to g_free()!
+ *           %NULL representing unknown.  The names are interned strings
+ *           shared between positions; only modify them with
+ *           gibbon_position_set_player()!
  * @turn: whose turn is it?
  * @points: points[0] is the ace point for white, and the 24 point for
  *          black; points[23] is the ace point for black, and the 24 point
@@ -80,7 +82,9 @@ typedef enum {
  * @score: If the game is over, the result of the running game should be
  *         stored here.
  * @game_info: Free-form string describing the game ("Crawford", ...).
+ *             Interned like @players, see gibbon_position_set_game_info().
  * @status: Free-form string describing the status ("It's your move", ...).
+ *          Interned like @players, see gibbon_position_set_status().
  * @dice_swapped: %TRUE% if the dice should be swapped.
  *
  * A boxed type representing a backgammon position.
@@ -138,11 +142,92 @@ struct _GibbonPosition
         gchar *status;
 };
 
+/**
+ * GIBBON_POSITION_MAX_LEGAL_MOVES:
+ *
+ * Upper bound for the number of distinct legal moves for one roll.  GNU
+ * Backgammon uses the same limit.
+ */
+#define GIBBON_POSITION_MAX_LEGAL_MOVES 3060
+
+/**
+ * GIBBON_POSITION_LEGALITY_CACHE_SIZE:
+ *
+ * Default number of results memoized by gibbon_position_check_move().
+ */
+#define GIBBON_POSITION_LEGALITY_CACHE_SIZE 4096
+
+/**
+ * GibbonLegalMove:
+ * @number: Number of checkers moved, 0 to 4.
+ * @movements: The individual checker movements.  The points are given
+ *             from the perspective of the moving side, see
+ *             gibbon_position_get_board().
+ * @board: The resulting board from the perspective of the moving side.
+ *
+ * One legal move as found by gibbon_position_legal_moves().  This is a
+ * plain structure so that arrays of it can live on the stack.
+ */
+typedef struct _GibbonLegalMove GibbonLegalMove;
+struct _GibbonLegalMove
+{
+        gsize number;
+        GibbonMovement movements[4];
+        gint8 board[26];
+};
+
+/**
+ * GibbonPositionKey:
+ * @position_id: The checker distribution encoded like a GNU Backgammon
+ *               position ID, the side not on roll first.  Encoding it
+ *               with g_base64_encode() yields the familiar 14 characters
+ *               plus padding.
+ * @dice: The dice.
+ * @turn: The side on roll.
+ * @cube_turned: Who has turned the cube.
+ * @flags: Bit 0 and 1 are @may_double for white and black, bit 2 is
+ *         @dice_swapped.
+ * @reserved: Always 0.
+ * @match_length: The match length.
+ * @scores: The scores.
+ * @cube: The cube value.
+ * @resigned: The resignation offered.
+ * @score: The result of the game.
+ *
+ * A compact and canonical representation of all significant properties of
+ * a #GibbonPosition, see gibbon_position_equals_technically().  Two keys
+ * are equal if and only if the positions are technically equal.  Numbers
+ * are truncated to 32 bits which is more than enough for every real match.
+ *
+ * Use gibbon_position_key_hash() and gibbon_position_key_equal() for
+ * hash tables keyed by positions.
+ */
+typedef struct _GibbonPositionKey GibbonPositionKey;
+struct _GibbonPositionKey
+{
+        guint8 position_id[10];
+        gint8 dice[2];
+        gint8 turn;
+        gint8 cube_turned;
+        guint8 flags;
+        guint8 reserved;
+        guint32 match_length;
+        guint32 scores[2];
+        guint32 cube;
+        gint32 resigned;
+        gint32 score;
+};
+
 GType gibbon_position_get_type (void) G_GNUC_CONST;
 
 GibbonPosition *gibbon_position_new (void);
 void gibbon_position_free (GibbonPosition *self);
 GibbonPosition *gibbon_position_copy (const GibbonPosition *self);
+void gibbon_position_set_game_info (GibbonPosition *self,
+                                    const gchar *game_info);
+void gibbon_position_set_status (GibbonPosition *self, const gchar *status);
+void gibbon_position_take_status (GibbonPosition *self, gchar *status);
+void gibbon_position_get_string_pool_stats (gsize *strings, gsize *bytes);
 
 void gibbon_position_set_player (GibbonPosition *self,
                                  const gchar *name, GibbonPositionSide side);
@@ -151,12 +236,37 @@ guint gibbon_position_get_pip_count (const GibbonPosition *self,
                                      GibbonPositionSide side);
 guint gibbon_position_get_borne_off (const GibbonPosition *self,
                                      GibbonPositionSide side);
+gdouble gibbon_position_get_bearoff_rolls (const GibbonPosition *self,
+                                           GibbonPositionSide side);
+gdouble gibbon_position_get_bearoff_win (const GibbonPosition *self,
+                                         GibbonPositionSide side);
 
 struct _GibbonMove *gibbon_position_check_move (const GibbonPosition *before,
                                                 const GibbonPosition *after,
                                                 GibbonPositionSide side);
+void gibbon_position_set_legality_cache_size (gsize max_entries);
+void gibbon_position_get_legality_cache_stats (guint64 *hits, guint64 *misses,
+                                               gsize *entries);
+void gibbon_position_reset_legality_cache_stats (void);
+void gibbon_position_get_board (const GibbonPosition *self,
+                                GibbonPositionSide side, gint board[26]);
+gsize gibbon_position_legal_moves (const GibbonPosition *self,
+                                   GibbonPositionSide side,
+                                   guint die1, guint die2,
+                                   GibbonLegalMove *moves, gsize max_moves);
 gboolean gibbon_position_equals_technically (const GibbonPosition *self,
                                              const GibbonPosition *other);
+void gibbon_position_get_key (const GibbonPosition *self,
+                              GibbonPositionKey *key);
+guint64 gibbon_position_hash (const GibbonPosition *self);
+guint64 gibbon_position_key_hash64 (const GibbonPositionKey *key);
+guint gibbon_position_key_hash (gconstpointer key);
+gboolean gibbon_position_key_equal (gconstpointer a, gconstpointer b);
+void gibbon_position_delta_encode (const GibbonPosition *from,
+                                   const GibbonPosition *to,
+                                   GByteArray *delta);
+gboolean gibbon_position_delta_apply (GibbonPosition *self,
+                                      const guint8 *delta, gsize length);
 void gibbon_position_dump (const GibbonPosition *self);
 
 /* Apply a move to a position.  The function only does a plausability test,
@@ -1119,17 +1119,15 @@ gibbon_session_clip_logout (GibbonSession *self, GSList *iter)
         gibbon_inviter_list_remove (self->priv->inviter_list, name);
 
         if (0 == g_strcmp0 (name, self->priv->watching)) {
-                g_free (self->priv->position->status);
-                self->priv->position->status =
-                    g_strdup_printf (_("%s logged out!"), name);
+                gibbon_position_take_status (self->priv->position,
+                    g_strdup_printf (_("%s logged out!"), name));
                 gibbon_session_stop_playing (self);
                 gibbon_app_display_info (self->priv->app, NULL,
                                          _("Player `%s' logged out!"),
                                          name);
         } else if (0 == g_strcmp0 (name, self->priv->opponent)) {
-                g_free (self->priv->position->status);
-                self->priv->position->status =
-                    g_strdup_printf (_("%s logged out!"), name);
+                gibbon_position_take_status (self->priv->position,
+                    g_strdup_printf (_("%s logged out!"), name));
                 if (!self->priv->watching) {
                         match_length = self->priv->position->match_length;
                         scores[0] = self->priv->position->scores[0];
@@ -1545,7 +1543,8 @@ gibbon_session_handle_board (GibbonSession *self, GSList *iter)
         if (!g_strcmp0 ("You", pos->players[0])) {
                 connection = gibbon_app_get_connection (self->priv->app);
                 login = gibbon_connection_get_login (connection);
-                pos->players[0] = g_strdup (login);
+                gibbon_position_set_player (pos, login,
+                                            GIBBON_POSITION_SIDE_WHITE);
                 if (self->priv->watching)
                         gibbon_session_stop_playing (self);
         }
@@ -1902,27 +1901,24 @@ gibbon_session_handle_rolls (GibbonSession *self, GSList *iter)
         if (0 == g_strcmp0 ("You", who)) {
                 self->priv->position->dice[0] = dice[0];
                 self->priv->position->dice[1] = dice[1];
-                g_free (self->priv->position->status);
-                self->priv->position->status =
+                gibbon_position_take_status (self->priv->position,
                         g_strdup_printf (_("You roll %u and %u."),
-                                         (guint) dice[0], (guint) dice[1]);
+                                         (guint) dice[0], (guint) dice[1]));
         } else if (0 == g_strcmp0 (self->priv->opponent, who)) {
                 self->priv->position->dice[0] = dice[0];
                 self->priv->position->dice[1] = dice[1];
-                g_free (self->priv->position->status);
-                self->priv->position->status =
+                gibbon_position_take_status (self->priv->position,
                                 g_strdup_printf (_("%s rolls %u and %u."),
                                                  self->priv->opponent,
                                                  (guint) dice[0],
-                                                 (guint) dice[1]);
+                                                 (guint) dice[1]));
         } else if (0 == g_strcmp0 (self->priv->watching, who)) {
                 self->priv->position->dice[0] = dice[0];
                 self->priv->position->dice[1] = dice[1];
-                g_free (self->priv->position->status);
-                self->priv->position->status =
+                gibbon_position_take_status (self->priv->position,
                         g_strdup_printf (_("%s rolls %u and %u."),
                                          self->priv->watching,
-                                         (guint) dice[0], (guint) dice[1]);
+                                         (guint) dice[0], (guint) dice[1]));
         } else {
                 return -1;
         }
@@ -1983,27 +1979,26 @@ gibbon_session_handle_moves (GibbonSession *self, GSList *iter)
         pretty_move = gibbon_position_format_move (self->priv->position, move,
                                                    side,
                                                    !self->priv->direction);
-        g_free (self->priv->position->status);
-        self->priv->position->status = NULL;
+        gibbon_position_set_status (self->priv->position, NULL);
         dice = self->priv->position->dice;
 
         if (0 == g_strcmp0 (self->priv->opponent, player)) {
-                self->priv->position->status =
+                gibbon_position_take_status (self->priv->position,
                                 g_strdup_printf (_("%u%u: %s moves %s."),
                                                  dice[0], dice[1],
                                                  self->priv->opponent,
-                                                 pretty_move);
+                                                 pretty_move));
         } else if (0 == g_strcmp0 ("You", player)) {
-                self->priv->position->status =
+                gibbon_position_take_status (self->priv->position,
                                 g_strdup_printf (_("%u%u: You move %s."),
                                                  dice[0], dice[1],
-                                                 pretty_move);
+                                                 pretty_move));
         } else if (0 == g_strcmp0 (self->priv->watching, player)) {
-                self->priv->position->status =
+                gibbon_position_take_status (self->priv->position,
                                 g_strdup_printf (_("%u%u: %s moves %s."),
                                                 dice[0], dice[1],
                                                 self->priv->watching,
-                                                pretty_move);
+                                                pretty_move));
         } else {
                 g_object_unref (move);
                 return -1;
@@ -2025,9 +2020,9 @@ gibbon_session_handle_moves (GibbonSession *self, GSList *iter)
                         g_critical ("Black on move.");
                 gibbon_position_free (self->priv->position);
                 self->priv->position = gibbon_position_new ();
-                self->priv->position->status =
+                gibbon_position_take_status (self->priv->position,
                     g_strdup_printf (_("Error applying move %s to position.\n"),
-                                     pretty_move);
+                                     pretty_move));
                 g_free (pretty_move);
                 g_object_unref (move);
                 return -1;
@@ -2443,13 +2438,11 @@ gibbon_session_handle_left_game (GibbonSession *self, GSList *iter)
                 g_hash_table_insert (self->priv->saved_games,
                                      (gpointer) g_strdup (who),
                                      (gpointer) info);
-                g_free (self->priv->position->status);
-                self->priv->position->status = g_strdup_printf (_("Your"
-                                                                  " opponent %s"
-                                                                  " has left"
-                                                                  " the"
-                                                                  " match."),
-                                                                who);
+                gibbon_position_take_status (self->priv->position,
+                                             g_strdup_printf (_("Your opponent"
+                                                                " %s has left"
+                                                                " the match."),
+                                                              who));
                 gibbon_app_display_error(self->priv->app,
                                          _("Your opponent has left the game."),
                                          _("Your opponent %s has left the"
@@ -2459,8 +2452,8 @@ gibbon_session_handle_left_game (GibbonSession *self, GSList *iter)
                                            " inviting %s."), who, who);
         } else if (0 == g_strcmp0 (who, "You")) {
                 gibbon_app_set_state_not_playing (self->priv->app);
-                self->priv->position->status = g_strdup_printf ("You have left"
-                                                                " the match.");
+                gibbon_position_set_status (self->priv->position,
+                                            "You have left the match.");
         } else {
                 return -1;
         }
@@ -2495,20 +2488,18 @@ gibbon_session_handle_cannot_move (GibbonSession *self, GSList *iter)
 
         if (0 == g_strcmp0 (self->priv->opponent, who)) {
                 self->priv->position->turn = GIBBON_POSITION_SIDE_WHITE;
-                g_free (self->priv->position->status);
-                self->priv->position->status =
-                                g_strdup_printf (_("%s cannot move!"), who);
+                gibbon_position_take_status (self->priv->position,
+                                g_strdup_printf (_("%s cannot move!"), who));
                 if (!self->priv->watching)
                         must_fade = TRUE;
         } else if (0 == g_strcmp0 (self->priv->watching, who)) {
                 self->priv->position->turn = GIBBON_POSITION_SIDE_BLACK;
-                g_free (self->priv->position->status);
-                self->priv->position->status =
-                                g_strdup_printf (_("%s cannot move!"), who);
+                gibbon_position_take_status (self->priv->position,
+                                g_strdup_printf (_("%s cannot move!"), who));
         } else if (0 == g_strcmp0 ("You", who)) {
                 self->priv->position->turn = GIBBON_POSITION_SIDE_WHITE;
-                g_free (self->priv->position->status);
-                self->priv->position->status = g_strdup (_("You cannot move!"));
+                gibbon_position_set_status (self->priv->position,
+                                            _("You cannot move!"));
         } else {
                 return -1;
         }
@@ -2571,22 +2562,21 @@ gibbon_session_handle_accepts_double (GibbonSession *self, GSList *iter)
 
         self->priv->position->cube_turned = GIBBON_POSITION_SIDE_NONE;
 
-        g_free (self->priv->position->status);
         if (0 == g_strcmp0 (self->priv->opponent, who)) {
-                self->priv->position->status =
+                gibbon_position_take_status (self->priv->position,
                     g_strdup_printf ("Opponent %s accepted the cube.",
-                                     self->priv->opponent);
+                                     self->priv->opponent));
                 self->priv->position->may_double[0] = FALSE;
                 self->priv->position->may_double[1] = TRUE;
         } else if (0 == g_strcmp0 (self->priv->watching, who)) {
-                self->priv->position->status =
+                gibbon_position_take_status (self->priv->position,
                     g_strdup_printf ("Player %s accepted the cube.",
-                                     self->priv->watching);
+                                     self->priv->watching));
                 self->priv->position->may_double[0] = TRUE;
                 self->priv->position->may_double[1] = FALSE;
         } else if (0 == g_strcmp0 ("You", who)) {
-                self->priv->position->status =
-                    g_strdup_printf ("You accepted the cube.");
+                gibbon_position_set_status (self->priv->position,
+                                            "You accepted the cube.");
                 self->priv->position->may_double[0] = TRUE;
                 self->priv->position->may_double[1] = FALSE;
         } else {
@@ -2676,8 +2666,7 @@ gibbon_session_handle_win_game (GibbonSession *self, GSList *iter)
         if (0 == g_strcmp0 (who, self->priv->opponent)) {
                 self->priv->position->scores[1] += points;
                 score = -points;
-                g_free (self->priv->position->status);
-                self->priv->position->status =
+                gibbon_position_take_status (self->priv->position,
                                 g_strdup_printf (g_dngettext (GETTEXT_PACKAGE,
                                                               "%s has won the"
                                                               " game and one"
@@ -2686,12 +2675,11 @@ gibbon_session_handle_win_game (GibbonSession *self, GSList *iter)
                                                               " game and %d"
                                                               " points!",
                                                               points),
-                                                              who, points);
+                                                              who, points));
         } else if (0 == g_strcmp0 (who, "You")) {
                 self->priv->position->scores[0] += points;
                 score = points;
-                g_free (self->priv->position->status);
-                self->priv->position->status =
+                gibbon_position_take_status (self->priv->position,
                                 g_strdup_printf (g_dngettext (GETTEXT_PACKAGE,
                                                               "You have won the"
                                                               " game and one"
@@ -2700,12 +2688,11 @@ gibbon_session_handle_win_game (GibbonSession *self, GSList *iter)
                                                               " game and %d"
                                                               " points!",
                                                               points),
-                                                              points);
+                                                              points));
         } else if (0 == g_strcmp0 (who, self->priv->watching)) {
                 self->priv->position->scores[0] += points;
                 score = points;
-                g_free (self->priv->position->status);
-                self->priv->position->status =
+                gibbon_position_take_status (self->priv->position,
                                 g_strdup_printf (g_dngettext (GETTEXT_PACKAGE,
                                                               "%s has won the"
                                                               " game and one"
@@ -2714,7 +2701,7 @@ gibbon_session_handle_win_game (GibbonSession *self, GSList *iter)
                                                               " game and %d"
                                                               " points!",
                                                               points),
-                                                              who, points);
+                                                              who, points));
         } else {
                 return -1;
         }
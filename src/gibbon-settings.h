@@ -49,6 +49,8 @@
 #define GIBBON_PREFS_MATCH_AUTO_SWAP "auto-swap"
 #define GIBBON_PREFS_MATCH_LENGTH "length"
 #define GIBBON_PREFS_MATCH_SHOW_EQUITY "show-equity"
+#define GIBBON_PREFS_MATCH_FLUSH_POLICY "flush-policy"
+#define GIBBON_PREFS_MATCH_FLUSH_INTERVAL "flush-interval"
 
 #define GIBBON_DATA_SCHEMA GIBBON_SCHEMA ".data"
 
@@ -71,6 +71,19 @@ static void gibbon_sgf_reader_yyerror (const GibbonSGFReader *reader,
                                        const gchar *msg);
 static GibbonMatch *gibbon_sgf_reader_parse (GibbonMatchReader *match_reader,
                                              const gchar *filename);
+static GibbonMatch *gibbon_sgf_reader_parse_stream (GibbonMatchReader
+                                                    *match_reader,
+                                                    GInputStream *stream,
+                                                    const gchar *filename);
+static gboolean gibbon_sgf_reader_collection (GibbonSGFReader *self,
+                                              GibbonMatch *match,
+                                              GSGFCollection *collection,
+                                              gboolean replay,
+                                              GError **error);
+static gboolean gibbon_sgf_reader_peek (GibbonMatchReader *match_reader,
+                                        const gchar *filename,
+                                        GibbonMatchReaderInfo *info,
+                                        gboolean scores);
 static gboolean gibbon_sgf_reader_add_action (GibbonSGFReader *self,
                                               GibbonMatch *match,
                                               GibbonPositionSide side,
@@ -201,6 +214,9 @@ gibbon_sgf_reader_class_init (GibbonSGFReaderClass *klass)
                         GIBBON_MATCH_READER_CLASS (klass);
 
         gibbon_match_reader_class->parse = gibbon_sgf_reader_parse;
+        gibbon_match_reader_class->parse_stream =
+                gibbon_sgf_reader_parse_stream;
+        gibbon_match_reader_class->peek = gibbon_sgf_reader_peek;
         
         g_type_class_add_private (klass, sizeof (GibbonSGFReaderPrivate));
 
@@ -234,95 +250,220 @@ static GibbonMatch *
 gibbon_sgf_reader_parse (GibbonMatchReader *_self, const gchar *filename)
 {
         GibbonSGFReader *self;
-        GFile *file;
         GError *error = NULL;
+        GInputStream *in;
+        GibbonMatch *match;
+
+        g_return_val_if_fail (GIBBON_IS_SGF_READER (_self), NULL);
+        self = GIBBON_SGF_READER (_self);
+
+        in = gibbon_match_reader_open (filename, &error);
+        if (!in) {
+                self->priv->filename = filename;
+                gibbon_sgf_reader_yyerror (self, error->message);
+                g_error_free (error);
+                return NULL;
+        }
+
+        match = gibbon_sgf_reader_parse_stream (_self, in, filename);
+        g_object_unref (in);
+
+        return match;
+}
+
+/*
+ * The collection is read one game tree at a time so that only the game
+ * currently being replayed has to be held in memory.
+ */
+static GibbonMatch *
+gibbon_sgf_reader_parse_stream (GibbonMatchReader *_self, GInputStream *stream,
+                                const gchar *filename)
+{
+        GibbonSGFReader *self;
+        GError *error = NULL;
+        GSGFCollectionIter *iter;
         GSGFCollection *collection;
         GibbonMatch *match;
-        GList *iter;
-        GSGFGameTree *game_tree;
-        const GSGFFlavor *flavor;
 
         g_return_val_if_fail (GIBBON_IS_SGF_READER (_self), NULL);
+        g_return_val_if_fail (G_IS_INPUT_STREAM (stream), NULL);
         self = GIBBON_SGF_READER (_self);
 
         self->priv->filename = filename;
         self->priv->timestamp = G_MININT64;
 
-        if (!filename) {
-                gibbon_sgf_reader_yyerror (self,
-                                           _("SGF cannot be parsed from"
-                                             " standard input."));
-                return NULL;
+        match = gibbon_match_new (NULL, NULL, 0, FALSE);
+        self->priv->match = match;
+        self->priv->scores[0] = 0;
+        self->priv->scores[1] = 0;
+
+        iter = gsgf_collection_iter_new (stream, NULL);
+        while ((collection = gsgf_collection_iter_next (iter, &error))) {
+                gibbon_sgf_reader_collection (self, match, collection, TRUE,
+                                              &error);
+                g_object_unref (collection);
+                if (error)
+                        break;
+        }
+        gsgf_collection_iter_free (iter);
+
+        if (error) {
+                gibbon_sgf_reader_yyerror (self, error->message);
+                g_error_free (error);
+                g_object_unref (match);
+                match = NULL;
         }
-        file = g_file_new_for_path (filename);
 
-        collection = gsgf_collection_parse_file (file, NULL, &error);
+        self->priv->match = NULL;
 
-        g_object_unref (file);
+        return match;
+}
 
-        if (!collection) {
-                gibbon_sgf_reader_yyerror (self, error->message);
+/*
+ * Process the single game tree in @collection.  Non-backgammon game trees
+ * are silently ignored.  If @replay is %FALSE, only the root node is read.
+ * Returns %TRUE if a backgammon game tree was found, and %FALSE on error.
+ * The latter is indicated by @error being set.
+ */
+static gboolean
+gibbon_sgf_reader_collection (GibbonSGFReader *self, GibbonMatch *match,
+                              GSGFCollection *collection, gboolean replay,
+                              GError **error)
+{
+        GList *iter;
+        GSGFGameTree *game_tree;
+        const GSGFFlavor *flavor;
+
+        if (!gsgf_component_cook (GSGF_COMPONENT (collection), NULL, error))
                 return FALSE;
-        }
 
-        if (!gsgf_component_cook (GSGF_COMPONENT (collection), NULL, &error)) {
+        iter = gsgf_collection_get_game_trees (collection);
+        if (!iter)
+                return FALSE;
+        game_tree = GSGF_GAME_TREE (iter->data);
+
+        /*
+         * We ignore all non-backgammon game trees.
+         */
+        flavor = gsgf_game_tree_get_flavor (game_tree);
+        if (!flavor || !GSGF_IS_FLAVOR_BACKGAMMON (flavor))
+                return FALSE;
+
+        /*
+         * SGF stores general match meta information in the the root
+         * node of each game tree.
+         */
+        if (!gibbon_sgf_reader_root_node (self, match, game_tree, error))
+                return FALSE;
+
+        if (replay && !gibbon_sgf_reader_game (self, match, game_tree, error))
+                return FALSE;
+
+        return TRUE;
+}
+
+static gboolean
+gibbon_sgf_reader_peek (GibbonMatchReader *_self, const gchar *filename,
+                        GibbonMatchReaderInfo *info, gboolean scores)
+{
+        GibbonSGFReader *self;
+        GError *error = NULL;
+        GInputStream *in;
+        GSGFCollectionIter *collections;
+        GSGFCollection *collection;
+        GSGFCollection *last_collection = NULL;
+        GibbonMatch *match;
+        GList *iter;
+        GSGFGameTree *game_tree;
+        const GSGFNode *root;
+        const GSGFProperty *prop;
+        const GSGFResult *result;
+        guint points;
+
+        g_return_val_if_fail (GIBBON_IS_SGF_READER (_self), FALSE);
+        self = GIBBON_SGF_READER (_self);
+
+        self->priv->filename = filename;
+
+        in = gibbon_match_reader_open (filename, &error);
+        if (!in) {
                 gibbon_sgf_reader_yyerror (self, error->message);
-                g_object_unref (collection);
+                g_error_free (error);
+                self->priv->filename = NULL;
                 return FALSE;
         }
 
+        /*
+         * Only the root nodes are read.  The first one gives us the
+         * opponents and the rules, the last one the score before the last
+         * game.  The moves are never replayed.
+         */
         match = gibbon_match_new (NULL, NULL, 0, FALSE);
-        self->priv->match = match;
         self->priv->scores[0] = 0;
         self->priv->scores[1] = 0;
 
-        iter = gsgf_collection_get_game_trees (collection);
-
-        /* Iterate over the game trees.  */
-        while (iter) {
-                game_tree = GSGF_GAME_TREE (iter->data);
-
-                /*
-                 * We ignore all non-backgammon game trees.
-                 */
-                flavor = gsgf_game_tree_get_flavor (game_tree);
-                if (!flavor) {
-                        iter = iter->next;
+        collections = gsgf_collection_iter_new (in, NULL);
+        while ((collection = gsgf_collection_iter_next (collections,
+                                                        &error))) {
+                if (gibbon_sgf_reader_collection (self, match, collection,
+                                                  FALSE, &error)) {
+                        if (last_collection)
+                                g_object_unref (last_collection);
+                        last_collection = collection;
                         continue;
                 }
+                g_object_unref (collection);
+                if (error)
+                        break;
+        }
+        gsgf_collection_iter_free (collections);
+        g_object_unref (in);
 
-                if (!GSGF_IS_FLAVOR_BACKGAMMON (flavor)) {
-                        iter = iter->next;
-                        continue;
-                }
+        if (error) {
+                gibbon_sgf_reader_yyerror (self, error->message);
+                g_error_free (error);
+                g_object_unref (match);
+                if (last_collection)
+                        g_object_unref (last_collection);
+                self->priv->filename = NULL;
+                return FALSE;
+        }
 
-                /*
-                 * SGF stores general match meta information in the the root
-                 * node of each game tree.
-                 */
-                if (!gibbon_sgf_reader_root_node (self, match,
-                                                  game_tree, &error)) {
-                        gibbon_sgf_reader_yyerror (self, error->message);
-                        g_object_unref (match);
-                        match = NULL;
-                        break;
-                }
+        gibbon_match_reader_info_from_match (info, match, FALSE);
+        info->start_time = G_MININT64;
+        g_object_unref (match);
 
-                if (!gibbon_sgf_reader_game (self, match, game_tree,
-                                             &error)) {
-                        gibbon_sgf_reader_yyerror (self, error->message);
-                        g_object_unref (match);
-                        match = NULL;
-                        break;
-                }
+        if (scores && last_collection) {
+                info->scores[0] = self->priv->scores[0];
+                info->scores[1] = self->priv->scores[1];
 
-                /* Proceed to next item.  */
-                iter = iter->next;
+                /* Colors are swapped!  */
+                iter = gsgf_collection_get_game_trees (last_collection);
+                game_tree = GSGF_GAME_TREE (iter->data);
+                iter = gsgf_game_tree_get_nodes (game_tree);
+                root = iter ? GSGF_NODE (iter->data) : NULL;
+                prop = root ? gsgf_node_get_property (root, "RE") : NULL;
+                if (prop) {
+                        result = GSGF_RESULT (gsgf_property_get_value (prop));
+                        points = (guint) gsgf_result_get_score (result);
+                        switch (gsgf_result_get_winner (result)) {
+                        case GSGF_RESULT_BLACK:
+                                info->scores[0] += points;
+                                break;
+                        case GSGF_RESULT_WHITE:
+                                info->scores[1] += points;
+                                break;
+                        default:
+                                break;
+                        }
+                }
         }
 
-        g_object_unref (collection);
+        if (last_collection)
+                g_object_unref (last_collection);
+        self->priv->filename = NULL;
 
-        return match;
+        return TRUE;
 }
 
 static gboolean
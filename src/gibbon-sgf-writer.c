@@ -27,11 +27,11 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <glib.h>
 #include <glib/gi18n.h>
-
-#include <libgsgf/gsgf.h>
+#include <gio/gio.h>
 
 #include "gibbon-sgf-writer.h"
 #include "gibbon-match.h"
@@ -39,47 +39,58 @@
 #include "gibbon-game-actions.h"
 #include "gibbon-util.h"
 
+/* The game id of backgammon in SGF.  */
+#define GIBBON_SGF_WRITER_GAME_ID 6
+
+/*
+ * The tokens are formatted into a memory stream while the match is walked,
+ * and the complete text is copied to the real output only if no error
+ * occurred.  This costs one flat copy of the document, instead of one
+ * object per node and property for a GSGF tree.  Apart from that, a roll
+ * is held back, because a roll followed by a move ends up in the same node
+ * as the move.
+ */
+typedef struct _GibbonSGFWriterState GibbonSGFWriterState;
+struct _GibbonSGFWriterState {
+        GOutputStream *out;
+        GError **error;
+
+        gboolean roll_pending;
+        GibbonPositionSide roll_side;
+        guint roll[2];
+};
+
 G_DEFINE_TYPE (GibbonSGFWriter, gibbon_sgf_writer, GIBBON_TYPE_MATCH_WRITER)
 
 static gboolean gibbon_sgf_writer_write_stream (const GibbonMatchWriter *writer,
                                                 GOutputStream *out,
                                                 const GibbonMatch *match,
                                                 GError **error);
-static gboolean gibbon_sgf_writer_add_game (const GibbonSGFWriter *self,
-                                            GSGFGameTree *game_tree,
+static gboolean gibbon_sgf_writer_add_game (GibbonSGFWriterState *state,
                                             const GibbonGame *game,
                                             guint game_number,
-                                            const GibbonMatch *match,
-                                            GError **error);
-static gboolean gibbon_sgf_writer_write_game (const GibbonSGFWriter *self,
-                                              GSGFGameTree *game_tree,
-                                              const GibbonGame *game,
-                                              GError **error);
-static gboolean gibbon_sgf_writer_roll (const GibbonSGFWriter *self,
-                                        GSGFGameTree *game_tree,
-                                        GibbonPositionSide side,
-                                        GibbonRoll *roll, GError **error);
-static gboolean gibbon_sgf_writer_move (const GibbonSGFWriter *self,
-                                        GSGFGameTree *game_tree,
+                                            const GibbonMatch *match);
+static gboolean gibbon_sgf_writer_write_game (GibbonSGFWriterState *state,
+                                              const GibbonGame *game);
+static gboolean gibbon_sgf_writer_flush_roll (GibbonSGFWriterState *state);
+static gboolean gibbon_sgf_writer_move (GibbonSGFWriterState *state,
                                         GibbonPositionSide side,
-                                        GibbonMove *move, GError **error);
-static gboolean gibbon_sgf_writer_special_move (const GibbonSGFWriter *self,
-                                                GSGFGameTree *game_tree,
+                                        const GibbonMove *move);
+static gboolean gibbon_sgf_writer_special_move (GibbonSGFWriterState *state,
                                                 GibbonPositionSide side,
-                                                const gchar *special,
-                                                GError **error);
-static gboolean gibbon_sgf_writer_resign (const GibbonSGFWriter *self,
-                                          GSGFGameTree *game_tree,
-                                          GibbonPositionSide side,
-                                          GibbonResign *resign, GError **error);
+                                                const gchar *special);
+static gboolean gibbon_sgf_writer_stones (GibbonSGFWriterState *state,
+                                          const gchar *id,
+                                          const gint *points,
+                                          gint sign, guint bar);
 static guint translate_point (guint point, GibbonPositionSide side);
-static gboolean gibbon_sgf_writer_setup (const GibbonSGFWriter *self,
-                                         GSGFGameTree *game_tree,
-                                         const GibbonGame *game,
-                                         const GibbonMatch *match,
-                                         GError **error);
-
-static const GSGFFlavor *gibbon_sgf_writer_flavor;
+static gboolean gibbon_sgf_writer_setup (GibbonSGFWriterState *state,
+                                         const GibbonGame *game);
+static gboolean gibbon_sgf_writer_puts (GibbonSGFWriterState *state,
+                                        const gchar *str);
+static gboolean gibbon_sgf_writer_printf (GibbonSGFWriterState *state,
+                                          const gchar *format, ...)
+                                          G_GNUC_PRINTF (2, 3);
 
 static void 
 gibbon_sgf_writer_init (GibbonSGFWriter *self)
@@ -99,8 +110,6 @@ gibbon_sgf_writer_class_init (GibbonSGFWriterClass *klass)
         GibbonMatchWriterClass *gibbon_match_writer_class =
                         GIBBON_MATCH_WRITER_CLASS (klass);
 
-        gibbon_sgf_writer_flavor = gsgf_flavor_backgammon_new ();
-
         gibbon_match_writer_class->write_stream =
                         gibbon_sgf_writer_write_stream;
         
@@ -129,11 +138,9 @@ gibbon_sgf_writer_write_stream (const GibbonMatchWriter *_self,
 {
         const GibbonSGFWriter *self;
         GibbonGame *game;
-        GSGFCollection *collection;
-        GSGFGameTree *game_tree;
-        gsize bytes_written;
+        GibbonSGFWriterState state;
         gsize game_number;
-        const GSGFFlavor *flavor = gibbon_sgf_writer_flavor;
+        gboolean success = TRUE;
 
         self = GIBBON_SGF_WRITER (_self);
         g_return_val_if_fail (self != NULL, FALSE);
@@ -146,187 +153,103 @@ gibbon_sgf_writer_write_stream (const GibbonMatchWriter *_self,
                 return FALSE;
         }
 
-        collection = gsgf_collection_new ();
+        /* Nothing is written to @out if an error occurs.  */
+        state.out = g_memory_output_stream_new (NULL, 0, g_realloc, g_free);
+        state.error = error;
+        state.roll_pending = FALSE;
 
-
-        for (game_number = 0; ; ++game_number) {
+        for (game_number = 0; success; ++game_number) {
                 game = gibbon_match_get_nth_game (match, game_number);
                 if (!game)
                         break;
 
-                game_tree = gsgf_collection_add_game_tree (collection,
-                                                           flavor);
-                if (!game_tree) {
-                        g_object_unref (collection);
-                        return FALSE;
-                }
+                success = gibbon_sgf_writer_add_game (&state, game,
+                                                      game_number, match);
 
-                if (!gibbon_sgf_writer_add_game (self, game_tree, game,
-                                                 game_number, match, error)) {
-                        g_object_unref (collection);
-                        return FALSE;
-                }
-
-                if (!game_number
+                if (success && !game_number
                     && !gibbon_position_is_initial (
-                                    gibbon_game_get_initial_position (game))) {
-                        if (!gibbon_sgf_writer_setup (self, game_tree,
-                                                      game, match, error)) {
-                                g_object_unref (collection);
-                                return FALSE;
-                        }
-                }
+                                    gibbon_game_get_initial_position (game)))
+                        success = gibbon_sgf_writer_setup (&state, game);
 
-                if (!gibbon_sgf_writer_write_game (self, game_tree, game,
-                                                   error)) {
-                        g_object_unref (collection);
-                        return FALSE;
-                }
+                if (success)
+                        success = gibbon_sgf_writer_write_game (&state, game);
+
+                if (success)
+                        success = gibbon_sgf_writer_puts (&state, ")\n");
         }
 
-        return gsgf_component_write_stream (GSGF_COMPONENT (collection),
-                                            out, &bytes_written, NULL, error);
+        if (success)
+                success = g_output_stream_close (state.out, NULL, error);
+        if (success)
+                success = g_output_stream_write_all (
+                        out,
+                        g_memory_output_stream_get_data (
+                                G_MEMORY_OUTPUT_STREAM (state.out)),
+                        g_memory_output_stream_get_data_size (
+                                G_MEMORY_OUTPUT_STREAM (state.out)),
+                        NULL, NULL, error);
+        g_object_unref (state.out);
+
+        return success;
 }
 
 /*
  * Note that we swap black and white on output so that Gibbon's notion of black
  * and white matches that of GNU Backgammon.
+ *
+ * The properties of a node are written in the order that GNUBG expects:
+ * FF, GM, CA, and AP first, then the others alphabetically.
  */
 static gboolean
-gibbon_sgf_writer_add_game (const GibbonSGFWriter *self,
-                            GSGFGameTree *game_tree,
+gibbon_sgf_writer_add_game (GibbonSGFWriterState *state,
                             const GibbonGame *game, guint game_number,
-                            const GibbonMatch *match,
-                            GError **error)
+                            const GibbonMatch *match)
 {
-        GSGFNode *root;
-        const gchar *text;
-        gchar *str;
-        GSGFValue *simple_text;
-        GSGFValue *match_info;
-        GSGFCookedValue *mi_key, *mi_value;
-        GSGFCookedValue *mi_compose;
-        const GSGFFlavor *flavor = gibbon_sgf_writer_flavor;
+        const gchar *black, *white;
         const GibbonPosition *pos;
         gint score;
-        GSGFValue *result = NULL;
-        GSGFResultCause cause;
-
-        if (!gsgf_game_tree_set_application (game_tree,
-                                             PACKAGE, VERSION,
-                                             error))
-                return FALSE;
-
-        root = gsgf_game_tree_add_node (game_tree);
-
-        text = gibbon_match_get_black (match);
-        if (!text)
-                text = "white";
-        simple_text = GSGF_VALUE (gsgf_simple_text_new (text));
-        if (!gsgf_node_set_property (root, "PW", simple_text, error)) {
-                g_object_unref (simple_text);
-                return FALSE;
-        }
 
-        text = gibbon_match_get_white (match);
-        if (!text)
-                text = "black";
-        simple_text = GSGF_VALUE (gsgf_simple_text_new (text));
-        if (!gsgf_node_set_property (root, "PB", simple_text, error)) {
-                g_object_unref (simple_text);
+        if (!gibbon_sgf_writer_printf (state,
+                                       "(;FF[4]GM[%d]CA[UTF-8]"
+                                       "AP[%s (libgsgf):%s (%s)]",
+                                       GIBBON_SGF_WRITER_GAME_ID,
+                                       PACKAGE, VERSION, VERSION))
                 return FALSE;
-        }
 
-        if (gibbon_match_get_crawford (match)) {
-                text = gibbon_game_is_crawford (game) ?
-                                "Crawford:CrawfordGame" : "Crawford";
-                 simple_text = GSGF_VALUE (gsgf_simple_text_new (text));
-                 if (!gsgf_node_set_property (root, "RU", simple_text, error)) {
-                         g_object_unref (simple_text);
-                         return FALSE;
-                 }
-        }
-
-        match_info = GSGF_VALUE (gsgf_list_of_new (gsgf_compose_get_type (),
-                                                   flavor));
-        if (!gsgf_node_set_property (root, "MI", match_info, error)) {
-                g_object_unref (match_info);
+        pos = gibbon_game_get_initial_position (game);
+        if (!gibbon_sgf_writer_printf (state,
+                                       "MI[length:%llu][game:%u]"
+                                       "[ws:%llu][bs:%llu]",
+                                       (unsigned long long)
+                                       gibbon_match_get_length (match),
+                                       game_number,
+                                       (unsigned long long) pos->scores[1],
+                                       (unsigned long long) pos->scores[0]))
                 return FALSE;
-        }
 
-        mi_key = GSGF_COOKED_VALUE (gsgf_simple_text_new ("length"));
-        str = g_strdup_printf ("%llu", (unsigned long long)
-                                gibbon_match_get_length (match));
-        mi_value = GSGF_COOKED_VALUE (gsgf_simple_text_new (str));
-        g_free (str);
-        mi_compose = GSGF_COOKED_VALUE (gsgf_compose_new (mi_key, mi_value,
-                                                          NULL));
-        if (!gsgf_list_of_append (GSGF_LIST_OF (match_info),
-                                  mi_compose, error)) {
-                g_object_unref (mi_key);
-                g_object_unref (mi_value);
-                g_object_unref (mi_compose);
+        black = gibbon_match_get_white (match);
+        if (!black)
+                black = "black";
+        white = gibbon_match_get_black (match);
+        if (!white)
+                white = "white";
+        if (!gibbon_sgf_writer_printf (state, "PB[%s]PW[%s]", black, white))
                 return FALSE;
-        }
 
-        mi_key = GSGF_COOKED_VALUE (gsgf_simple_text_new ("game"));
-        str = g_strdup_printf ("%u", game_number);
-        mi_value = GSGF_COOKED_VALUE (gsgf_simple_text_new (str));
-        g_free (str);
-        mi_compose = GSGF_COOKED_VALUE (gsgf_compose_new (mi_key, mi_value,
-                                                          NULL));
-        if (!gsgf_list_of_append (GSGF_LIST_OF (match_info),
-                                  mi_compose, error)) {
-                g_object_unref (mi_key);
-                g_object_unref (mi_value);
-                g_object_unref (mi_compose);
-                return FALSE;
-        }
-
-        pos = gibbon_game_get_initial_position (game);
-
-        mi_key = GSGF_COOKED_VALUE (gsgf_simple_text_new ("ws"));
-        str = g_strdup_printf ("%llu", (unsigned long long) pos->scores[1]);
-        mi_value = GSGF_COOKED_VALUE (gsgf_simple_text_new (str));
-        g_free (str);
-        mi_compose = GSGF_COOKED_VALUE (gsgf_compose_new (mi_key, mi_value,
-                                                          NULL));
-        if (!gsgf_list_of_append (GSGF_LIST_OF (match_info),
-                                  mi_compose, error)) {
-                g_object_unref (mi_key);
-                g_object_unref (mi_value);
-                g_object_unref (mi_compose);
+        score = gibbon_game_over (game);
+        if (score
+            && !gibbon_sgf_writer_printf (state, "RE[%c+%d%s]",
+                                          score > 0 ? 'B' : 'W', abs (score),
+                                          gibbon_game_resignation (game)
+                                          ? "Resign" : ""))
                 return FALSE;
-        }
 
-        mi_key = GSGF_COOKED_VALUE (gsgf_simple_text_new ("bs"));
-        str = g_strdup_printf ("%llu", (unsigned long long) pos->scores[0]);
-        mi_value = GSGF_COOKED_VALUE (gsgf_simple_text_new (str));
-        g_free (str);
-        mi_compose = GSGF_COOKED_VALUE (gsgf_compose_new (mi_key, mi_value,
-                                                          NULL));
-        if (!gsgf_list_of_append (GSGF_LIST_OF (match_info),
-                                  mi_compose, error)) {
-                g_object_unref (mi_key);
-                g_object_unref (mi_value);
-                g_object_unref (mi_compose);
+        if (gibbon_match_get_crawford (match)
+            && !gibbon_sgf_writer_printf (state, "RU[%s]",
+                                          gibbon_game_is_crawford (game)
+                                          ? "Crawford:CrawfordGame"
+                                          : "Crawford"))
                 return FALSE;
-        }
-
-        score = gibbon_game_over (game);
-        cause = gibbon_game_resignation (game)
-                        ? GSGF_RESULT_RESIGNATION : GSGF_RESULT_NORMAL;
-        if (score > 0)
-                result = GSGF_VALUE (gsgf_result_new (GSGF_RESULT_BLACK, score,
-                                                      cause));
-        else if (score < 0)
-                result = GSGF_VALUE (gsgf_result_new (GSGF_RESULT_WHITE, -score,
-                                                      cause));
-        if (result
-            && !gsgf_node_set_property (root, "RE", result, error)) {
-                        g_object_unref (result);
-                        return FALSE;
-        }
 
         return TRUE;
 }
@@ -336,162 +259,101 @@ gibbon_sgf_writer_add_game (const GibbonSGFWriter *self,
  * and white matches that of GNU Backgammon.
  */
 static gboolean
-gibbon_sgf_writer_write_game (const GibbonSGFWriter *self,
-                              GSGFGameTree *game_tree,
-                              const GibbonGame *game,
-                              GError **error)
+gibbon_sgf_writer_write_game (GibbonSGFWriterState *state,
+                              const GibbonGame *game)
 {
         glong action_num;
         GibbonPositionSide side;
         const GibbonGameAction *action = NULL;
+        const GibbonRoll *roll;
+        gboolean success = TRUE;
+        gchar *special;
 
-        for (action_num = 0; ; ++action_num) {
+        for (action_num = 0; success; ++action_num) {
                 action = gibbon_game_get_nth_action (game, action_num, &side);
                 if (!action)
                         break;
+                if (!side)
+                        continue;
                 if (GIBBON_IS_ROLL (action)) {
-                        if (!side)
-                                continue;
-                        if (!gibbon_sgf_writer_roll (self, game_tree, side,
-                                                     GIBBON_ROLL (action),
-                                                     error))
-                                return FALSE;
+                        success = gibbon_sgf_writer_flush_roll (state);
+                        roll = GIBBON_ROLL (action);
+                        state->roll_pending = TRUE;
+                        state->roll_side = side;
+                        state->roll[0] = roll->die1;
+                        state->roll[1] = roll->die2;
                 } else if (GIBBON_IS_MOVE (action)) {
-                        if (!side)
-                                continue;
-                        if (!gibbon_sgf_writer_move (self, game_tree, side,
-                                                     GIBBON_MOVE (action),
-                                                     error))
-                                return FALSE;
+                        success = gibbon_sgf_writer_move (state, side,
+                                                          GIBBON_MOVE (action));
                 } else if (GIBBON_IS_DOUBLE (action)) {
-                        if (!side)
-                                continue;
-                        if (!gibbon_sgf_writer_special_move (self, game_tree,
-                                                             side, "double",
-                                                             error))
-                                return FALSE;
+                        success = gibbon_sgf_writer_special_move (state, side,
+                                                                  "double");
                 } else if (GIBBON_IS_TAKE (action)) {
-                        if (!side)
-                                continue;
-                        if (!gibbon_sgf_writer_special_move (self, game_tree,
-                                                             side, "take",
-                                                             error))
-                                return FALSE;
+                        success = gibbon_sgf_writer_special_move (state, side,
+                                                                  "take");
                 } else if (GIBBON_IS_DROP (action)) {
-                        if (!side)
-                                continue;
-                        if (!gibbon_sgf_writer_special_move (self, game_tree,
-                                                             side, "drop",
-                                                             error))
-                                return FALSE;
+                        success = gibbon_sgf_writer_special_move (state, side,
+                                                                  "drop");
                 } else if (GIBBON_IS_RESIGN (action)) {
-                        if (!side)
-                                continue;
-                        if (!gibbon_sgf_writer_resign (self, game_tree, side,
-                                                       GIBBON_RESIGN (action),
-                                                       error))
-                                return FALSE;
+                        special = g_strdup_printf ("resign:%u",
+                                        GIBBON_RESIGN (action)->value
+                                        ? GIBBON_RESIGN (action)->value : 1);
+                        success = gibbon_sgf_writer_special_move (state, side,
+                                                                  special);
+                        g_free (special);
                 } else if (GIBBON_IS_ACCEPT (action)) {
-                        if (!side)
-                                continue;
-                        if (!gibbon_sgf_writer_special_move (self, game_tree,
-                                                             side, "accept",
-                                                             error))
-                                return FALSE;
+                        success = gibbon_sgf_writer_special_move (state, side,
+                                                                  "accept");
                 } else if (GIBBON_IS_REJECT (action)) {
-                        if (!side)
-                                continue;
-                        if (!gibbon_sgf_writer_special_move (self, game_tree,
-                                                             side, "reject",
-                                                             error))
-                                return FALSE;
+                        success = gibbon_sgf_writer_special_move (state, side,
+                                                                  "reject");
                 }
         }
 
-        return TRUE;
+        if (success)
+                success = gibbon_sgf_writer_flush_roll (state);
+        state->roll_pending = FALSE;
+
+        return success;
 }
 
 static gboolean
-gibbon_sgf_writer_setup (const GibbonSGFWriter *self, GSGFGameTree *game_tree,
-                         const GibbonGame *game, const GibbonMatch *match,
-                         GError **error)
+gibbon_sgf_writer_setup (GibbonSGFWriterState *state, const GibbonGame *game)
 {
-        GSGFNode *node;
         const GibbonPosition *pos = gibbon_game_get_initial_position (game);
-        GSGFListOf *list_of;
-        GSGFFlavor *flavor;
-        gint i, j;
-        GSGFPointBackgammon *point;
-        GSGFStoneBackgammon *stone;
-        guint borne_off;
-        GSGFColor *color;
-        GSGFNumber *number;
-        gchar *buffer;
-        GSGFValue *simple_text;
-        gchar cube_position[2];
-
-        flavor = gsgf_flavor_backgammon_new ();
+        gchar cube_position;
 
         /*
          * GNUBG expects the PL and DI properties separated from the
          * subsequent AE, AB, and AW properties.
          */
         if (pos->turn || pos->dice[0] || pos->dice[1]) {
-                node = gsgf_game_tree_add_node (game_tree);
-                if (pos->dice[0] || pos->dice[1]) {
-
-                }
-                if (pos->turn) {
-                        color = gsgf_color_new (pos->turn < 0
-                                        ? GSGF_COLOR_WHITE : GSGF_COLOR_BLACK);
-                        if (!gsgf_node_set_property (node, "PL",
-                                                     GSGF_VALUE (color),
-                                                     error)) {
-                                g_object_unref (color);
-                                return FALSE;
-                        }
-                }
-                if (pos->dice[0] || pos->dice[1]) {
-                        number = gsgf_number_new (abs (pos->dice[0] * 10)
-                                                  + abs (pos->dice[1]));
-                        if (!gsgf_node_set_property (node, "DI",
-                                                      GSGF_VALUE (number),
-                                                      error)) {
-                                g_object_unref (color);
-                                return FALSE;
-                        }
-                }
-        }
-
-        if (pos->cube > 1) {
-                buffer = g_strdup_printf ("%llu",
-                                          (unsigned long long) pos->cube);
-                simple_text = GSGF_VALUE (gsgf_simple_text_new (buffer));
-                g_free (buffer);
-
-                node = gsgf_game_tree_add_node (game_tree);
-                if (!gsgf_node_set_property (node, "CV", simple_text, error)) {
-                        g_object_unref (simple_text);
+                if (!gibbon_sgf_writer_puts (state, "\n;"))
+                        return FALSE;
+                if (pos->turn
+                    && !gibbon_sgf_writer_puts (state, pos->turn < 0
+                                                ? "PL[W]" : "PL[B]"))
+                        return FALSE;
+                if ((pos->dice[0] || pos->dice[1])
+                    && !gibbon_sgf_writer_printf (state, "DI[%d]",
+                                                  abs (pos->dice[0] * 10)
+                                                  + abs (pos->dice[1])))
                         return FALSE;
-                }
         }
 
+        if (pos->cube > 1
+            && !gibbon_sgf_writer_printf (state, "\n;CV[%llu]",
+                                          (unsigned long long) pos->cube))
+                return FALSE;
+
         if (pos->may_double[0] && pos->may_double[1])
-                cube_position[0] = 'c';
+                cube_position = 'c';
         else if (pos->may_double[0])
-                cube_position[0] = 'b';
+                cube_position = 'b';
         else if (pos->may_double[1])
-                cube_position[0] = 'w';
+                cube_position = 'w';
         else
-                cube_position[0] = 'n';
-        cube_position[1] = 0;
-        simple_text = GSGF_VALUE (gsgf_simple_text_new (cube_position));
-
-        node = gsgf_game_tree_add_node (game_tree);
-        if (!gsgf_node_set_property (node, "CO", simple_text, error)) {
-                g_object_unref (simple_text);
-                return FALSE;
-        }
+                cube_position = 'n';
 
         /*
          * This is plain wrong.  CP is used for copyright notices, not for
@@ -499,316 +361,178 @@ gibbon_sgf_writer_setup (const GibbonSGFWriter *self, GSGFGameTree *game_tree,
          * as GNUBG does not fix that bug, there is no point on insisting on
          * the correct syntax.  Instead, we write both properties.
          */
-        node = gsgf_game_tree_add_node (game_tree);
-        if (!gsgf_node_set_property (node, "CP", simple_text, error)) {
-                g_object_unref (simple_text);
+        if (!gibbon_sgf_writer_printf (state, "\n;CO[%c]\n;CP[%c]",
+                                       cube_position, cube_position))
                 return FALSE;
-        }
 
         /*
          * Set black and white points.  Be careful to swap sides to ensure
          * compatibility with GNUBG.
          */
-        if (memcmp (pos->points, gibbon_position_initial ()->points,
-                    sizeof pos->points)) {
-                node = gsgf_game_tree_add_node (game_tree);
-
-                /*
-                 * Clear empty points.  GNUBG currently clears all points
-                 * plus the bar, no matter what the distribution of checkers
-                 * is.  That violates the SGF specification which explicitely
-                 * states that stones/points for AE, AB, and AW should not
-                 * overwrite each other.
-                 *
-                 * Besides, the bar is shared between black and white, and it
-                 * makes no sense to clear it.
-                 *
-                 * However, we must follow the bad example and clear at leaste
-                 * all regular points because GNUBG will not recognize
-                 * correctly encoded positions.
-                 */
-                list_of = gsgf_list_of_new (GSGF_TYPE_POINT_BACKGAMMON, flavor);
-                for (i = 23; i >= 0; --i) {
-                        point = gsgf_point_backgammon_new (23 - i);
-                        if (!gsgf_list_of_append (list_of,
-                                                  GSGF_COOKED_VALUE (point),
-                                                  error)) {
-                                g_object_unref (list_of);
-                                return FALSE;
-                        }
-                }
-                if (!gsgf_node_set_property (node, "AE",
-                                             GSGF_VALUE (list_of), error)) {
-                        g_object_unref (list_of);
-                        return FALSE;
-                }
+        if (!memcmp (pos->points, gibbon_position_initial ()->points,
+                     sizeof pos->points))
+                return TRUE;
 
-                list_of = gsgf_list_of_new (GSGF_TYPE_STONE_BACKGAMMON, flavor);
-                for (i = 23; i >= 0; --i) {
-                        if (pos->points[i] >= 0)
-                                continue;
-                        for (j = pos->points[i]; j < 0; ++j) {
-                                stone = gsgf_stone_backgammon_new (23 - i);
-                                if (!gsgf_list_of_append (list_of,
-                                                      GSGF_COOKED_VALUE (stone),
-                                                         error)) {
-                                        g_object_unref (list_of);
-                                        return FALSE;
-                                }
-                        }
-                }
-                for (j = pos->bar[1]; j < 0; ++j) {
-                        stone = gsgf_stone_backgammon_new (24);
-                        if (!gsgf_list_of_append (list_of,
-                                              GSGF_COOKED_VALUE (stone),
-                                                 error)) {
-                                g_object_unref (list_of);
-                                return FALSE;
-                        }
-                }
-                borne_off = gibbon_position_get_borne_off (pos,
-                                                    GIBBON_POSITION_SIDE_BLACK);
-                for (j = borne_off; j < 0; ++j) {
-                        stone = gsgf_stone_backgammon_new (25);
-                        if (!gsgf_list_of_append (list_of,
-                                              GSGF_COOKED_VALUE (stone),
-                                                 error)) {
-                                g_object_unref (list_of);
-                                return FALSE;
-                        }
-                }
-                if (!gsgf_node_set_property (node, "AW",
-                                             GSGF_VALUE (list_of),
-                                             error)) {
-                        g_object_unref (list_of);
-                        return FALSE;
-                }
+        /*
+         * Clear empty points.  GNUBG currently clears all points
+         * plus the bar, no matter what the distribution of checkers
+         * is.  That violates the SGF specification which explicitely
+         * states that stones/points for AE, AB, and AW should not
+         * overwrite each other.
+         *
+         * Besides, the bar is shared between black and white, and it
+         * makes no sense to clear it.
+         *
+         * However, we must follow the bad example and clear at leaste
+         * all regular points because GNUBG will not recognize
+         * correctly encoded positions.
+         */
+        if (!gibbon_sgf_writer_puts (state, "\n;AE[a:x]"))
+                return FALSE;
 
-                list_of = gsgf_list_of_new (GSGF_TYPE_STONE_BACKGAMMON, flavor);
-                for (i = 23; i >= 0; --i) {
-                        if (pos->points[i] <= 0)
-                                continue;
-                        for (j = 0; j < pos->points[i]; ++j) {
-                                stone = gsgf_stone_backgammon_new (23 - i);
-                                if (!gsgf_list_of_append (list_of,
-                                                      GSGF_COOKED_VALUE (stone),
-                                                         error)) {
-                                        g_object_unref (list_of);
-                                        return FALSE;
-                                }
-                        }
-                }
-                for (j = 0; j < pos->bar[0]; ++j) {
-                        stone = gsgf_stone_backgammon_new (24);
-                        if (!gsgf_list_of_append (list_of,
-                                              GSGF_COOKED_VALUE (stone),
-                                                 error)) {
-                                g_object_unref (list_of);
-                                return FALSE;
-                        }
-                }
+        if (!gibbon_sgf_writer_stones (state, "AB", pos->points, 1,
+                                       pos->bar[0]))
+                return FALSE;
+
+        /* FIXME! Black checkers on the bar have never been written.  */
+        return gibbon_sgf_writer_stones (state, "AW", pos->points, -1, 0);
+}
 
-                borne_off = gibbon_position_get_borne_off (pos,
-                                                    GIBBON_POSITION_SIDE_WHITE);
-                for (j = borne_off; j < 0; ++j) {
-                        stone = gsgf_stone_backgammon_new (25);
-                        if (!gsgf_list_of_append (list_of,
-                                              GSGF_COOKED_VALUE (stone),
-                                                 error)) {
-                                g_object_unref (list_of);
+/*
+ * Write the stones of the side given by @sign, one value per checker.
+ * Point 24 is the bar.
+ */
+static gboolean
+gibbon_sgf_writer_stones (GibbonSGFWriterState *state, const gchar *id,
+                          const gint *points, gint sign, guint bar)
+{
+        gint i, j;
+        gboolean first = TRUE;
+
+        for (i = 23; i >= 0; --i) {
+                for (j = 0; j < sign * points[i]; ++j) {
+                        if (!gibbon_sgf_writer_printf (state, "%s[%c",
+                                                       first ? id : "]",
+                                                       'a' + 23 - i))
                                 return FALSE;
-                        }
+                        first = FALSE;
                 }
-                if (!gsgf_node_set_property (node, "AB",
-                                             GSGF_VALUE (list_of),
-                                             error)) {
-                        g_object_unref (list_of);
+        }
+
+        for (j = 0; j < bar; ++j) {
+                if (!gibbon_sgf_writer_printf (state, "%s[y", first ? id : "]"))
                         return FALSE;
-                }
+                first = FALSE;
         }
 
-        return TRUE;
+        if (first) {
+                g_set_error_literal (state->error, GIBBON_ERROR, -1,
+                                     _("Attempt to write empty property"));
+                return FALSE;
+        }
+
+        return gibbon_sgf_writer_puts (state, "]");
+}
+
+static gboolean
+gibbon_sgf_writer_flush_roll (GibbonSGFWriterState *state)
+{
+        if (!state->roll_pending)
+                return TRUE;
+
+        state->roll_pending = FALSE;
+
+        return gibbon_sgf_writer_printf (state, "\n;PL[%s]DI[%u%u]",
+                                         state->roll_side
+                                         == GIBBON_POSITION_SIDE_WHITE
+                                         ? "Black" : "White",
+                                         state->roll[0], state->roll[1]);
 }
 
 static gboolean
-gibbon_sgf_writer_roll (const GibbonSGFWriter *self,
-                        GSGFGameTree *game_tree,
-                        GibbonPositionSide side,
-                        GibbonRoll *roll, GError **error)
+gibbon_sgf_writer_move (GibbonSGFWriterState *state, GibbonPositionSide side,
+                        const GibbonMove *move)
 {
-        gchar *buffer;
-        GSGFValue *simple_text;
-        GSGFNode *node;
+        gsize i;
 
-        buffer = g_strdup_printf ("%d%d", roll->die1, roll->die2);
-        simple_text = GSGF_VALUE (gsgf_simple_text_new (buffer));
-        g_free (buffer);
+        gibbon_return_val_if_fail (move->number < 5, FALSE, state->error);
 
-        node = gsgf_game_tree_add_node (game_tree);
-        if (!gsgf_node_set_property (node, "DI", simple_text, error)) {
-                g_object_unref (simple_text);
+        if (move->die1 < 1 || move->die1 > 6
+            || move->die2 < 1 || move->die2 > 6) {
+                g_set_error (state->error, GIBBON_ERROR, -1,
+                             _("Invalid dice %u and %u"),
+                             move->die1, move->die2);
                 return FALSE;
         }
 
-        if (side == GIBBON_POSITION_SIDE_WHITE)
-                simple_text = GSGF_VALUE (gsgf_simple_text_new ("Black"));
-        else
-                simple_text = GSGF_VALUE (gsgf_simple_text_new ("White"));
-        if (!gsgf_node_set_property (node, "PL", simple_text, error)) {
-                g_object_unref (simple_text);
+        /* The move replaces the properties of a pending roll.  */
+        state->roll_pending = FALSE;
+
+        if (!gibbon_sgf_writer_printf (state, "\n;%s[%u%u",
+                                       side == GIBBON_POSITION_SIDE_WHITE
+                                       ? "B" : "W",
+                                       move->die1, move->die2))
                 return FALSE;
+
+        for (i = 0; i < move->number; ++i) {
+                if (!gibbon_sgf_writer_printf (state, "%c%c",
+                                               'a' + translate_point (
+                                                  move->movements[i].from,
+                                                  side),
+                                               'a' + translate_point (
+                                                  move->movements[i].to,
+                                                  side)))
+                        return FALSE;
         }
 
-        return TRUE;
+        return gibbon_sgf_writer_puts (state, "]");
 }
 
-static
-gboolean gibbon_sgf_writer_move (const GibbonSGFWriter *self,
-                                 GSGFGameTree *game_tree,
-                                 GibbonPositionSide side,
-                                 GibbonMove *move, GError **error)
+static gboolean
+gibbon_sgf_writer_special_move (GibbonSGFWriterState *state,
+                                GibbonPositionSide side, const gchar *special)
 {
-        GList *last_element;
-        GSGFNode *node = NULL;
-        const gchar *side_str;
-        GSGFMoveBackgammon *gsgf_move;
-
-        gibbon_return_val_if_fail (move->number < 5, FALSE, error);
-
-        last_element = gsgf_game_tree_get_last_node (game_tree);
-        if (last_element) {
-                node = last_element->data;
-                if (gsgf_node_get_property (node, "DI")
-                    && gsgf_node_get_property (node, "PL")) {
-                        gsgf_node_remove_property (node, "DI");
-                        gsgf_node_remove_property (node, "PL");
-                } else {
-                        node = NULL;
-                }
-        }
-
-        if (!node)
-                node = gsgf_game_tree_add_node (game_tree);
-
-        switch (move->number) {
-        case 0:
-                gsgf_move = gsgf_move_backgammon_new_regular (move->die1,
-                                                              move->die2,
-                                                              error, -1);
-                break;
-        case 1:
-                gsgf_move = gsgf_move_backgammon_new_regular (
-                                move->die1, move->die2, error,
-                                translate_point (move->movements[0].from,
-                                                 side),
-                                translate_point (move->movements[0].to,
-                                                side),
-                                -1);
-                break;
-        case 2:
-                gsgf_move = gsgf_move_backgammon_new_regular (
-                                move->die1, move->die2, error,
-                                translate_point (move->movements[0].from,
-                                                 side),
-                                translate_point (move->movements[0].to,
-                                                 side),
-                                translate_point (move->movements[1].from,
-                                                 side),
-                                translate_point (move->movements[1].to,
-                                                 side),
-                                -1);
-                break;
-        case 3:
-                gsgf_move = gsgf_move_backgammon_new_regular (
-                                move->die1, move->die2, error,
-                                translate_point (move->movements[0].from,
-                                                 side),
-                                translate_point (move->movements[0].to,
-                                                 side),
-                                translate_point (move->movements[1].from,
-                                                 side),
-                                translate_point (move->movements[1].to,
-                                                 side),
-                                translate_point (move->movements[2].from,
-                                                 side),
-                                translate_point (move->movements[2].to,
-                                                 side),
-                                -1);
-                break;
-        case 4:
-                gsgf_move = gsgf_move_backgammon_new_regular (
-                                move->die1, move->die2, error,
-                                translate_point (move->movements[0].from,
-                                                 side),
-                                translate_point (move->movements[0].to,
-                                                 side),
-                                translate_point (move->movements[1].from,
-                                                 side),
-                                translate_point (move->movements[1].to,
-                                                 side),
-                                translate_point (move->movements[2].from,
-                                                 side),
-                                translate_point (move->movements[2].to,
-                                                 side),
-                                translate_point (move->movements[3].from,
-                                                 side),
-                                translate_point (move->movements[3].to,
-                                                 side),
-                                -1);
-                break;
-        default:
-                return FALSE; /* NOT_REACHED */
-        }
-        if (!gsgf_move)
+        if (!gibbon_sgf_writer_flush_roll (state))
                 return FALSE;
 
-        side_str = side == GIBBON_POSITION_SIDE_WHITE ? "B" : "W";
-        if (!gsgf_node_set_property (node, side_str, GSGF_VALUE (gsgf_move),
-                                     error)) {
-                g_object_unref (gsgf_move);
-                return FALSE;
-        }
+        return gibbon_sgf_writer_printf (state, "\n;%s[%s]",
+                                         side == GIBBON_POSITION_SIDE_WHITE
+                                         ? "B" : "W", special);
+}
 
-        return TRUE;
+static gboolean
+gibbon_sgf_writer_puts (GibbonSGFWriterState *state, const gchar *str)
+{
+        return g_output_stream_write_all (state->out, str, strlen (str),
+                                          NULL, NULL, state->error);
 }
 
-static
-gboolean gibbon_sgf_writer_special_move (const GibbonSGFWriter *self,
-                                         GSGFGameTree *game_tree,
-                                         GibbonPositionSide side,
-                                         const gchar *special, GError **error)
+static gboolean
+gibbon_sgf_writer_printf (GibbonSGFWriterState *state,
+                          const gchar *format, ...)
 {
-        GSGFNode *node = NULL;
-        const gchar *side_str;
-        GSGFMoveBackgammon *gsgf_move;
+        va_list args;
+        gchar buffer[256];
+        gchar *str;
+        gint length;
+        gboolean retval;
 
-        gsgf_move = gsgf_move_backgammon_new_from_string (special, error);
-        if (!gsgf_move)
-                return FALSE;
+        /* Only player names can be longer than the buffer.  */
+        va_start (args, format);
+        length = g_vsnprintf (buffer, sizeof buffer, format, args);
+        va_end (args);
 
-        node = gsgf_game_tree_add_node (game_tree);
-        side_str = side == GIBBON_POSITION_SIDE_WHITE ? "B" : "W";
-        if (!gsgf_node_set_property (node, side_str, GSGF_VALUE (gsgf_move),
-                                     error)) {
-                g_object_unref (gsgf_move);
-                return FALSE;
-        }
+        if ((gsize) length < sizeof buffer)
+                return g_output_stream_write_all (state->out, buffer, length,
+                                                  NULL, NULL, state->error);
 
-        return TRUE;
-}
+        va_start (args, format);
+        str = g_strdup_vprintf (format, args);
+        va_end (args);
 
+        retval = gibbon_sgf_writer_puts (state, str);
+        g_free (str);
 
-static
-gboolean gibbon_sgf_writer_resign (const GibbonSGFWriter *self,
-                                   GSGFGameTree *game_tree,
-                                   GibbonPositionSide side,
-                                   GibbonResign *resign, GError **error)
-{
-        gchar *special = g_strdup_printf ("resign:%u", resign->value);
-        gboolean retval = gibbon_sgf_writer_special_move (self, game_tree,
-                                                          side, special,
-                                                          error);
-        g_free (special);
         return retval;
 }
 
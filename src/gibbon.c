@@ -38,6 +38,7 @@ static gchar *data_dir = NULL;
 static gchar *pixmaps_dir = NULL;
 static gchar *match_file = NULL;
 static gchar *debug = NULL;
+static gboolean compress_archive = FALSE;
 
 gboolean version;
 
@@ -55,6 +56,11 @@ static const GOptionEntry options[] =
                   N_("enable various debugging flags"),
                   NULL
                 },
+                { "compress-archive", 0, 0, G_OPTION_ARG_NONE,
+                  &compress_archive,
+                  N_("compress all archived match files and exit"),
+                  NULL
+                },
                 { "version", 'V', 0, G_OPTION_ARG_NONE, &version,
                   N_("output version information and exit"),
                   NULL
@@ -65,6 +71,7 @@ static const GOptionEntry options[] =
 static void print_version ();
 static void usage_error ();
 static gboolean parse_command_line (int argc, char *argv[]);
+static int compress_archive_files (void);
 #ifdef G_OS_WIN32
 static void setup_path (const gchar *installdir);
 static void init_i18n (const gchar *installdir);
@@ -106,6 +113,9 @@ main (int argc, char *argv[])
 	}
         gsgf_threads_init ();
 
+        if (compress_archive)
+                return compress_archive_files ();
+
         gtk_init (&argc, &argv);
 
         /* It is unsafe to guess that we are in a development environment
@@ -218,6 +228,29 @@ parse_command_line (int argc, char *argv[])
         return TRUE;
 }
 
+static int
+compress_archive_files (void)
+{
+        GError *error = NULL;
+        guint count;
+
+        g_type_init ();
+
+        /* This must work without a GibbonApp and without GTK+.  */
+        if (!gibbon_archive_compress (&count, &error)) {
+                g_printerr ("%s: %s\n", program_name, error->message);
+                g_error_free (error);
+                return 1;
+        }
+
+        g_print (g_dngettext (GETTEXT_PACKAGE,
+                              "%u match file compressed.\n",
+                              "%u match files compressed.\n", count),
+                 count);
+
+        return 0;
+}
+
 #ifdef G_OS_WIN32
 /*
  * Under Windows, shared libraries are searched in $PATH.  We have to make
@@ -0,0 +1,206 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <gibbon-position.h>
+#include <gibbon-bearoff.h>
+
+static gboolean test_index (void);
+static gboolean test_distribution (void);
+static gboolean test_position (void);
+
+int
+main (int argc, char *argv[])
+{
+        int status = 0;
+
+        g_type_init ();
+
+        if (!test_index ())
+                status = -1;
+        if (!test_distribution ())
+                status = -1;
+        if (!test_position ())
+                status = -1;
+
+        return status;
+}
+
+static gboolean
+test_index (void)
+{
+        guint8 *seen = g_malloc0 (GIBBON_BEAROFF_POSITIONS);
+        guint counts[GIBBON_BEAROFF_POINTS];
+        guint index, n = 0;
+        gboolean retval = TRUE;
+
+        /* The index must be a bijection.  */
+        for (counts[0] = 0; counts[0] <= 15; ++counts[0])
+        for (counts[1] = 0; counts[0] + counts[1] <= 15; ++counts[1])
+        for (counts[2] = 0; counts[0] + counts[1] + counts[2] <= 15;
+             ++counts[2])
+        for (counts[3] = 0; counts[0] + counts[1] + counts[2] + counts[3]
+             <= 15; ++counts[3])
+        for (counts[4] = 0; counts[0] + counts[1] + counts[2] + counts[3]
+             + counts[4] <= 15; ++counts[4])
+        for (counts[5] = 0; counts[0] + counts[1] + counts[2] + counts[3]
+             + counts[4] + counts[5] <= 15; ++counts[5]) {
+                index = gibbon_bearoff_index (counts);
+                if (index >= GIBBON_BEAROFF_POSITIONS || seen[index]) {
+                        g_printerr ("Bear-off index %u out of range or not"
+                                    " unique.\n", index);
+                        retval = FALSE;
+                        goto out;
+                }
+                seen[index] = 1;
+                ++n;
+        }
+
+        if (n != GIBBON_BEAROFF_POSITIONS) {
+                g_printerr ("Expected %u bear-off positions, got %u.\n",
+                            GIBBON_BEAROFF_POSITIONS, n);
+                retval = FALSE;
+        }
+
+out:
+        g_free (seen);
+
+        return retval;
+}
+
+static gboolean
+test_distribution (void)
+{
+        guint counts[GIBBON_BEAROFF_POINTS];
+        guint opponent[GIBBON_BEAROFF_POINTS];
+        gdouble p[GIBBON_BEAROFF_MAX_ROLLS];
+        gdouble rolls, win;
+        gboolean retval = TRUE;
+
+        /* A single checker on the six point is borne off in one roll,
+         * unless the roll is 1-1, 2-1, 3-1, 4-1, or 3-2.
+         */
+        memset (counts, 0, sizeof counts);
+        counts[5] = 1;
+        if (!gibbon_bearoff_get_distribution (counts, p)
+            || ABS (p[1] - 27.0 / 36.0) > 0.0001
+            || ABS (p[2] - 9.0 / 36.0) > 0.0001) {
+                g_printerr ("Wrong distribution for one checker on the"
+                            " six point: %f/%f.\n", p[1], p[2]);
+                retval = FALSE;
+        }
+        rolls = gibbon_bearoff_expected_rolls (counts);
+        if (ABS (rolls - 45.0 / 36.0) > 0.0001) {
+                g_printerr ("Expected 1.25 rolls for one checker on the six"
+                            " point, got %f.\n", rolls);
+                retval = FALSE;
+        }
+
+        /* Two checkers on the ace point are borne off in one roll.  */
+        memset (opponent, 0, sizeof opponent);
+        opponent[0] = 2;
+        win = gibbon_bearoff_win_probability (opponent, counts);
+        if (ABS (win - 1.0) > 0.0001) {
+                g_printerr ("Expected 100 %% winning chances, got %f %%.\n",
+                            100.0 * win);
+                retval = FALSE;
+        }
+        win = gibbon_bearoff_win_probability (counts, opponent);
+        if (ABS (win - 27.0 / 36.0) > 0.0001) {
+                g_printerr ("Expected 75 %% winning chances, got %f %%.\n",
+                            100.0 * win);
+                retval = FALSE;
+        }
+
+        /* Fifteen checkers on the ace point need eight rolls without
+         * doubles.
+         */
+        memset (counts, 0, sizeof counts);
+        counts[0] = 15;
+        if (!gibbon_bearoff_get_distribution (counts, p) || p[9] != 0.0
+            || p[3] != 0.0 || p[8] <= 0.0 || p[4] <= 0.0) {
+                g_printerr ("Wrong distribution for fifteen checkers on the"
+                            " ace point.\n");
+                retval = FALSE;
+        }
+
+        counts[1] = 1;
+        if (gibbon_bearoff_get_distribution (counts, p)
+            || gibbon_bearoff_expected_rolls (counts) >= 0.0) {
+                g_printerr ("Sixteen checkers were accepted.\n");
+                retval = FALSE;
+        }
+
+        return retval;
+}
+
+static gboolean
+test_position (void)
+{
+        GibbonPosition *pos = gibbon_position_new ();
+        gboolean retval = TRUE;
+        gdouble win;
+
+        if (gibbon_position_get_bearoff_rolls (pos, GIBBON_POSITION_SIDE_WHITE)
+            >= 0.0
+            || gibbon_position_get_bearoff_win (pos,
+                                                GIBBON_POSITION_SIDE_WHITE)
+            >= 0.0) {
+                g_printerr ("Initial position is not a bear-off position.\n");
+                retval = FALSE;
+        }
+
+        memset (pos->points, 0, sizeof pos->points);
+        pos->points[5] = 1;
+        pos->points[18] = -1;
+
+        /* Symmetric, and therefore a win for the side on roll.  */
+        win = gibbon_position_get_bearoff_win (pos,
+                                               GIBBON_POSITION_SIDE_BLACK);
+        if (ABS (win - 27.0 / 36.0 - 9.0 / 36.0 * 9.0 / 36.0) > 0.0001) {
+                g_printerr ("Wrong winning chances for black: %f %%.\n",
+                            100.0 * win);
+                retval = FALSE;
+        }
+        if (ABS (gibbon_position_get_bearoff_rolls (pos,
+                                                    GIBBON_POSITION_SIDE_WHITE)
+                 - 45.0 / 36.0) > 0.0001) {
+                g_printerr ("Wrong number of rolls for white.\n");
+                retval = FALSE;
+        }
+
+        /* A checker on the bar is not in the bear-off.  */
+        pos->bar[1] = 1;
+        if (gibbon_position_get_bearoff_win (pos, GIBBON_POSITION_SIDE_WHITE)
+            >= 0.0) {
+                g_printerr ("Checker on the bar was ignored.\n");
+                retval = FALSE;
+        }
+
+        gibbon_position_free (pos);
+
+        return retval;
+}
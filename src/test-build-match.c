@@ -31,6 +31,12 @@
 
 static GibbonMatch *fill_match (void);
 static gboolean check_match (const GibbonMatch *match);
+static gboolean check_positions (const GibbonMatch *match);
+static gboolean check_seek (const GibbonMatch *match);
+static gboolean check_batch (void);
+static void on_actions_appended (GibbonMatch *match,
+                                 const GibbonMatchRange *range,
+                                 GibbonMatchRange *last);
 
 int
 main(int argc, char *argv[])
@@ -46,6 +52,12 @@ main(int argc, char *argv[])
 
         if (!check_match (match))
                 status = -1;
+        if (!check_positions (match))
+                status = -1;
+        if (!check_seek (match))
+                status = -1;
+        if (!check_batch ())
+                status = -1;
 
         g_object_unref (match);
 
@@ -350,3 +362,165 @@ check_match (const GibbonMatch *match)
 
         return retval;
 }
+
+/*
+ * Positions are reconstructed from keyframes and deltas.  Retrieving them
+ * backwards must yield the same results as retrieving them in order.
+ */
+static gboolean
+check_positions (const GibbonMatch *match)
+{
+        gboolean retval = TRUE;
+        const GibbonGame *game;
+        const GibbonPosition *pos;
+        GibbonPosition **copies;
+        gsize num_actions, i;
+
+        game = gibbon_match_get_nth_game (match, 0);
+        g_return_val_if_fail (game != NULL, FALSE);
+
+        num_actions = gibbon_game_get_num_actions (game);
+        copies = g_new (GibbonPosition *, num_actions);
+        for (i = 0; i < num_actions; ++i)
+                copies[i] = gibbon_position_copy (
+                                gibbon_game_get_nth_position (game, i));
+
+        for (i = num_actions; i > 0; --i) {
+                pos = gibbon_game_get_nth_position (game, i - 1);
+                if (!gibbon_position_equals_technically (pos, copies[i - 1])
+                    || g_strcmp0 (pos->status, copies[i - 1]->status)
+                    || g_strcmp0 (pos->players[0], "Snow White")
+                    || g_strcmp0 (pos->players[1], "Joe Black")) {
+                        g_printerr ("Position #%u differs when retrieved"
+                                    " backwards.\n", (guint) i - 1);
+                        retval = FALSE;
+                }
+                gibbon_position_free (copies[i - 1]);
+        }
+        g_free (copies);
+
+        return retval;
+}
+
+static gboolean
+check_seek (const GibbonMatch *match)
+{
+        gboolean retval = TRUE;
+        const GibbonGame *game;
+        const GibbonPosition *expect, *got;
+        gsize num_games, game_no, got_game_no, n = 0;
+        gint num_actions, action_no, got_action_no;
+
+        num_games = gibbon_match_get_number_of_games (match);
+        for (game_no = 0; game_no < num_games; ++game_no) {
+                game = gibbon_match_get_nth_game (match, game_no);
+                num_actions = gibbon_game_get_num_actions (game);
+                for (action_no = -1; action_no < num_actions; ++action_no) {
+                        if (action_no < 0)
+                                expect = gibbon_game_get_initial_position (
+                                                game);
+                        else
+                                expect = gibbon_game_get_nth_position (
+                                                game, action_no);
+                        got = gibbon_match_seek (match, n, &got_game_no,
+                                                 &got_action_no);
+                        if (got_game_no != game_no
+                            || got_action_no != action_no
+                            || !gibbon_position_equals_technically (got,
+                                                                    expect)) {
+                                g_printerr ("Seeking position #%u failed.\n",
+                                            (guint) n);
+                                retval = FALSE;
+                        }
+                        ++n;
+                }
+        }
+
+        if (n != gibbon_match_get_number_of_positions (match)) {
+                g_printerr ("Expected %u positions in match, got %u.\n",
+                            (guint) n,
+                            (guint) gibbon_match_get_number_of_positions (
+                                    match));
+                retval = FALSE;
+        }
+
+        if (gibbon_match_seek (match, n, NULL, NULL)) {
+                g_printerr ("Seeking past the end of the match succeeded.\n");
+                retval = FALSE;
+        }
+
+        return retval;
+}
+
+static void
+on_actions_appended (GibbonMatch *match, const GibbonMatchRange *range,
+                     GibbonMatchRange *last)
+{
+        if (last->to)
+                last->from = G_MAXSIZE;
+        else
+                *last = *range;
+}
+
+static gboolean
+check_batch (void)
+{
+        gboolean retval = TRUE;
+        GibbonMatch *match = gibbon_match_new ("Snow White", "Joe Black",
+                                               0, TRUE);
+        GibbonMatchRange last = { 0, 0 };
+        GError *error = NULL;
+
+        g_signal_connect (G_OBJECT (match), "actions-appended",
+                          (GCallback) on_actions_appended, &last);
+
+        gibbon_match_begin_changes (match);
+        if (!gibbon_match_add_action (match, GIBBON_POSITION_SIDE_WHITE,
+                                      GIBBON_GAME_ACTION (gibbon_roll_new (3,
+                                                                           1)),
+                                      G_MININT64, &error)
+            || !gibbon_match_add_action (match, GIBBON_POSITION_SIDE_WHITE,
+                                         GIBBON_GAME_ACTION (
+                                                 gibbon_move_newv (3, 1, 8, 5,
+                                                                   6, 5, -1)),
+                                         G_MININT64, &error)) {
+                g_printerr ("Cannot add action: %s\n", error->message);
+                g_error_free (error);
+                g_object_unref (match);
+                return FALSE;
+        }
+        if (last.to) {
+                g_printerr ("Listener notified before end of batch.\n");
+                retval = FALSE;
+        }
+        gibbon_match_commit_changes (match);
+
+        /* The initial position of the new game and two actions.  */
+        if (last.from != 0 || last.to != 3) {
+                g_printerr ("Expected one notification for positions 0 to 3,"
+                            " got %u to %u.\n",
+                            (guint) last.from, (guint) last.to);
+                retval = FALSE;
+        }
+
+        last.from = last.to = 0;
+        if (!gibbon_match_add_action (match, GIBBON_POSITION_SIDE_BLACK,
+                                      GIBBON_GAME_ACTION (gibbon_roll_new (4,
+                                                                           2)),
+                                      G_MININT64, &error)) {
+                g_printerr ("Cannot add roll: %s\n", error->message);
+                g_error_free (error);
+                g_object_unref (match);
+                return FALSE;
+        }
+        if (last.from != 3 || last.to != 4) {
+                g_printerr ("Expected notification for position 3,"
+                            " got %u to %u.\n",
+                            (guint) last.from, (guint) last.to);
+                retval = FALSE;
+        }
+
+        g_object_unref (match);
+
+        return retval;
+}
@@ -0,0 +1,169 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <sqlite3.h>
+
+#include "gibbon-database.h"
+#include "gibbon-match-statistics.h"
+
+#define SELECT_STATISTICS                                               \
+        "SELECT error_EMG1, error_EMG2, error_MWC1, error_MWC2,"        \
+        "       error_FIBS1, error_FIBS2,"                              \
+        "       checker_error_EMG1, checker_error_EMG2,"                \
+        "       checker_error_MWC1, checker_error_MWC2,"                \
+        "       cube_error_EMG1, cube_error_EMG2,"                      \
+        "       cube_error_MWC1, cube_error_MWC2,"                      \
+        "       luck_EMG1, luck_EMG2, luck_MWC1, luck_MWC2"             \
+        "  FROM matches WHERE date_time = ?"
+
+static gboolean check_statistics (const gchar *path, guint64 date_time,
+                                  gboolean known);
+
+int
+main (int argc, char *argv[])
+{
+        gchar *path;
+        GibbonDatabase *db;
+        GibbonMatchStatistics stats;
+        GError *error = NULL;
+        int status = 0;
+
+        g_type_init ();
+
+        path = g_build_filename (g_get_tmp_dir (), "test-database.sqlite",
+                                 NULL);
+        (void) g_unlink (path);
+
+        db = gibbon_database_new (path, &error);
+        if (!db) {
+                g_printerr ("Cannot create database `%s': %s\n",
+                            path, error->message);
+                g_free (path);
+                return 1;
+        }
+
+        /* A match without analysis.  */
+        gibbon_match_statistics_init (&stats, 5);
+        if (!gibbon_database_save_match (db, "localhost", 4321,
+                                         "white", "black", 5, 5, 3,
+                                         1000000, &stats, &error)) {
+                g_printerr ("Cannot save match: %s\n", error->message);
+                g_clear_error (&error);
+                status = 1;
+        } else if (!check_statistics (path, 1000000, FALSE)) {
+                status = 1;
+        }
+
+        /*
+         * An analysed match must keep its statistics when it is saved again
+         * without analysis.
+         */
+        stats.rolls[0] = stats.rolls[1] = 1;
+        stats.luck_emg[0] = 0.25;
+        stats.luck_emg[1] = -0.25;
+        if (!gibbon_database_save_match (db, "localhost", 4321,
+                                         "white", "black", 5, 3, 5,
+                                         2000000, &stats, &error)) {
+                g_printerr ("Cannot save match: %s\n", error->message);
+                g_clear_error (&error);
+                status = 1;
+        } else {
+                gibbon_match_statistics_init (&stats, 5);
+                if (!gibbon_database_save_match (db, "localhost", 4321,
+                                                 "white", "black", 5, 3, 5,
+                                                 2000000, &stats, &error)) {
+                        g_printerr ("Cannot save match: %s\n",
+                                    error->message);
+                        g_clear_error (&error);
+                        status = 1;
+                } else if (!check_statistics (path, 2000000, TRUE)) {
+                        status = 1;
+                }
+        }
+
+        g_object_unref (db);
+        (void) g_unlink (path);
+        g_free (path);
+
+        return status;
+}
+
+static gboolean
+check_statistics (const gchar *path, guint64 date_time, gboolean known)
+{
+        sqlite3 *dbh;
+        sqlite3_stmt *stmt;
+        gboolean retval = TRUE;
+        int i;
+
+        if (SQLITE_OK != sqlite3_open (path, &dbh)) {
+                g_printerr ("Cannot open `%s': %s\n", path,
+                            sqlite3_errmsg (dbh));
+                sqlite3_close (dbh);
+                return FALSE;
+        }
+
+        if (SQLITE_OK != sqlite3_prepare_v2 (dbh, SELECT_STATISTICS, -1,
+                                             &stmt, NULL)) {
+                g_printerr ("Cannot prepare statement: %s\n",
+                            sqlite3_errmsg (dbh));
+                sqlite3_close (dbh);
+                return FALSE;
+        }
+
+        sqlite3_bind_int64 (stmt, 1, date_time);
+        if (SQLITE_ROW != sqlite3_step (stmt)) {
+                g_printerr ("Match at %llu was not saved.\n",
+                            (unsigned long long) date_time);
+                sqlite3_finalize (stmt);
+                sqlite3_close (dbh);
+                return FALSE;
+        }
+
+        if (known) {
+                if (sqlite3_column_type (stmt, 14) == SQLITE_NULL
+                    || sqlite3_column_double (stmt, 14) != 0.25) {
+                        g_printerr ("Match at %llu: luck_EMG1 was"
+                                    " overwritten.\n",
+                                    (unsigned long long) date_time);
+                        retval = FALSE;
+                }
+        } else {
+                for (i = 0; i < sqlite3_column_count (stmt); ++i) {
+                        if (sqlite3_column_type (stmt, i) != SQLITE_NULL) {
+                                g_printerr ("Match at %llu: %s is not"
+                                            " NULL.\n",
+                                            (unsigned long long) date_time,
+                                            sqlite3_column_name (stmt, i));
+                                retval = FALSE;
+                        }
+                }
+        }
+
+        sqlite3_finalize (stmt);
+        sqlite3_close (dbh);
+
+        return retval;
+}
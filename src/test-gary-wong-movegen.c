@@ -246,10 +246,18 @@ static void compare_results (GibbonPosition *position,
                              GibbonPositionSide side);
 static void dump_position (const GibbonPosition *position);
 static void dump_move (const GibbonMove *move);
+static void compare_legal_moves (const GibbonPosition *position,
+                                 const GibbonPosition *post_position,
+                                 gint success, GibbonPositionSide turn);
 static void translate_position (gint board[28], const GibbonPosition *position,
                                 GibbonPositionSide turn);
 static void test_game (void);
 static void test_roll (GibbonPosition *position);
+static void run_perft (guint plies, gboolean verbose);
+static void perft (const GibbonPosition *position, GibbonPositionSide side,
+                   guint plies);
+static void translate_board (GibbonPosition *position, gint board[28],
+                             GibbonPositionSide turn);
 static void move_checker (GibbonPosition *position, gint board[28],
                           guint die, GibbonPositionSide side);
 static void find_any_move (const GibbonPosition *position, gint board[28],
@@ -273,14 +281,45 @@ static void print_movement (gint board[28], gint from, gint die,
 static unsigned long long total_positions = 100000;
 static unsigned long long done_positions = 0;
 
+static GibbonLegalMove legal_moves[GIBBON_POSITION_MAX_LEGAL_MOVES];
+
+/*
+ * Usage: test-gary-wong-movegen [POSITIONS [SEED]]
+ *        test-gary-wong-movegen perft PLIES
+ *
+ * The first form plays random games and cross-checks POSITIONS moves
+ * against Gary Wong's code.  The second form enumerates all legal moves
+ * for all 21 rolls of all positions reachable from the opening within
+ * PLIES plies, and cross-checks every single one.  It reports the number
+ * of positions per second and serves as a benchmark for the move code.
+ */
 int
 main (int argc, char *argv[])
 {
         long long random_seed = time (NULL);
         gboolean verbose = FALSE;
+        guint plies;
 
         g_type_init ();
 
+        /* Gary Wong's code must check the move code, not the cache.  */
+        gibbon_position_set_legality_cache_size (0);
+
+        if (argc > 1 && !strcmp (argv[1], "perft")) {
+                errno = 0;
+                plies = argc > 2 ? g_ascii_strtoull (argv[2], NULL, 10) : 2;
+                if (errno) {
+                        g_printerr ("Invalid number of plies `%s': %s!\n",
+                                    argv[2], strerror (errno));
+                        return -1;
+                }
+                run_perft (plies, TRUE);
+                return 0;
+        }
+
+        /* A shallow perft is cheap enough for every run.  */
+        run_perft (1, FALSE);
+
         if (argc > 1) {
                 errno = 0;
                 total_positions = g_ascii_strtoull (argv[1], NULL, 10);
@@ -418,6 +457,7 @@ test_roll (GibbonPosition *position)
                 legal = LegalMove (board, post_board, (int *) dice, moves);
                 compare_results (position, post_position, move,
                                  legal, moves, turn);
+                compare_legal_moves (position, post_position, legal, turn);
                 g_object_unref (move);
                 if (legal) {
 #if (DEBUG_TEST_ENGINE)
@@ -437,6 +477,110 @@ test_roll (GibbonPosition *position)
         return;
 }
 
+static void
+run_perft (guint plies, gboolean verbose)
+{
+        GibbonPosition *position = gibbon_position_new ();
+        GTimer *timer;
+        gdouble elapsed;
+
+        if (verbose)
+                g_print ("Enumerating all moves for %u plies.\n", plies);
+
+        done_positions = total_positions = 0;
+
+        timer = g_timer_new ();
+        perft (position, GIBBON_POSITION_SIDE_WHITE, plies);
+        perft (position, GIBBON_POSITION_SIDE_BLACK, plies);
+        elapsed = g_timer_elapsed (timer, NULL);
+        g_timer_destroy (timer);
+
+        gibbon_position_free (position);
+
+        if (verbose) {
+                g_print ("%llu positions in %f s", done_positions, elapsed);
+                if (elapsed > 0)
+                        g_print (" (%.0f positions/s)",
+                                 done_positions / elapsed);
+                g_print (".\n");
+        }
+
+        /* Reset the counters for the random games.  */
+        done_positions = 0;
+        total_positions = 100000;
+}
+
+/*
+ * Check every legal move of all 21 rolls in @position, and recurse into
+ * the resulting positions.  Gary Wong's code has to accept every move
+ * that the generator finds, and gibbon_position_check_move() has to agree
+ * with it.  The other direction is covered by compare_legal_moves() in
+ * the random games.
+ */
+static void
+perft (const GibbonPosition *position, GibbonPositionSide side, guint plies)
+{
+        GibbonLegalMove *moves;
+        GibbonPosition *pre, *post;
+        GibbonMove *move;
+        gint board[28], post_board[28];
+        gint wong_moves[8];
+        gint roll[2];
+        gsize num_moves, i, j;
+        guint die1, die2;
+        int legal;
+
+        if (!plies || gibbon_position_game_over (position))
+                return;
+
+        /* The recursion is too deep for using the static array.  */
+        moves = g_new (GibbonLegalMove, GIBBON_POSITION_MAX_LEGAL_MOVES);
+        pre = gibbon_position_copy (position);
+        post = gibbon_position_copy (position);
+        pre->turn = side;
+
+        for (die1 = 1; die1 <= 6; ++die1) {
+                for (die2 = die1; die2 <= 6; ++die2) {
+                        pre->dice[0] = roll[0] = die1;
+                        pre->dice[1] = roll[1] = die2;
+                        translate_position (board, pre, side);
+                        num_moves = gibbon_position_legal_moves (
+                                pre, side, die1, die2,
+                                moves, GIBBON_POSITION_MAX_LEGAL_MOVES);
+                        for (i = 0; i < num_moves; ++i) {
+                                ++done_positions;
+                                for (j = 0; j < 26; ++j)
+                                        post_board[j] = moves[i].board[j];
+                                translate_board (post, post_board, side);
+                                translate_position (post_board, post, side);
+
+                                move = gibbon_position_check_move (pre, post,
+                                                                   side);
+                                legal = LegalMove (board, post_board, roll,
+                                                   wong_moves);
+                                if (!legal) {
+                                        g_printerr ("Gary Wong rejects"
+                                                    " generated move after"
+                                                    " %llu positions:\n",
+                                                    done_positions);
+                                        dump_position (pre);
+                                        dump_position (post);
+                                        exit (1);
+                                }
+                                compare_results (pre, post, move, legal,
+                                                 wong_moves, side);
+                                g_object_unref (move);
+
+                                perft (post, -side, plies - 1);
+                        }
+                }
+        }
+
+        gibbon_position_free (post);
+        gibbon_position_free (pre);
+        g_free (moves);
+}
+
 /* This function moves a checker more or less randomly.
  *
  * However, the checkers are not moved completely randomly.  If there is
@@ -665,6 +809,48 @@ compare_results (GibbonPosition *position,
         exit (1);
 }
 
+static void
+compare_legal_moves (const GibbonPosition *position,
+                     const GibbonPosition *post_position,
+                     gint success, GibbonPositionSide turn)
+{
+        gint after[26];
+        gsize num_moves, i, j;
+        gboolean found = FALSE;
+
+        num_moves = gibbon_position_legal_moves (position, turn,
+                                                 position->dice[0],
+                                                 position->dice[1],
+                                                 legal_moves,
+                                                 G_N_ELEMENTS (legal_moves));
+        gibbon_position_get_board (post_position, turn, after);
+
+        for (i = 0; !found && i < num_moves; ++i) {
+                for (j = 0; j < 26; ++j)
+                        if (legal_moves[i].board[j] != after[j])
+                                break;
+                if (j == 26)
+                        found = TRUE;
+        }
+
+        if (found == !!success)
+                return;
+
+        g_printerr ("Move generator differs after %llu/%llu positions:\n",
+                    done_positions, total_positions);
+        g_printerr ("Gary Wong: %s, generator: %s (%llu moves)\n",
+                    success ? "legal" : "illegal",
+                    found ? "legal" : "illegal",
+                    (unsigned long long) num_moves);
+
+        g_printerr ("Starting position:\n");
+        dump_position (position);
+        g_printerr ("End position:\n");
+        dump_position (post_position);
+
+        exit (1);
+}
+
 static void
 translate_position (gint board[28], const GibbonPosition *position,
                     GibbonPositionSide turn)
@@ -21,11 +21,21 @@
 # include <config.h>
 #endif
 
+#include <string.h>
+
 #include <glib-object.h>
+#include <glib/gstdio.h>
 
 #include "gibbon-gmd-reader.h"
 #include "gibbon-gmd-writer.h"
 
+static void benchmark (GibbonMatchReader *reader, const gchar *input_file,
+                       guint64 copies);
+
+/*
+ * Run "test-gmd-reader COPIES" in order to compare reading a mapped file
+ * with reading through a file stream.
+ */
 int
 main (int argc, char *argv[])
 {
@@ -74,6 +84,9 @@ main (int argc, char *argv[])
                 return -1;
         }
 
+        if (argc > 1)
+                benchmark (reader, input_file,
+                           g_ascii_strtoull (argv[1], NULL, 10));
 
         g_free (wanted);
         g_free (input_file);
@@ -84,3 +97,92 @@ main (int argc, char *argv[])
         return status;
 }
 
+
+/*
+ * The synthetic archive is a money session with all games of the input
+ * file repeated @copies times.
+ */
+static void
+benchmark (GibbonMatchReader *reader, const gchar *input_file, guint64 copies)
+{
+        gchar *contents;
+        gchar *games;
+        gchar **lines;
+        GString *archive;
+        gchar *path;
+        GFile *file;
+        GInputStream *stream;
+        GibbonMatch *match;
+        GTimer *timer;
+        gdouble mapped, streamed;
+        gsize i;
+        guint64 n;
+        GError *error = NULL;
+
+        if (!g_file_get_contents (input_file, &contents, NULL, &error)) {
+                g_printerr ("Error reading `%s': %s\n",
+                            input_file, error->message);
+                return;
+        }
+
+        games = strstr (contents, "\nGame:");
+        if (!games) {
+                g_printerr ("%s: no games found.\n", input_file);
+                g_free (contents);
+                return;
+        }
+        *games++ = 0;
+
+        /* Without a length, the games are read as a money session.  */
+        archive = g_string_new (NULL);
+        lines = g_strsplit (contents, "\n", -1);
+        for (i = 0; lines[i]; ++i) {
+                if (!g_str_has_prefix (lines[i], "Length:"))
+                        g_string_append_printf (archive, "%s\n", lines[i]);
+        }
+        g_strfreev (lines);
+        for (n = 0; n < copies; ++n)
+                g_string_append (archive, games);
+        g_free (contents);
+
+        path = g_build_filename (g_get_tmp_dir (), "test-gmd-reader.gmd",
+                                 NULL);
+        if (!g_file_set_contents (path, archive->str, archive->len,
+                                  &error)) {
+                g_printerr ("Error creating `%s': %s\n", path,
+                            error->message);
+                g_free (path);
+                g_string_free (archive, TRUE);
+                return;
+        }
+
+        timer = g_timer_new ();
+        match = gibbon_match_reader_parse (reader, path);
+        mapped = g_timer_elapsed (timer, NULL);
+        if (!match)
+                g_printerr ("Error parsing mapped archive.\n");
+        else
+                g_object_unref (match);
+
+        g_timer_start (timer);
+        file = g_file_new_for_path (path);
+        stream = G_INPUT_STREAM (g_file_read (file, NULL, &error));
+        match = stream ? gibbon_match_reader_parse_stream (reader, stream, path)
+                : NULL;
+        streamed = g_timer_elapsed (timer, NULL);
+        if (!match)
+                g_printerr ("Error parsing streamed archive.\n");
+        else
+                g_object_unref (match);
+        if (stream)
+                g_object_unref (stream);
+        g_object_unref (file);
+        g_timer_destroy (timer);
+
+        g_print ("%" G_GSIZE_FORMAT " bytes: %f s mapped, %f s streamed.\n",
+                 archive->len, mapped, streamed);
+
+        g_unlink (path);
+        g_free (path);
+        g_string_free (archive, TRUE);
+}
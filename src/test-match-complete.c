@@ -30,8 +30,12 @@
 #include "gibbon-gmd-reader.h"
 #include "gibbon-gmd-writer.h"
 #include "gibbon-match.h"
+#include "gibbon-match-priv.h"
 #include "gibbon-match-play.h"
 
+static gboolean test_guards (const GibbonMatch *from,
+                             const GibbonPosition *target);
+
 int
 main(int argc, char *argv[])
 {
@@ -39,7 +43,10 @@ main(int argc, char *argv[])
         GibbonMatch *from, *to;
         const GibbonPosition *current_pos;
         const GibbonPosition *target_pos;
-        guint64 replay = 0;
+        guint64 iterations = 0, n;
+        guint64 searches, steps;
+        guint max_depth;
+        gdouble seconds;
         GSList *iter;
         GibbonMatchPlay *play;
         GibbonGameAction *action;
@@ -51,7 +58,7 @@ main(int argc, char *argv[])
         g_type_init ();
 
         if (argc < 3 || argc > 4) {
-                g_printerr ("Usage: %s FROM TO [SKIP]\n", argv[0]);
+                g_printerr ("Usage: %s FROM TO [ITERATIONS]\n", argv[0]);
                 return -1;
         }
 
@@ -78,10 +85,30 @@ main(int argc, char *argv[])
         g_object_unref (reader);
 
         if (argc == 4)
-                replay = g_ascii_strtoull (argv[3], NULL, 10);
+                iterations = g_ascii_strtoull (argv[3], NULL, 10);
 
         target_pos = gibbon_match_get_current_position (to);
 
+        /* Benchmark mode.  */
+        if (iterations) {
+                gibbon_match_reset_missing_actions_stats ();
+                for (n = 0; n < iterations; ++n) {
+                        if (!gibbon_match_get_missing_actions (from, target_pos,
+                                                               &iter))
+                                break;
+                        g_slist_free_full (iter, (GDestroyNotify)
+                                           gibbon_match_play_free);
+                }
+                gibbon_match_get_missing_actions_stats (&searches, NULL,
+                                                        &steps, &max_depth,
+                                                        &seconds);
+                g_print ("%llu searches, %.1f steps on average, at most %u"
+                         " steps, %f s per search.\n",
+                         (unsigned long long) searches,
+                         searches ? (gdouble) steps / searches : 0.0,
+                         max_depth, searches ? seconds / searches : 0.0);
+        }
+
         if (!gibbon_match_get_missing_actions (from, target_pos, &iter)) {
                 g_printerr ("Cannot deduce actions leading from `%s' to"
                             " `%s'!\n", argv[1], argv[2]);
@@ -90,6 +117,15 @@ main(int argc, char *argv[])
                 return -1;
         }
 
+        if (!test_guards (from, target_pos)) {
+                g_printerr ("Completing `%s' to `%s'.\n", argv[1], argv[2]);
+                g_slist_free_full (iter, (GDestroyNotify)
+                                   gibbon_match_play_free);
+                g_object_unref (from);
+                g_object_unref (to);
+                return -1;
+        }
+
         while (iter) {
                 play = (GibbonMatchPlay *) iter->data;
                 action = play->action;
@@ -149,3 +185,59 @@ main(int argc, char *argv[])
 
         return 0;
 }
+
+/*
+ * The search must give up, when it gets one step less than it needs, and
+ * it must refuse to visit a state twice.
+ */
+static gboolean
+test_guards (const GibbonMatch *from, const GibbonPosition *target)
+{
+        guint64 searches, failures;
+        guint max_depth, depth;
+        GSList *iter = NULL;
+
+        gibbon_match_reset_missing_actions_stats ();
+        if (!gibbon_match_get_missing_actions (from, target, &iter))
+                return FALSE;
+        g_slist_free_full (iter, (GDestroyNotify) gibbon_match_play_free);
+        gibbon_match_get_missing_actions_stats (NULL, NULL, NULL, &depth,
+                                                NULL);
+
+        if (depth) {
+                gibbon_match_reset_missing_actions_stats ();
+                iter = NULL;
+                if (_gibbon_match_get_missing_actions_bounded (from, target,
+                                                               &iter,
+                                                               depth - 1)) {
+                        g_printerr ("Search succeeded with %u instead of"
+                                    " %u steps.\n", depth - 1, depth);
+                        g_slist_free_full (iter, (GDestroyNotify)
+                                           gibbon_match_play_free);
+                        return FALSE;
+                }
+                if (iter) {
+                        g_printerr ("Failed search returned actions.\n");
+                        return FALSE;
+                }
+                gibbon_match_get_missing_actions_stats (&searches, &failures,
+                                                        NULL, &max_depth,
+                                                        NULL);
+                if (searches != 1 || failures != 1 || max_depth != depth - 1) {
+                        g_printerr ("Bounded search: %llu searches, %llu"
+                                    " failures, %u steps, expected 1, 1,"
+                                    " %u.\n",
+                                    (unsigned long long) searches,
+                                    (unsigned long long) failures,
+                                    max_depth, depth - 1);
+                        return FALSE;
+                }
+        }
+
+        if (!_gibbon_match_guess_detects_loop (target)) {
+                g_printerr ("Loop detection failed.\n");
+                return FALSE;
+        }
+
+        return TRUE;
+}
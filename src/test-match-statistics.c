@@ -0,0 +1,215 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet 
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify 
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <math.h>
+
+#include <glib.h>
+
+#include "gibbon-match.h"
+#include "gibbon-game.h"
+#include "gibbon-game-actions.h"
+#include "gibbon-analysis-roll.h"
+#include "gibbon-analysis-move.h"
+#include "gibbon-match-statistics.h"
+
+static gboolean add_action (GibbonGame *game, GibbonPositionSide side,
+                            GibbonGameAction *action,
+                            GibbonAnalysis *analysis);
+static GibbonAnalysis *cube_analysis (gdouble eq_nodouble, gdouble eq_take,
+                                      gboolean take_analysis);
+static gboolean check_value (const gchar *what, gdouble got, gdouble wanted);
+static gboolean test_match_play (void);
+
+int
+main (int argc, char *argv[])
+{
+        GibbonMatch *match;
+        GibbonGame *game;
+        GError *error = NULL;
+        const GibbonMatchStatistics *stats;
+        int status = 0;
+
+        g_type_init ();
+
+        match = gibbon_match_new (NULL, NULL, 0, FALSE);
+        game = gibbon_match_add_game (match, &error);
+        if (!game) {
+                g_printerr ("Cannot add game: %s\n", error->message);
+                return 1;
+        }
+
+        if (!add_action (game, GIBBON_POSITION_SIDE_WHITE,
+                         GIBBON_GAME_ACTION (gibbon_roll_new (2, 1)),
+                         GIBBON_ANALYSIS (gibbon_analysis_roll_new (
+                                 GIBBON_ANALYSIS_ROLL_LUCK_LUCKY, 0.25))))
+                return 1;
+
+        /* White should have doubled.  */
+        if (!add_action (game, GIBBON_POSITION_SIDE_WHITE,
+                         GIBBON_GAME_ACTION (gibbon_move_newv (2, 1, 13, 11,
+                                                               24, 23, -1)),
+                         cube_analysis (0.5, 0.8, FALSE)))
+                return 1;
+
+        /* Black should not have doubled.  */
+        if (!add_action (game, GIBBON_POSITION_SIDE_BLACK,
+                         GIBBON_GAME_ACTION (gibbon_double_new ()),
+                         cube_analysis (0.2, 0.1, FALSE)))
+                return 1;
+
+        /* White should have taken.  */
+        if (!add_action (game, GIBBON_POSITION_SIDE_WHITE,
+                         GIBBON_GAME_ACTION (gibbon_drop_new ()),
+                         cube_analysis (0.2, 0.1, TRUE)))
+                return 1;
+
+        stats = gibbon_match_get_statistics (match);
+
+        if (stats->rolls[0] != 1 || stats->rolls[1] != 0) {
+                g_printerr ("Expected 1/0 rolls, got %llu/%llu.\n",
+                            (unsigned long long) stats->rolls[0],
+                            (unsigned long long) stats->rolls[1]);
+                status = 1;
+        }
+        if (stats->cube_decisions[0] != 2 || stats->cube_decisions[1] != 1) {
+                g_printerr ("Expected 2/1 cube decisions, got %llu/%llu.\n",
+                            (unsigned long long) stats->cube_decisions[0],
+                            (unsigned long long) stats->cube_decisions[1]);
+                status = 1;
+        }
+        if (!check_value ("luck white", stats->luck_emg[0], 0.25))
+                status = 1;
+        if (!check_value ("cube error white", stats->cube_error_emg[0], 1.2))
+                status = 1;
+        if (!check_value ("cube error black", stats->cube_error_emg[1], 0.1))
+                status = 1;
+        if (!check_value ("error rate white",
+                          gibbon_match_statistics_get_error_rate (
+                                  stats, GIBBON_POSITION_SIDE_WHITE),
+                          600.0))
+                status = 1;
+        if (!check_value ("money MWC", stats->cube_error_mwc[0], 0.0))
+                status = 1;
+
+        g_object_unref (match);
+
+        if (!test_match_play ())
+                status = 1;
+
+        return status;
+}
+
+/* Luck in match winning chances is the difference to a neutral roll.  */
+static gboolean
+test_match_play (void)
+{
+        GibbonMatch *match;
+        GibbonGame *game;
+        GError *error = NULL;
+        const GibbonMatchStatistics *stats;
+        gboolean retval = TRUE;
+
+        match = gibbon_match_new (NULL, NULL, 5, TRUE);
+        game = gibbon_match_add_game (match, &error);
+        if (!game) {
+                g_printerr ("Cannot add game: %s\n", error->message);
+                return FALSE;
+        }
+
+        if (!add_action (game, GIBBON_POSITION_SIDE_WHITE,
+                         GIBBON_GAME_ACTION (gibbon_roll_new (2, 1)),
+                         GIBBON_ANALYSIS (gibbon_analysis_roll_new (
+                                 GIBBON_ANALYSIS_ROLL_LUCK_NONE, 0.0))))
+                return FALSE;
+
+        if (!add_action (game, GIBBON_POSITION_SIDE_WHITE,
+                         GIBBON_GAME_ACTION (gibbon_move_newv (2, 1, 13, 11,
+                                                               24, 23, -1)),
+                         NULL))
+                return FALSE;
+
+        if (!add_action (game, GIBBON_POSITION_SIDE_BLACK,
+                         GIBBON_GAME_ACTION (gibbon_roll_new (3, 1)),
+                         GIBBON_ANALYSIS (gibbon_analysis_roll_new (
+                                 GIBBON_ANALYSIS_ROLL_LUCK_LUCKY, 0.25))))
+                return FALSE;
+
+        stats = gibbon_match_get_statistics (match);
+
+        if (!check_value ("match luck white", stats->luck_mwc[0], 0.0))
+                retval = FALSE;
+
+        /* At most half of the equity is gained in match winning chances.  */
+        if (stats->luck_mwc[1] <= 0.0 || stats->luck_mwc[1] >= 0.125) {
+                g_printerr ("match luck black: expected between 0 and 0.125,"
+                            " got %f.\n", stats->luck_mwc[1]);
+                retval = FALSE;
+        }
+
+        g_object_unref (match);
+
+        return retval;
+}
+
+static gboolean
+add_action (GibbonGame *game, GibbonPositionSide side,
+            GibbonGameAction *action, GibbonAnalysis *analysis)
+{
+        GError *error = NULL;
+
+        if (!gibbon_game_add_action_with_analysis (game, side, action,
+                                                   analysis, G_MININT64,
+                                                   &error)) {
+                g_printerr ("Cannot add %s: %s\n",
+                            G_OBJECT_TYPE_NAME (action), error->message);
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+static GibbonAnalysis *
+cube_analysis (gdouble eq_nodouble, gdouble eq_take, gboolean take_analysis)
+{
+        GibbonAnalysisMove *a = gibbon_analysis_move_new ();
+
+        a->may_double = TRUE;
+        a->opp_may_double = TRUE;
+        a->da = TRUE;
+        a->da_take_analysis = take_analysis;
+        a->da_p[0][GIBBON_ANALYSIS_MOVE_CUBEFUL_EQUITY] = eq_nodouble;
+        a->da_p[1][GIBBON_ANALYSIS_MOVE_CUBEFUL_EQUITY] = eq_take;
+
+        return GIBBON_ANALYSIS (a);
+}
+
+static gboolean
+check_value (const gchar *what, gdouble got, gdouble wanted)
+{
+        if (fabs (got - wanted) < 1e-9)
+                return TRUE;
+
+        g_printerr ("%s: expected %f, got %f.\n", what, wanted, got);
+
+        return FALSE;
+}
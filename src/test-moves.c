@@ -21,6 +21,7 @@
 # include <config.h>
 #endif
 
+#include <stdlib.h>
 #include <string.h>
 
 #include <glib.h>
@@ -43,40 +44,127 @@ static gboolean test_try_swap_bug2 (void);
 static gboolean test_try_swap_bug3 (void);
 static gboolean test_ordered_bear_off (void);
 static gboolean test_bear_off_bug1 (void);
+static gboolean run_tests (void);
+static gboolean test_legality_cache (void);
 
+/*
+ * Run "test-moves ITERATIONS" in order to benchmark
+ * gibbon_position_check_move() with the test inputs.
+ */
 int
 main(int argc, char *argv[])
 {
 	int status = 0;
+        gulong iterations = 1;
+        gulong i;
+        GTimer *timer;
+        gdouble elapsed;
 
         g_type_init ();
 
-        if (!test_too_many_moves ())
+        if (argc > 1)
+                iterations = strtoul (argv[1], NULL, 10);
+
+        /* Test and time the real thing.  */
+        gibbon_position_set_legality_cache_size (0);
+
+        timer = g_timer_new ();
+        for (i = 0; i < iterations; ++i) {
+                if (!run_tests ())
+                        status = -1;
+        }
+        elapsed = g_timer_elapsed (timer, NULL);
+        g_timer_destroy (timer);
+
+        if (argc > 1 && iterations)
+                g_print ("%lu iterations in %f s (%f us per iteration).\n",
+                         iterations, elapsed, 1000000 * elapsed / iterations);
+
+        if (!test_legality_cache ())
                 status = -1;
+
+        return status;
+}
+
+static gboolean
+test_legality_cache (void)
+{
+        gboolean retval = TRUE;
+        guint64 hits, misses;
+        gsize entries;
+
+        gibbon_position_set_legality_cache_size (
+                GIBBON_POSITION_LEGALITY_CACHE_SIZE);
+        gibbon_position_reset_legality_cache_stats ();
+
+        /* The second run must be served from the cache, with the same
+         * results.
+         */
+        if (!run_tests ())
+                retval = FALSE;
+        gibbon_position_get_legality_cache_stats (&hits, &misses, &entries);
+        if (!misses || misses != entries) {
+                g_printerr ("Expected %llu cache entries, got %llu.\n",
+                            (unsigned long long) misses,
+                            (unsigned long long) entries);
+                retval = FALSE;
+        }
+        if (!run_tests ())
+                retval = FALSE;
+        gibbon_position_get_legality_cache_stats (&hits, NULL, NULL);
+        if (hits < misses) {
+                g_printerr ("Expected at least %llu cache hits, got %llu.\n",
+                            (unsigned long long) misses,
+                            (unsigned long long) hits);
+                retval = FALSE;
+        }
+
+        gibbon_position_set_legality_cache_size (2);
+        if (!run_tests ())
+                retval = FALSE;
+        gibbon_position_get_legality_cache_stats (NULL, NULL, &entries);
+        if (entries > 2) {
+                g_printerr ("Cache limited to 2 entries has %llu.\n",
+                            (unsigned long long) entries);
+                retval = FALSE;
+        }
+
+        gibbon_position_set_legality_cache_size (0);
+
+        return retval;
+}
+
+static gboolean
+run_tests (void)
+{
+        gboolean status = TRUE;
+
+        if (!test_too_many_moves ())
+                status = FALSE;
         if (!test_use_all ())
-                status = -1;
+                status = FALSE;
         if (!test_try_swap1 ())
-                status = -1;
+                status = FALSE;
         if (!test_try_swap2 ())
-                status = -1;
+                status = FALSE;
         if (!test_try_dance ())
-                status = -1;
+                status = FALSE;
         if (!test_illegal_waste ())
-                status = -1;
+                status = FALSE;
         if (!test_use_higher ())
-                status = -1;
+                status = FALSE;
         if (!test_not_use_higher ())
-                status = -1;
+                status = FALSE;
         if (!test_try_swap_bug1 ())
-                status = -1;
+                status = FALSE;
         if (!test_try_swap_bug2 ())
-                status = -1;
+                status = FALSE;
         if (!test_try_swap_bug3 ())
-                status = -1;
+                status = FALSE;
         if (!test_ordered_bear_off ())
-                status = -1;
+                status = FALSE;
         if (!test_bear_off_bug1 ())
-                status = -1;
+                status = FALSE;
 
         return status;
 }
@@ -0,0 +1,225 @@
+/*
+ * This file is part of Gibbon, a graphical frontend to the First Internet
+ * Backgammon Server FIBS.
+ * Copyright (C) 2009-2012 Guido Flohr, http://guido-flohr.net/.
+ *
+ * Gibbon is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Gibbon is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Gibbon.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <gibbon-position.h>
+#include <gibbon-position-kernels.h>
+
+#define NUM_BOARDS 1024
+
+static gint8 boards[NUM_BOARDS][26];
+
+static void random_board (gint8 board[26], gint range);
+static gboolean test_initial (void);
+static gboolean test_random (void);
+static void benchmark (gulong iterations);
+
+/*
+ * Run "test-position-kernels ITERATIONS" in order to compare the speed
+ * of the vectorized kernels with the scalar code.
+ */
+int
+main (int argc, char *argv[])
+{
+        int status = 0;
+        gsize i;
+
+        g_type_init ();
+
+        /* Mostly realistic checker counts, but also extreme values.  */
+        for (i = 0; i < NUM_BOARDS; ++i)
+                random_board (boards[i], i % 8 ? 15 : 127);
+
+        if (!test_initial ())
+                status = -1;
+        if (!test_random ())
+                status = -1;
+
+        if (argc > 1)
+                benchmark (strtoul (argv[1], NULL, 10));
+
+        return status;
+}
+
+static void
+random_board (gint8 board[26], gint range)
+{
+        gint i;
+
+        for (i = 0; i < 26; ++i) {
+                board[i] = g_random_int_range (-range, range + 1);
+                /* Many points are empty.  */
+                if (g_random_boolean ())
+                        board[i] = 0;
+        }
+}
+
+static gboolean
+test_initial (void)
+{
+        gboolean retval = TRUE;
+        const GibbonPosition *initial = gibbon_position_initial ();
+        gint board[26];
+        gint8 packed[26];
+        gint i;
+
+        gibbon_position_get_board (initial, GIBBON_POSITION_SIDE_WHITE,
+                                   board);
+        for (i = 0; i < 26; ++i)
+                packed[i] = board[i];
+
+        if (gibbon_position_kernel_pips (packed) != 167) {
+                g_printerr ("Expected 167 pips for the initial position,"
+                            " got %u.\n", gibbon_position_kernel_pips (packed));
+                retval = FALSE;
+        }
+        if (gibbon_position_kernel_checkers (packed) != 15) {
+                g_printerr ("Expected 15 checkers for the initial position,"
+                            " got %u.\n",
+                            gibbon_position_kernel_checkers (packed));
+                retval = FALSE;
+        }
+        if (gibbon_position_kernel_differ (packed, packed)) {
+                g_printerr ("Initial position differs from itself.\n");
+                retval = FALSE;
+        }
+
+        /* The opponent's checkers on the bar do not count.  */
+        packed[0] = 3;
+        if (gibbon_position_kernel_checkers (packed) != 15) {
+                g_printerr ("Opponent's checkers on the bar were counted.\n");
+                retval = FALSE;
+        }
+
+        packed[25] = 1;
+        if (gibbon_position_kernel_pips (packed) != 192) {
+                g_printerr ("Expected 192 pips with a checker on the bar,"
+                            " got %u.\n", gibbon_position_kernel_pips (packed));
+                retval = FALSE;
+        }
+
+        return retval;
+}
+
+static gboolean
+test_random (void)
+{
+        gboolean retval = TRUE;
+        const gint8 *a, *b;
+        gint8 c[26];
+        gsize i;
+        gint j;
+
+        for (i = 0; i < NUM_BOARDS; ++i) {
+                a = boards[i];
+                b = boards[(i + 1) % NUM_BOARDS];
+
+                /* Make the second board similar to the first one.  */
+                memcpy (c, a, sizeof c);
+                j = g_random_int_range (0, 26);
+                c[j] = b[j];
+
+                if (gibbon_position_kernel_pips (a)
+                    != gibbon_position_kernel_pips_scalar (a)) {
+                        g_printerr ("Pip count differs for board #%u:"
+                                    " %u != %u.\n", (guint) i,
+                                    gibbon_position_kernel_pips (a),
+                                    gibbon_position_kernel_pips_scalar (a));
+                        retval = FALSE;
+                }
+                if (gibbon_position_kernel_checkers (a)
+                    != gibbon_position_kernel_checkers_scalar (a)) {
+                        g_printerr ("Checker count differs for board #%u:"
+                                    " %u != %u.\n", (guint) i,
+                                    gibbon_position_kernel_checkers (a),
+                                    gibbon_position_kernel_checkers_scalar (a));
+                        retval = FALSE;
+                }
+                if (gibbon_position_kernel_differ (a, b)
+                    != gibbon_position_kernel_differ_scalar (a, b)
+                    || gibbon_position_kernel_differ (a, c)
+                    != gibbon_position_kernel_differ_scalar (a, c)) {
+                        g_printerr ("Difference differs for board #%u.\n",
+                                    (guint) i);
+                        retval = FALSE;
+                }
+                if (gibbon_position_kernel_decreased (a, b)
+                    != gibbon_position_kernel_decreased_scalar (a, b)
+                    || gibbon_position_kernel_decreased (a, c)
+                    != gibbon_position_kernel_decreased_scalar (a, c)) {
+                        g_printerr ("Decrease differs for board #%u.\n",
+                                    (guint) i);
+                        retval = FALSE;
+                }
+        }
+
+        return retval;
+}
+
+static void
+benchmark (gulong iterations)
+{
+        GTimer *timer;
+        gdouble vector, scalar;
+        gulong n;
+        gsize i;
+        guint sum = 0;
+
+        g_print ("Kernels: %s.\n", gibbon_position_kernels_name ());
+
+        timer = g_timer_new ();
+        for (n = 0; n < iterations; ++n) {
+                for (i = 0; i < NUM_BOARDS; ++i) {
+                        sum += gibbon_position_kernel_pips (boards[i]);
+                        sum += gibbon_position_kernel_checkers (boards[i]);
+                        sum += gibbon_position_kernel_differ (
+                                boards[i], boards[(i + 1) % NUM_BOARDS]);
+                        sum += gibbon_position_kernel_decreased (
+                                boards[i], boards[(i + 1) % NUM_BOARDS]);
+                }
+        }
+        vector = g_timer_elapsed (timer, NULL);
+
+        g_timer_start (timer);
+        for (n = 0; n < iterations; ++n) {
+                for (i = 0; i < NUM_BOARDS; ++i) {
+                        sum -= gibbon_position_kernel_pips_scalar (boards[i]);
+                        sum -= gibbon_position_kernel_checkers_scalar (
+                                boards[i]);
+                        sum -= gibbon_position_kernel_differ_scalar (
+                                boards[i], boards[(i + 1) % NUM_BOARDS]);
+                        sum -= gibbon_position_kernel_decreased_scalar (
+                                boards[i], boards[(i + 1) % NUM_BOARDS]);
+                }
+        }
+        scalar = g_timer_elapsed (timer, NULL);
+        g_timer_destroy (timer);
+
+        g_print ("%lu x %u boards: %f s vectorized, %f s scalar"
+                 " (checksum %u).\n",
+                 iterations, NUM_BOARDS, vector, scalar, sum);
+}
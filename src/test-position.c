@@ -33,6 +33,8 @@ static gboolean test_copy_constructor (void);
 static gboolean test_compare (void);
 static gboolean test_apply_move (void);
 static gboolean test_game_over (void);
+static gboolean test_key (void);
+static gboolean test_delta (void);
 
 int
 main(int argc, char *argv[])
@@ -51,6 +53,10 @@ main(int argc, char *argv[])
                 status = -1;
         if (!test_game_over ())
                 status = -1;
+        if (!test_key ())
+                status = -1;
+        if (!test_delta ())
+                status = -1;
 
         return status;
 }
@@ -111,38 +117,40 @@ test_copy_constructor (void)
 {
         GibbonPosition *orig = gibbon_position_new ();
         GibbonPosition *copy;
-        gchar *player1;
-        gchar *player2;
+        gsize strings, before;
 
-        orig->players[0] = g_strdup ("foo");
-        orig->players[1] = g_strdup ("bar");
+        gibbon_position_get_string_pool_stats (&before, NULL);
+
+        gibbon_position_set_player (orig, "foo", GIBBON_POSITION_SIDE_WHITE);
+        gibbon_position_set_player (orig, "bar", GIBBON_POSITION_SIDE_BLACK);
+        gibbon_position_take_status (orig, g_strdup ("foo to move"));
 
         copy = gibbon_position_copy (orig);
         g_return_val_if_fail (copy != NULL, FALSE);
 
-        g_return_val_if_fail (orig->players[0] != copy->players[0], FALSE);
-        g_return_val_if_fail (orig->players[1] != copy->players[1], FALSE);
-
-        g_return_val_if_fail (!g_strcmp0 (orig->players[0],
-                                          copy->players[0]), FALSE);
-        g_return_val_if_fail (!g_strcmp0 (orig->players[1],
-                                          copy->players[1]), FALSE);
-
-        /* Compare the structure expect for the pointers.  */
-        player1 = copy->players[0];
-        player2 = copy->players[1];
-
-        copy->players[0] = orig->players[0];
-        copy->players[1] = orig->players[1];
-
+        /* The strings are interned and shared.  */
         g_return_val_if_fail (!memcmp (orig, copy, sizeof *orig), FALSE);
+        g_return_val_if_fail (!g_strcmp0 (orig->players[0], "foo"), FALSE);
+        g_return_val_if_fail (!g_strcmp0 (orig->players[1], "bar"), FALSE);
+
+        gibbon_position_get_string_pool_stats (&strings, NULL);
+        g_return_val_if_fail (strings == before + 3, FALSE);
 
-        copy->players[0] = player1;
-        copy->players[1] = player2;
+        /* Equal strings are interned only once.  */
+        gibbon_position_set_status (copy, "bar to move");
+        gibbon_position_set_player (copy, "foo", GIBBON_POSITION_SIDE_BLACK);
+        g_return_val_if_fail (copy->players[0] == copy->players[1], FALSE);
+        g_return_val_if_fail (!g_strcmp0 (orig->status, "foo to move"),
+                              FALSE);
+        gibbon_position_get_string_pool_stats (&strings, NULL);
+        g_return_val_if_fail (strings == before + 4, FALSE);
 
         gibbon_position_free (orig);
         gibbon_position_free (copy);
 
+        gibbon_position_get_string_pool_stats (&strings, NULL);
+        g_return_val_if_fail (strings == before, FALSE);
+
         return TRUE;
 }
 
@@ -247,23 +255,21 @@ test_compare (void)
         }
         def->may_double[1] = !def->may_double[1];
 
-        def->game_info = g_strdup ("Crawford game");
+        gibbon_position_set_game_info (def, "Crawford game");
         if (!gibbon_position_equals_technically (ref, def)) {
                 g_printerr ("Positions with different game info do differ"
                             " technically.\n");
                 retval = FALSE;
         }
-        g_free (def->game_info);
-        def->game_info = NULL;
+        gibbon_position_set_game_info (def, NULL);
 
-        def->status = g_strdup ("It is your turn.");
+        gibbon_position_set_status (def, "It is your turn.");
         if (!gibbon_position_equals_technically (ref, def)) {
                 g_printerr ("Positions with different status do differ"
                             " technically.\n");
                 retval = FALSE;
         }
-        g_free (def->status);
-        def->status = NULL;
+        gibbon_position_set_status (def, NULL);
 
         def->resigned = 3;
         if (gibbon_position_equals_technically (ref, def)) {
@@ -553,3 +559,132 @@ test_game_over ()
 
         return retval;
 }
+
+static gboolean
+test_key (void)
+{
+        gboolean retval = TRUE;
+        GibbonPosition *ref = gibbon_position_new ();
+        GibbonPosition *def = gibbon_position_copy (ref);
+        GibbonPositionKey ref_key, def_key;
+        GHashTable *table;
+        gchar *id;
+
+        gibbon_position_get_key (ref, &ref_key);
+        id = g_base64_encode (ref_key.position_id,
+                              sizeof ref_key.position_id);
+        if (g_strcmp0 (id, "4HPwATDgc/ABMA==")) {
+                g_printerr ("Expected position ID 4HPwATDgc/ABMA=="
+                            " for the starting position, got %s.\n", id);
+                retval = FALSE;
+        }
+        g_free (id);
+
+        gibbon_position_set_status (def, "It is your turn.");
+        gibbon_position_get_key (def, &def_key);
+        if (!gibbon_position_key_equal (&ref_key, &def_key)
+            || gibbon_position_hash (ref) != gibbon_position_hash (def)) {
+                g_printerr ("Positions with different status have different"
+                            " keys.\n");
+                retval = FALSE;
+        }
+
+        def->points[5] = 4;
+        def->points[4] = 1;
+        gibbon_position_get_key (def, &def_key);
+        if (gibbon_position_key_equal (&ref_key, &def_key)) {
+                g_printerr ("Positions with different points have equal"
+                            " keys.\n");
+                retval = FALSE;
+        }
+
+        table = g_hash_table_new (gibbon_position_key_hash,
+                                  gibbon_position_key_equal);
+        g_hash_table_insert (table, &ref_key, ref);
+        g_hash_table_insert (table, &def_key, def);
+        if (g_hash_table_size (table) != 2
+            || g_hash_table_lookup (table, &def_key) != def) {
+                g_printerr ("Hash table lookup by position key failed.\n");
+                retval = FALSE;
+        }
+        g_hash_table_destroy (table);
+
+        def->points[5] = 5;
+        def->points[4] = 0;
+        def->turn = GIBBON_POSITION_SIDE_BLACK;
+        gibbon_position_get_key (def, &def_key);
+        if (gibbon_position_key_equal (&ref_key, &def_key)) {
+                g_printerr ("Positions with different turn have equal"
+                            " keys.\n");
+                retval = FALSE;
+        }
+
+        def->turn = ref->turn;
+        def->dice_swapped = TRUE;
+        gibbon_position_get_key (def, &def_key);
+        if (gibbon_position_key_equal (&ref_key, &def_key)) {
+                g_printerr ("Positions with swapped dice have equal"
+                            " keys.\n");
+                retval = FALSE;
+        }
+
+        gibbon_position_free (ref);
+        gibbon_position_free (def);
+
+        return retval;
+}
+
+static gboolean
+test_delta (void)
+{
+        gboolean retval = TRUE;
+        GibbonPosition *from = gibbon_position_new ();
+        GibbonPosition *to = gibbon_position_copy (from);
+        GByteArray *delta = g_byte_array_new ();
+
+        gibbon_position_delta_encode (from, to, delta);
+        if (delta->len) {
+                g_printerr ("Delta between identical positions is not"
+                            " empty.\n");
+                retval = FALSE;
+        }
+
+        to->points[5] = 4;
+        to->points[4] = 1;
+        to->bar[1] = 2;
+        to->dice[0] = 3;
+        to->dice[1] = 1;
+        to->turn = GIBBON_POSITION_SIDE_BLACK;
+        to->cube = 4;
+        to->scores[1] = G_GUINT64_CONSTANT (0x123456789);
+        to->resigned = -2;
+        gibbon_position_set_player (to, "Snow White",
+                                    GIBBON_POSITION_SIDE_WHITE);
+        gibbon_position_set_status (to, "Snow White has moved 6/5.");
+        gibbon_position_set_game_info (from, "Crawford game");
+
+        gibbon_position_delta_encode (from, to, delta);
+        if (!gibbon_position_delta_apply (from, delta->data, delta->len)) {
+                g_printerr ("Cannot apply delta.\n");
+                retval = FALSE;
+        }
+
+        g_byte_array_set_size (delta, 0);
+        gibbon_position_delta_encode (from, to, delta);
+        if (delta->len) {
+                g_printerr ("Applied delta does not reproduce the"
+                            " position.\n");
+                retval = FALSE;
+        }
+
+        if (gibbon_position_delta_apply (from, (const guint8 *) "\x2a", 1)) {
+                g_printerr ("Truncated delta was accepted.\n");
+                retval = FALSE;
+        }
+
+        g_byte_array_free (delta, TRUE);
+        gibbon_position_free (from);
+        gibbon_position_free (to);
+
+        return retval;
+}
@@ -21,11 +21,16 @@
 # include <config.h>
 #endif
 
+#include <string.h>
+
 #include <glib-object.h>
 
 #include "gibbon-sgf-reader.h"
 #include "gibbon-sgf-writer.h"
 
+static gboolean test_trailing_garbage (const gchar *sgf);
+static void count_errors (gpointer user_data, const gchar *msg);
+
 int
 main (int argc, char *argv[])
 {
@@ -75,6 +80,9 @@ main (int argc, char *argv[])
         }
 
 
+        if (!test_trailing_garbage (wanted))
+                status = -1;
+
         g_free (wanted);
         g_free (input_file);
 
@@ -84,3 +92,45 @@ main (int argc, char *argv[])
         return status;
 }
 
+/*
+ * Game trees are read one after another.  Garbage after the last one
+ * must still be reported as an error.
+ */
+static gboolean
+test_trailing_garbage (const gchar *sgf)
+{
+        GibbonMatchReader *reader;
+        GibbonMatch *match;
+        GInputStream *in;
+        gchar *input;
+        guint errors = 0;
+
+        reader = GIBBON_MATCH_READER (gibbon_sgf_reader_new (count_errors,
+                                                             &errors));
+        input = g_strconcat (sgf, "garbage\n", NULL);
+        in = g_memory_input_stream_new_from_data (input, strlen (input), NULL);
+        match = gibbon_match_reader_parse_stream (reader, in, "garbage.sgf");
+        g_object_unref (in);
+        g_free (input);
+        g_object_unref (reader);
+
+        if (match) {
+                g_printerr ("Trailing garbage in SGF was not rejected.\n");
+                g_object_unref (match);
+                return FALSE;
+        }
+
+        if (!errors) {
+                g_printerr ("Trailing garbage in SGF was not reported.\n");
+                return FALSE;
+        }
+
+        return TRUE;
+}
+
+static void
+count_errors (gpointer user_data, const gchar *msg)
+{
+        ++*(guint *) user_data;
+}
+